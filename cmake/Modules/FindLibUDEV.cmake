@@ -0,0 +1,27 @@
+if(NOT LIBUDEV_FOUND)
+  pkg_check_modules (LIBUDEV_PKG libudev)
+  find_path(LIBUDEV_INCLUDE_DIRS NAMES libudev.h
+    PATHS
+    ${LIBUDEV_PKG_INCLUDE_DIRS}
+    /usr/include
+    /usr/local/include
+  )
+
+  find_library(LIBUDEV_LIBRARIES NAMES udev
+    PATHS
+    ${LIBUDEV_PKG_LIBRARY_DIRS}
+    /usr/lib
+    /usr/local/lib
+  )
+
+if(LIBUDEV_INCLUDE_DIRS AND LIBUDEV_LIBRARIES)
+  set(LIBUDEV_FOUND TRUE CACHE INTERNAL "libudev found")
+  message(STATUS "Found libudev: ${LIBUDEV_INCLUDE_DIRS}, ${LIBUDEV_LIBRARIES}")
+else(LIBUDEV_INCLUDE_DIRS AND LIBUDEV_LIBRARIES)
+  set(LIBUDEV_FOUND FALSE CACHE INTERNAL "libudev found")
+  message(STATUS "libudev not found.")
+endif(LIBUDEV_INCLUDE_DIRS AND LIBUDEV_LIBRARIES)
+
+mark_as_advanced(LIBUDEV_LIBRARIES LIBUDEV_INCLUDE_DIRS)
+
+endif(NOT LIBUDEV_FOUND)
@@ -28,10 +28,17 @@ parameters:
 - id: type
   label: '${direction.title()}put Type'
   dtype: enum
+% if sourk == 'source':
+  options: [fc32, sc16, sc8]
+  option_labels: [Complex Float32, Complex Int16, Complex Int8]
+  option_attributes:
+      type: [fc32, sc16, sc8]
+% else:
   options: [fc32]
   option_labels: [Complex Float32]
   option_attributes:
       type: [fc32]
+% endif
   hide: part
 - id: args
   label: 'Device Arguments'
@@ -93,6 +100,9 @@ outputs:
   id: async_msgs
   optional: true
 % endif
+- domain: message
+  id: stats
+  optional: true
 
 templates:
   imports: |-
@@ -100,7 +110,11 @@ templates:
      import time
   make: |
     osmosdr.${sourk}(
+    % if sourk == 'source':
+        args="numchan=" + str(${'$'}{nchan}) + " cpu_format=${'$'}{type} " + ${'$'}{args}
+    % else:
         args="numchan=" + str(${'$'}{nchan}) + " " + ${'$'}{args}
+    % endif
     )
     % for m in range(max_mboards):
     ${'%'} if context.get('num_mboards')() > ${m}:
@@ -180,7 +194,12 @@ documentation: |-
   By using the osmocom $sourk block you can take advantage of a common software api in your application(s) independent of the underlying radio hardware.
 
   Output Type:
-  This parameter controls the data type of the stream in gnuradio. Only complex float32 samples are supported at the moment.
+  This parameter controls the data type of the stream in gnuradio.
+  % if sourk == 'source':
+  Complex int16 and int8 samples are handed on without float conversion by devices delivering integers natively (rtl, rtl_tcp, hackrf, miri, bladerf, uhd, soapy) and converted in software for all others.
+  % else:
+  Only complex float32 samples are supported at the moment.
+  % endif
 
   Device Arguments:
   The device argument is a comma delimited string used to locate devices on your system. Device arguments for multiple devices may be given by separating them with a space.
@@ -196,14 +215,17 @@ documentation: |-
     rtl=serial_number ...
     rtl=0[,rtl_xtal=28.8e6][,tuner_xtal=28.8e6] ...
     rtl=1[,buffers=32][,buflen=N*512] ...
+    rtl=0[,latency_ms=N] ...
     rtl=2[,direct_samp=0|1|2][,offset_tune=0|1][,bias=0|1] ...
-    rtl_tcp=127.0.0.1:1234[,psize=16384][,direct_samp=0|1|2][,offset_tune=0|1][,bias=0|1] ...
+    rtl_tcp=127.0.0.1:1234[,psize=16384][,fifo_ms=500][,direct_samp=0|1|2][,offset_tune=0|1][,bias=0|1] ...
     file='/path/to/your file',rate=1e6[,freq=100e6][,repeat=true][,throttle=true] ...
-    netsdr=127.0.0.1[:50000][,nchan=2]
-    sdr-ip=127.0.0.1[:50000]
-    cloudiq=127.0.0.1[:50000]
+    netsdr=127.0.0.1[:50000][,nchan=2][,bits=16|24][,gap_fill=zero|hold]
+    sdr-ip=127.0.0.1[:50000][,bits=16|24][,gap_fill=zero|hold]
+    cloudiq=127.0.0.1[:50000][,bits=16|24][,gap_fill=zero|hold]
     sdr-iq=/dev/ttyUSB0
-    airspy=0[,bias=0|1][,linearity][,sensitivity]
+    airspy=0[,bias=0|1][,linearity][,sensitivity][,fifo_ms=500]
+    airspyhf=0[,fifo_ms=500]
+    soapy=0[,driver=...][,native_format=0|1]
   % endif
   % if sourk == 'sink':
     file='/path/to/your file',rate=1e6[,freq=100e6][,append=true][,throttle=true] ...
@@ -212,8 +234,15 @@ documentation: |-
     freesrp=0[,fx3='path/to/fx3.img',fpga='path/to/fpga.bin',loopback]
     hackrf=0[,buffers=32][,bias=0|1][,bias_tx=0|1]
     bladerf=0[,tamer=internal|external|external_1pps][,smb=25e6][,feature=oversample|default][,sample_format=16bit|16bit_packed|8bit]
+  % if sourk == 'source':
+    hackrf=0[,sweep=start:stop:step][,sweep_blocks=1]
+    hackrf=0[,latency_ms=N]
+    bladerf=0[,stream=sync|async][,buffers=512][,buflen=4096][,transfers=32]
+    bladerf=0[,enable_metadata=1][,rx_start_time=seconds]
+  % endif
     uhd[,serial=...][,lo_offset=0][,mcr=52e6][,nchan=2][,subdev='\\\\'B:0 A:0\\\\''] ...
     xtrx
+    soapy=0[,driver=...][,direct_access=0|1]
 
   Num Channels:
   Selects the total number of channels in this multi-device configuration. Required when specifying multiple device arguments.
@@ -268,6 +297,30 @@ documentation: |-
   Bandwidth:
   Set the bandpass filter on the radio frontend. To use the default (automatic) bandwidth filter setting, this should be zero.
 
+  % if sourk == 'source':
+  Stream Tags:
+  The source attaches rx_time, rx_rate and rx_freq tags to the first sample, after samples have been lost and after retuning. rx_time is the hardware timestamp where the device provides one (bladeRF metadata formats, SoapySDR, XTRX) and an estimate from the host clock otherwise.
+
+  HackRF Sweep:
+  With sweep=start:stop:step (Hz, the range is rounded to whole MHz) the HackRF firmware steps through the range on its own, dwelling sweep_blocks blocks of 8192 samples on each step. Every block starts with an rx_freq tag carrying the center frequency it was received at. The first samples of a block are still settling and its first 5 samples are zeroed.
+
+  Frequency Hopping:
+  A dictionary sent to the command port retunes a channel, e.g. pmt.to_pmt({'freq': 433.92e6, 'chan': 0}). With bladeRF and enable_metadata=1, a time key (a tuple of integer and fractional seconds of device time, see get_time_now()) schedules the retune in hardware and the rx_freq tag marks the first sample at the new frequency. set_retune_presets() prepares a list of frequencies so that hopping to them skips the tuning calibration.
+
+  % else:
+  Burst Tags:
+  The bladeRF and SoapySDR sinks transmit bursts delimited by tx_sob and tx_eob tags. With SoapySDR, a tx_time tag (a tuple of integer and fractional seconds) on the first sample of a burst sends it at that device time.
+
+  % endif
+  Stream Statistics:
+  Adding stats_ms=N to the device arguments publishes the overflow (lost samples), underflow (inserted samples) and late burst counters of every channel on the stats message port every N milliseconds, instead of printing O and U characters to the console.
+
+  Device Discovery:
+  Without a device argument the first device found is used. All backends are searched concurrently, adding enum_timeout_ms=N skips the ones which did not answer within N milliseconds, e.g. a slow network discovery.
+
+  Capability Cache:
+  The SoapySDR, bladeRF and Airspy backends keep the sample rate, frequency, gain and bandwidth ranges of a device in $XDG_CACHE_HOME/gr-osmosdr/caps (~/.cache if unset), keyed by its serial number and firmware version, so they are not requested from the hardware again. Adding caps_cache=0 to the device arguments always asks the hardware.
+
   See the OsmoSDR project page for more detailed documentation:
   http://sdr.osmocom.org/trac/wiki/GrOsmoSDR
   http://sdr.osmocom.org/trac/wiki/rtl-sdr
@@ -25,6 +25,7 @@
 #include <osmosdr/pimpl.h>
 #include <boost/noncopyable.hpp>
 #include <boost/lexical_cast.hpp>
+#include <functional>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -104,10 +105,56 @@ namespace osmosdr {
      * The device hint "nofake" switches off dummy devices created
      * by "file" (and other) implementations.
      *
+     * All backends are searched concurrently. With enum_timeout_ms=N,
+     * backends that did not answer within N milliseconds are left out.
+     *
      * \param hint a partially (or fully) filled in logical device
      * \return a vector of logical devices for all radios on the system
      */
     static devices_t find(const device_t &hint = osmosdr::device_t());
+
+    /*!
+     * \brief Find logical radio devices, bypassing the device registry.
+     *
+     * find() keeps the device lists of USB backends until a hotplug event
+     * is seen (requires libudev) and those of network discovery for a few
+     * seconds. refresh() drops them all and enumerates from scratch.
+     *
+     * \param hint see find()
+     * \return a vector of logical devices for all radios on the system
+     */
+    static devices_t refresh(const device_t &hint = osmosdr::device_t());
+
+    /*!
+     * \brief Drop the cached device list of a backend.
+     * \param backend a backend name like "rtl" or "rfspace", all if empty
+     */
+    static void invalidate(const std::string &backend = "");
+
+    //! Called with the backend name (empty for all) on invalidation
+    typedef std::function<void(const std::string &backend)> invalidate_cb_t;
+
+    /*!
+     * \brief Get notified whenever cached device lists are dropped.
+     *
+     * Hooks run on the thread that caused the invalidation, for hotplug
+     * events that is the registry's monitor thread. A supervisor can call
+     * find() from there to learn what changed.
+     *
+     * \param hook the function to call
+     * \return an id for remove_invalidate_hook()
+     */
+    static size_t add_invalidate_hook(const invalidate_cb_t &hook);
+
+    /*!
+     * \brief Remove a hook added with add_invalidate_hook().
+     *
+     * An invalidation already under way on another thread may still call
+     * the hook once after this returns.
+     *
+     * \param id the id returned by add_invalidate_hook()
+     */
+    static void remove_invalidate_hook(size_t id);
   };
 
 } //namespace osmosdr
@@ -23,6 +23,7 @@
 #include <osmosdr/api.h>
 #include <osmosdr/ranges.h>
 #include <osmosdr/time_spec.h>
+#include <osmosdr/stream_stats.h>
 #include <gnuradio/hier_block2.h>
 
 namespace osmosdr {
@@ -47,6 +48,17 @@ public:
    * constructor is private.  osmosdr::sink::make is the public
    * interface for creating new instances.
    *
+   * The optional stats_ms=N argument publishes the counters returned by
+   * get_stream_stats() for every channel on the "stats" message port
+   * every N milliseconds.
+   *
+   * Without a device argument the first device found is used. The
+   * backends are searched concurrently, enum_timeout_ms=N skips those
+   * which did not answer within N milliseconds.
+   *
+   * Some backends keep the ranges reported by a device in a cache below
+   * $XDG_CACHE_HOME/gr-osmosdr, caps_cache=0 always asks the hardware.
+   *
    * \param args the address to identify the hardware
    * \return a new osmosdr sink block object
    */
@@ -275,6 +287,13 @@ public:
    */
   virtual osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 ) = 0;
 
+  /*!
+   * Get the overflow/underflow counters of a channel.
+   * \param chan the channel index 0 to N-1
+   * \return the counters accumulated since the device has been opened
+   */
+  virtual osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 ) = 0;
+
   /*!
    * Set the time source for the device.
    * This sets the method of time synchronization,
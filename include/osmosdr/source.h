@@ -23,6 +23,7 @@
 #include <osmosdr/api.h>
 #include <osmosdr/ranges.h>
 #include <osmosdr/time_spec.h>
+#include <osmosdr/stream_stats.h>
 #include <gnuradio/hier_block2.h>
 
 namespace osmosdr {
@@ -47,6 +48,27 @@ public:
    * constructor is private.  osmosdr::source::make is the public
    * interface for creating new instances.
    *
+   * The optional cpu_format=fc32|sc16|sc8 argument selects the item type
+   * of the output streams. Devices delivering integer samples hand them on
+   * without float conversion, others are converted in software. Integer
+   * samples use the full range of their type. IQ imbalance correction is
+   * only available for fc32.
+   *
+   * The optional stats_ms=N argument publishes the counters returned by
+   * get_stream_stats() for every channel on the "stats" message port
+   * every N milliseconds.
+   *
+   * Without a device argument the first device found is used. The
+   * backends are searched concurrently, enum_timeout_ms=N skips those
+   * which did not answer within N milliseconds.
+   *
+   * Some backends keep the ranges reported by a device in a cache below
+   * $XDG_CACHE_HOME/gr-osmosdr, caps_cache=0 always asks the hardware.
+   *
+   * The "command" message port takes dictionaries with a freq key and
+   * optional chan and time keys. time is a tuple of integer and fractional
+   * seconds of device time, see schedule_retune().
+   *
    * \param args the address to identify the hardware
    * \return a new osmosdr source block object
    */
@@ -320,6 +342,36 @@ public:
    */
   virtual osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 ) = 0;
 
+  /*!
+   * Get the overflow/underflow counters of a channel.
+   * \param chan the channel index 0 to N-1
+   * \return the counters accumulated since the device has been opened
+   */
+  virtual osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 ) = 0;
+
+  /*!
+   * Prepare fast retuning to a list of frequencies. Later retunes to one
+   * of them skip the tuning calibration. Only bladeRF devices support this.
+   * \param freqs the center frequencies in Hz
+   * \param chan the channel index 0 to N-1
+   * \return the number of frequencies prepared
+   */
+  virtual size_t set_retune_presets( const std::vector<double> &freqs,
+                                     size_t chan = 0 ) = 0;
+
+  /*!
+   * Retune a channel when the device time reaches the given time, see
+   * get_time_now(). The rx_freq tag is placed on the first sample received
+   * at the new frequency. Only bladeRF devices support this.
+   * \param freq the new center frequency in Hz
+   * \param time the device time of the retune, zero retunes immediately
+   * \param chan the channel index 0 to N-1
+   * \return true if the retune has been scheduled
+   */
+  virtual bool schedule_retune( double freq,
+                                const ::osmosdr::time_spec_t &time,
+                                size_t chan = 0 ) = 0;
+
   /*!
    * Set the time source for the device.
    * This sets the method of time synchronization,
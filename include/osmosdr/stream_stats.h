@@ -0,0 +1,53 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_STREAM_STATS_H
+#define INCLUDED_OSMOSDR_STREAM_STATS_H
+
+#include <cstdint>
+
+namespace osmosdr {
+
+/*!
+ * Overflow, underflow and late burst counters of a single channel,
+ * accumulated since the device has been opened. Devices which can't tell
+ * report zeros.
+ */
+struct stream_stats_t
+{
+  stream_stats_t() : overflows(0), dropped(0), underflows(0), inserted(0),
+                     late(0) {}
+
+  //! number of times samples were lost because the host fell behind
+  uint64_t overflows;
+  //! number of samples lost during overflows, if known
+  uint64_t dropped;
+  //! number of times the device ran out of samples to transmit
+  uint64_t underflows;
+  //! number of samples (usually zeros) sent in place of missing ones
+  uint64_t inserted;
+  //! number of timed bursts that reached the device after their tx_time
+  uint64_t late;
+};
+
+} // namespace osmosdr
+
+#endif /* INCLUDED_OSMOSDR_STREAM_STATS_H */
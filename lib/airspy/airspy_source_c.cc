@@ -58,6 +58,12 @@ using namespace boost::assign;
 #define AIRSPY_FUNC_STR(func, arg) \
   boost::str(boost::format(func "(%1%)") % arg) + " has failed"
 
+/* default sample FIFO depth in milliseconds at the current sample rate */
+#define DEFAULT_FIFO_MS 500
+
+/* lower bound for the sample FIFO, a few transfers worth of samples */
+#define MIN_FIFO_SAMPLES (256 * 1024)
+
 airspy_source_c_sptr make_airspy_source_c (const std::string & args)
 {
   return gnuradio::get_initial_sptr(new airspy_source_c (args));
@@ -93,7 +99,9 @@ airspy_source_c::airspy_source_c (const std::string &args)
     _lna_gain(0),
     _mix_gain(0),
     _vga_gain(0),
-    _bandwidth(0)
+    _bandwidth(0),
+    _tagger([this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+            gr::sync_block::name())
 {
   int ret;
 
@@ -111,18 +119,29 @@ airspy_source_c::airspy_source_c (const std::string &args)
   memset(version, 0, sizeof(version));
   ret = airspy_version_string_read( _dev, version, sizeof(version));
   AIRSPY_THROW_ON_ERROR(ret, "Failed to read version string")
-#if 0
+
+  /* the sample rates of a known serial and firmware are taken from disk */
   airspy_read_partid_serialno_t part_serial;
-  ret = airspy_board_partid_serialno_read( _dev, &part_serial );
-  AIRSPY_THROW_ON_ERROR(ret, "Failed to read serial number")
-#endif
-  uint32_t num_rates;
-  airspy_get_samplerates(_dev, &num_rates, 0);
-  uint32_t *samplerates = (uint32_t *) malloc(num_rates * sizeof(uint32_t));
-  airspy_get_samplerates(_dev, samplerates, num_rates);
-  for (size_t i = 0; i < num_rates; i++)
-    _sample_rates.push_back( std::pair<double, uint32_t>( samplerates[i], i ) );
-  free(samplerates);
+  if ( args_to_caps_cache( args ) &&
+       airspy_board_partid_serialno_read( _dev, &part_serial ) == AIRSPY_SUCCESS )
+    _caps.load( boost::str( boost::format( "airspy %08x%08x %s" )
+                            % part_serial.serial_no[2] % part_serial.serial_no[3]
+                            % version ) );
+
+  /* kept in the order reported, the index selects the rate */
+  osmosdr::meta_range_t rates = _caps.get( "samplerates", [this]() {
+      osmosdr::meta_range_t range;
+      uint32_t num_rates;
+      airspy_get_samplerates(_dev, &num_rates, 0);
+      uint32_t *samplerates = (uint32_t *) malloc(num_rates * sizeof(uint32_t));
+      airspy_get_samplerates(_dev, samplerates, num_rates);
+      for (size_t i = 0; i < num_rates; i++)
+        range.push_back( osmosdr::range_t( samplerates[i] ) );
+      free(samplerates);
+      return range;
+    } );
+  for (size_t i = 0; i < rates.size(); i++)
+    _sample_rates.push_back( std::pair<double, uint32_t>( rates[i].start(), i ) );
 
   /* since they may (and will) give us an unsorted array we have to sort it here
    * to play nice with the monotonic requirement of meta-range later on */
@@ -168,11 +187,11 @@ airspy_source_c::airspy_source_c (const std::string &args)
     AIRSPY_THROW_ON_ERROR(ret, "Failed to set USB bit packing")
   }
 
-  _fifo = new boost::circular_buffer<gr_complex>(5000000);
-  if (!_fifo) {
-    throw std::runtime_error( std::string(__FUNCTION__) + " " +
-                              "Failed to allocate a sample FIFO!" );
-  }
+  _fifo_ms = DEFAULT_FIFO_MS;
+  if ( dict.count( "fifo_ms" ) )
+    _fifo_ms = boost::lexical_cast< unsigned int >( dict["fifo_ms"] );
+
+  alloc_fifo();
 }
 
 /*
@@ -199,12 +218,6 @@ airspy_source_c::~airspy_source_c ()
     }
     _dev = NULL;
   }
-
-  if (_fifo)
-  {
-    delete _fifo;
-    _fifo = NULL;
-  }
 }
 
 int airspy_source_c::_airspy_rx_callback(airspy_transfer *transfer)
@@ -216,36 +229,30 @@ int airspy_source_c::_airspy_rx_callback(airspy_transfer *transfer)
 
 int airspy_source_c::airspy_rx_callback(void *samples, int sample_count)
 {
-  size_t i, n_avail, to_copy, num_samples = sample_count;
-  float *sample = (float *)samples;
+  size_t num_samples = sample_count;
 
-  _fifo_lock.lock();
+  /* interleaved float I/Q has the same layout as gr_complex */
+  size_t copied = _fifo->write( (const gr_complex *)samples, num_samples );
 
-  n_avail = _fifo->capacity() - _fifo->size();
-  to_copy = (n_avail < num_samples ? n_avail : num_samples);
-
-  for (i = 0; i < to_copy; i++ )
-  {
-    /* Push sample to the fifo */
-    _fifo->push_back( gr_complex( *sample, *(sample+1) ) );
+  _tagger.produced( copied );
 
-    /* offset to the next I+Q sample */
-    sample += 2;
+  if (copied < num_samples) {
+    _stats.overflow(num_samples - copied);
+    _tagger.gap();
   }
 
-  _fifo_lock.unlock();
+  return 0; // TODO: return -1 on error/stop
+}
 
-  /* We have made some new samples available to the consumer in work() */
-  if (to_copy) {
-    //std::cerr << "+" << std::flush;
-    _samp_avail.notify_one();
-  }
+void airspy_source_c::alloc_fifo()
+{
+  size_t len = size_t( _sample_rate * _fifo_ms / 1000.0 );
 
-  /* Indicate overrun, if neccesary */
-  if (to_copy < num_samples)
-    std::cerr << "O" << std::flush;
+  if ( len < MIN_FIFO_SAMPLES )
+    len = MIN_FIFO_SAMPLES;
 
-  return 0; // TODO: return -1 on error/stop
+  if ( ! _fifo || _fifo->capacity() != len )
+    _fifo.reset( new sample_fifo<gr_complex>( len ) );
 }
 
 bool airspy_source_c::start()
@@ -253,6 +260,14 @@ bool airspy_source_c::start()
   if ( ! _dev )
     return false;
 
+  /* the sample rate may have changed since the FIFO was sized */
+  alloc_fifo();
+  _fifo->reset();
+
+  _tagger.set_rate( get_sample_rate() );
+  _tagger.set_freq( get_center_freq() );
+  _tagger.start();
+
   int ret = airspy_start_rx( _dev, _airspy_rx_callback, (void *)this );
   if ( ret != AIRSPY_SUCCESS ) {
     std::cerr << "Failed to start RX streaming (" << ret << ")" << std::endl;
@@ -267,6 +282,8 @@ bool airspy_source_c::stop()
   if ( ! _dev )
     return false;
 
+  _fifo->interrupt();
+
   int ret = airspy_stop_rx( _dev );
   if ( ret != AIRSPY_SUCCESS ) {
     std::cerr << "Failed to stop RX streaming (" << ret << ")" << std::endl;
@@ -290,24 +307,15 @@ int airspy_source_c::work( int noutput_items,
   if ( ! running )
     return WORK_DONE;
 
-  std::unique_lock<std::mutex> lock(_fifo_lock);
-
   /* Wait until we have the requested number of samples */
-  int n_samples_avail = _fifo->size();
-
-  while (n_samples_avail < noutput_items) {
-    _samp_avail.wait(lock);
-    n_samples_avail = _fifo->size();
-  }
+  if ( ! _fifo->wait( noutput_items ) )
+    return WORK_DONE;
 
-  for(int i = 0; i < noutput_items; ++i) {
-    out[i] = _fifo->at(0);
-    _fifo->pop_front();
-  }
+  size_t nread = _fifo->read( out, noutput_items );
 
-  //std::cerr << "-" << std::flush;
+  _tagger.tag_range( nitems_written(0), nread );
 
-  return noutput_items;
+  return nread;
 }
 
 std::vector<std::string> airspy_source_c::get_devices()
@@ -382,6 +390,7 @@ double airspy_source_c::set_sample_rate( double rate )
     ret = airspy_set_samplerate( _dev, samp_rate_index );
     if ( AIRSPY_SUCCESS == ret ) {
       _sample_rate = rate;
+      _tagger.set_rate( rate );
     } else {
       AIRSPY_THROW_ON_ERROR( ret, AIRSPY_FUNC_STR( "airspy_set_samplerate", rate ) )
     }
@@ -415,6 +424,7 @@ double airspy_source_c::set_center_freq( double freq, size_t chan )
     ret = airspy_set_freq( _dev, uint64_t(corr_freq) );
     if ( AIRSPY_SUCCESS == ret ) {
       _center_freq = freq;
+      _tagger.set_freq( freq, chan );
     } else {
       AIRSPY_THROW_ON_ERROR( ret, AIRSPY_FUNC_STR( "airspy_set_freq", corr_freq ) )
     }
@@ -711,3 +721,8 @@ osmosdr::freq_range_t airspy_source_c::get_bandwidth_range( size_t chan )
 
   return bandwidths;
 }
+
+osmosdr::stream_stats_t airspy_source_c::get_stream_stats( size_t chan )
+{
+  return _stats.get( chan );
+}
@@ -22,16 +22,17 @@
 #ifndef INCLUDED_AIRSPY_SOURCE_C_H
 #define INCLUDED_AIRSPY_SOURCE_C_H
 
-#include <boost/circular_buffer.hpp>
-
-#include <mutex>
-#include <condition_variable>
+#include <memory>
 
 #include <gnuradio/sync_block.h>
 
 #include <libairspy/airspy.h>
 
 #include "source_iface.h"
+#include "caps_cache.h"
+#include "sample_fifo.h"
+#include "stream_counters.h"
+#include "rx_tagger.h"
 
 class airspy_source_c;
 
@@ -122,17 +123,21 @@ public:
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
 private:
   static int _airspy_rx_callback(airspy_transfer* transfer);
   int airspy_rx_callback(void *samples, int sample_count);
+  void alloc_fifo();
 
   airspy_device *_dev;
 
-  boost::circular_buffer<gr_complex> *_fifo;
-  std::mutex _fifo_lock;
-  std::condition_variable _samp_avail;
+  std::unique_ptr< sample_fifo<gr_complex> > _fifo;
+  stream_counters _stats;
+  unsigned int _fifo_ms;
 
   std::vector< std::pair<double, uint32_t> > _sample_rates;
+  caps_cache _caps;
   double _sample_rate;
   double _center_freq;
   double _freq_corr;
@@ -148,6 +153,8 @@ private:
   double _mix_gain;
   double _vga_gain;
   double _bandwidth;
+
+  rx_tagger _tagger;
 };
 
 #endif /* INCLUDED_AIRSPY_SOURCE_C_H */
@@ -55,6 +55,12 @@ using namespace boost::assign;
 #define AIRSPYHF_FUNC_STR(func, arg) \
   boost::str(boost::format(func "(%1%)") % arg) + " has failed"
 
+/* default sample FIFO depth in milliseconds at the current sample rate */
+#define DEFAULT_FIFO_MS 500
+
+/* lower bound for the sample FIFO, a few transfers worth of samples */
+#define MIN_FIFO_SAMPLES (256 * 1024)
+
 airspyhf_source_c_sptr make_airspyhf_source_c (const std::string & args)
 {
   return gnuradio::get_initial_sptr(new airspyhf_source_c (args));
@@ -84,7 +90,9 @@ airspyhf_source_c::airspyhf_source_c (const std::string &args)
     _dev(NULL),
     _sample_rate(0),
     _center_freq(0),
-    _freq_corr(0)
+    _freq_corr(0),
+    _tagger([this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+            gr::sync_block::name())
 {
   int ret;
 
@@ -116,11 +124,11 @@ airspyhf_source_c::airspyhf_source_c (const std::string &args)
   set_center_freq( (get_freq_range().start() + get_freq_range().stop()) / 2.0 );
   set_sample_rate( get_sample_rates().start() );
 
-  _fifo = new boost::circular_buffer<gr_complex>(5000000);
-  if (!_fifo) {
-    throw std::runtime_error( std::string(__FUNCTION__) + " " +
-                              "Failed to allocate a sample FIFO!" );
-  }
+  _fifo_ms = DEFAULT_FIFO_MS;
+  if ( dict.count( "fifo_ms" ) )
+    _fifo_ms = boost::lexical_cast< unsigned int >( dict["fifo_ms"] );
+
+  alloc_fifo();
 }
 
 /*
@@ -147,12 +155,6 @@ airspyhf_source_c::~airspyhf_source_c ()
     }
     _dev = NULL;
   }
-
-  if (_fifo)
-  {
-    delete _fifo;
-    _fifo = NULL;
-  }
 }
 
 int airspyhf_source_c::_airspyhf_rx_callback(airspyhf_transfer_t *transfer)
@@ -164,36 +166,30 @@ int airspyhf_source_c::_airspyhf_rx_callback(airspyhf_transfer_t *transfer)
 
 int airspyhf_source_c::airspyhf_rx_callback(void *samples, int sample_count)
 {
-  size_t i, n_avail, to_copy, num_samples = sample_count;
-  float *sample = (float *)samples;
-
-  _fifo_lock.lock();
+  size_t num_samples = sample_count;
 
-  n_avail = _fifo->capacity() - _fifo->size();
-  to_copy = (n_avail < num_samples ? n_avail : num_samples);
+  /* interleaved float I/Q has the same layout as gr_complex */
+  size_t copied = _fifo->write( (const gr_complex *)samples, num_samples );
 
-  for (i = 0; i < to_copy; i++ )
-  {
-    /* Push sample to the fifo */
-    _fifo->push_back( gr_complex( *sample, *(sample+1) ) );
+  _tagger.produced( copied );
 
-    /* offset to the next I+Q sample */
-    sample += 2;
+  if (copied < num_samples) {
+    _stats.overflow(num_samples - copied);
+    _tagger.gap();
   }
 
-  _fifo_lock.unlock();
+  return 0; // TODO: return -1 on error/stop
+}
 
-  /* We have made some new samples available to the consumer in work() */
-  if (to_copy) {
-    //std::cerr << "+" << std::flush;
-    _samp_avail.notify_one();
-  }
+void airspyhf_source_c::alloc_fifo()
+{
+  size_t len = size_t( _sample_rate * _fifo_ms / 1000.0 );
 
-  /* Indicate overrun, if neccesary */
-  if (to_copy < num_samples)
-    std::cerr << "O" << std::flush;
+  if ( len < MIN_FIFO_SAMPLES )
+    len = MIN_FIFO_SAMPLES;
 
-  return 0; // TODO: return -1 on error/stop
+  if ( ! _fifo || _fifo->capacity() != len )
+    _fifo.reset( new sample_fifo<gr_complex>( len ) );
 }
 
 bool airspyhf_source_c::start()
@@ -201,6 +197,14 @@ bool airspyhf_source_c::start()
   if ( ! _dev )
     return false;
 
+  /* the sample rate may have changed since the FIFO was sized */
+  alloc_fifo();
+  _fifo->reset();
+
+  _tagger.set_rate( get_sample_rate() );
+  _tagger.set_freq( get_center_freq() );
+  _tagger.start();
+
   int ret = airspyhf_start( _dev, _airspyhf_rx_callback, (void *)this );
   if ( ret != AIRSPYHF_SUCCESS ) {
     std::cerr << "Failed to start RX streaming (" << ret << ")" << std::endl;
@@ -215,6 +219,8 @@ bool airspyhf_source_c::stop()
   if ( ! _dev )
     return false;
 
+  _fifo->interrupt();
+
   int ret = airspyhf_stop( _dev );
   if ( ret != AIRSPYHF_SUCCESS ) {
     std::cerr << "Failed to stop RX streaming (" << ret << ")" << std::endl;
@@ -238,22 +244,15 @@ int airspyhf_source_c::work( int noutput_items,
   if ( ! running )
     return WORK_DONE;
 
-  std::unique_lock<std::mutex> lock(_fifo_lock);
-
   /* Wait until we have the requested number of samples */
-  int n_samples_avail = _fifo->size();
+  if ( ! _fifo->wait( noutput_items ) )
+    return WORK_DONE;
 
-  while (n_samples_avail < noutput_items) {
-    _samp_avail.wait(lock);
-    n_samples_avail = _fifo->size();
-  }
+  size_t nread = _fifo->read( out, noutput_items );
 
-  for(int i = 0; i < noutput_items; ++i) {
-    out[i] = _fifo->at(0);
-    _fifo->pop_front();
-  }
+  _tagger.tag_range( nitems_written(0), nread );
 
-  return noutput_items;
+  return nread;
 }
 
 std::vector<std::string> airspyhf_source_c::get_devices()
@@ -316,6 +315,7 @@ double airspyhf_source_c::set_sample_rate( double rate )
     ret = airspyhf_set_samplerate( _dev, samp_rate_index );
     if ( AIRSPYHF_SUCCESS == ret ) {
       _sample_rate = rate;
+      _tagger.set_rate( rate );
     } else {
       AIRSPYHF_THROW_ON_ERROR( ret, AIRSPYHF_FUNC_STR( "airspyhf_set_samplerate", rate ) )
     }
@@ -346,6 +346,7 @@ double airspyhf_source_c::set_center_freq( double freq, size_t chan )
     ret = airspyhf_set_freq( _dev, freq );
     if ( AIRSPYHF_SUCCESS == ret ) {
       _center_freq = freq;
+      _tagger.set_freq( freq, chan );
     } else {
       AIRSPYHF_THROW_ON_ERROR( ret, AIRSPYHF_FUNC_STR( "airspyhf_set_freq", freq ) )
     }
@@ -435,3 +436,8 @@ std::string airspyhf_source_c::get_antenna( size_t chan )
 {
   return "RX";
 }
+
+osmosdr::stream_stats_t airspyhf_source_c::get_stream_stats( size_t chan )
+{
+  return _stats.get( chan );
+}
@@ -22,16 +22,16 @@
 #ifndef INCLUDED_AIRSPYHF_SOURCE_C_H
 #define INCLUDED_AIRSPYHF_SOURCE_C_H
 
-#include <boost/circular_buffer.hpp>
-
-#include <mutex>
-#include <condition_variable>
+#include <memory>
 
 #include <gnuradio/sync_block.h>
 
 #include <libairspyhf/airspyhf.h>
 
 #include "source_iface.h"
+#include "sample_fifo.h"
+#include "stream_counters.h"
+#include "rx_tagger.h"
 
 class airspyhf_source_c;
 
@@ -98,21 +98,26 @@ public:
   std::string set_antenna( const std::string & antenna, size_t chan = 0 );
   std::string get_antenna( size_t chan = 0 );
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
 
 private:
   static int _airspyhf_rx_callback(airspyhf_transfer_t* transfer);
   int airspyhf_rx_callback(void *samples, int sample_count);
+  void alloc_fifo();
 
   airspyhf_device *_dev;
 
-  boost::circular_buffer<gr_complex> *_fifo;
-  std::mutex _fifo_lock;
-  std::condition_variable _samp_avail;
+  std::unique_ptr< sample_fifo<gr_complex> > _fifo;
+  stream_counters _stats;
+  unsigned int _fifo_ms;
 
   std::vector< std::pair<double, uint32_t> > _sample_rates;
   double _sample_rate;
   double _center_freq;
   double _freq_corr;
+
+  rx_tagger _tagger;
 };
 
 #endif /* INCLUDED_AIRSPY_SOURCE_C_H */
@@ -24,6 +24,7 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <stdexcept>
 
 #include <gnuradio/io_signature.h>
 
@@ -109,6 +110,121 @@ inline dict_t params_to_dict( const std::string &params )
   return result;
 }
 
+/*
+ * Sample formats a source can hand to the flowgraph, selected with the
+ * cpu_format= argument. Integer formats use the full range of their type.
+ */
+enum cpu_format_t
+{
+  CPU_FORMAT_FC32, /* complex float */
+  CPU_FORMAT_SC16, /* complex int16 */
+  CPU_FORMAT_SC8   /* complex int8 */
+};
+
+inline cpu_format_t string_to_cpu_format( const std::string &format )
+{
+  if ( "fc32" == format )
+    return CPU_FORMAT_FC32;
+  else if ( "sc16" == format )
+    return CPU_FORMAT_SC16;
+  else if ( "sc8" == format )
+    return CPU_FORMAT_SC8;
+
+  throw std::runtime_error("Unsupported cpu_format '" + format + "', "
+                           "expected fc32, sc16 or sc8.");
+}
+
+inline std::string cpu_format_to_string( cpu_format_t format )
+{
+  switch ( format ) {
+  case CPU_FORMAT_SC16:
+    return "sc16";
+  case CPU_FORMAT_SC8:
+    return "sc8";
+  default:
+    return "fc32";
+  }
+}
+
+inline size_t cpu_format_item_size( cpu_format_t format )
+{
+  switch ( format ) {
+  case CPU_FORMAT_SC16:
+    return 2 * sizeof(int16_t);
+  case CPU_FORMAT_SC8:
+    return 2 * sizeof(int8_t);
+  default:
+    return sizeof(gr_complex);
+  }
+}
+
+/*
+ * The format may be given as a global token or as a device parameter, but
+ * all streams of a block have to agree on it.
+ */
+inline cpu_format_t args_to_cpu_format( const std::string &args )
+{
+  std::string format;
+
+  for (std::string arg : args_to_vector( args ))
+  {
+    dict_t dict = params_to_dict( arg );
+    if ( ! dict.count( "cpu_format" ) )
+      continue;
+
+    if ( format.size() && format != dict["cpu_format"] )
+      throw std::runtime_error("Conflicting cpu_format arguments specified.");
+
+    format = dict["cpu_format"];
+  }
+
+  return format.size() ? string_to_cpu_format( format ) : CPU_FORMAT_FC32;
+}
+
+/*
+ * Period of the "stats" message port in milliseconds, 0 (the default)
+ * disables it. The value applies to the whole block.
+ */
+inline unsigned int args_to_stats_ms( const std::string &args )
+{
+  for (std::string arg : args_to_vector( args ))
+  {
+    dict_t dict = params_to_dict( arg );
+    if ( dict.count( "stats_ms" ) )
+      return boost::lexical_cast< unsigned int >( dict["stats_ms"] );
+  }
+
+  return 0;
+}
+
+inline unsigned int args_to_enum_timeout_ms( const std::string &args )
+{
+  for (std::string arg : args_to_vector( args ))
+  {
+    dict_t dict = params_to_dict( arg );
+    if ( dict.count( "enum_timeout_ms" ) )
+      return boost::lexical_cast< unsigned int >( dict["enum_timeout_ms"] );
+  }
+
+  return 0;
+}
+
+/*
+ * Whether backends may answer range queries from the capability cache,
+ * caps_cache=0 always asks the hardware. Enabled by default.
+ */
+inline bool args_to_caps_cache( const std::string &args )
+{
+  for (std::string arg : args_to_vector( args ))
+  {
+    dict_t dict = params_to_dict( arg );
+    if ( dict.count( "caps_cache" ) )
+      return boost::lexical_cast< unsigned int >( dict["caps_cache"] ) != 0;
+  }
+
+  return true;
+}
+
 struct is_nchan_argument
 {
   bool operator ()(const std::string &str)
@@ -117,7 +233,32 @@ struct is_nchan_argument
   }
 };
 
-inline gr::io_signature::sptr args_to_io_signature( const std::string &args )
+/*
+ * Arguments given on their own apply to the whole block and don't
+ * describe a device, e.g. "numchan=1 cpu_format=fc32 rtl=0" as passed by
+ * the GRC blocks.
+ */
+struct is_global_argument
+{
+  bool operator ()(const std::string &str)
+  {
+    static const char *globals[] = { "cpu_format", "stats_ms", "enum_timeout_ms",
+                                     "caps_cache", NULL };
+
+    dict_t dict = params_to_dict( str );
+    if ( dict.size() != 1 )
+      return false;
+
+    for (const char **key = globals; *key; key++)
+      if ( dict.count( *key ) )
+        return true;
+
+    return is_nchan_argument()( str );
+  }
+};
+
+inline gr::io_signature::sptr args_to_io_signature( const std::string &args,
+                                                   size_t item_size = sizeof(gr_complex) )
 {
   size_t max_nchan = 0;
   size_t dev_nchan = 0;
@@ -132,10 +273,10 @@ inline gr::io_signature::sptr args_to_io_signature( const std::string &args )
     }
   }
 
-  arg_list.erase( std::remove_if( // remove any global nchan tokens
+  arg_list.erase( std::remove_if( // remove nchan and other global tokens
                     arg_list.begin(),
                     arg_list.end(),
-                    is_nchan_argument() ),
+                    is_global_argument() ),
                   arg_list.end() );
 
   // try to parse device specific nchan values, assume 1 channel if none given
@@ -158,7 +299,7 @@ inline gr::io_signature::sptr args_to_io_signature( const std::string &args )
     throw std::runtime_error("Wrong device arguments specified. Missing nchan?");
 
   const size_t nchan = std::max<size_t>(dev_nchan, 1); // assume at least one
-  return gr::io_signature::make(nchan, nchan, sizeof(gr_complex));
+  return gr::io_signature::make(nchan, nchan, item_size);
 }
 
 #endif // OSMOSDR_ARG_HELPERS_H
@@ -0,0 +1,99 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_BACKEND_H
+#define OSMOSDR_BACKEND_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gnuradio/attributes.h>
+#include <gnuradio/basic_block.h>
+
+#include "source_iface.h"
+#include "sink_iface.h"
+
+/*
+ * Registration interface of the backend modules.
+ *
+ * Every backend is built as a module of its own (gr-osmosdr-<name>) which
+ * is loaded the first time a device argument or a device enumeration asks
+ * for it, see backend_loader.h. A flowgraph using rtl=0 thus never loads
+ * UHD, SoapySDR and the other vendor libraries.
+ *
+ * A module describes itself with a static osmosdr_backend_t returned by
+ * the function OSMOSDR_BACKEND() defines. Modules are built along with
+ * the library and share its C++ types, so the version below has to be
+ * bumped whenever this struct, source_iface or sink_iface change.
+ */
+#define OSMOSDR_BACKEND_ABI_VERSION 1
+
+#define OSMOSDR_BACKEND_ENTRY "osmosdr_backend_entry"
+
+typedef source_iface *(*backend_make_source_t)( const std::string &args,
+                                                gr::basic_block_sptr &block );
+typedef sink_iface *(*backend_make_sink_t)( const std::string &args,
+                                            gr::basic_block_sptr &block );
+typedef std::vector< std::string > (*backend_devices_t)( bool fake );
+
+struct osmosdr_backend_t
+{
+  unsigned int abi_version; /* OSMOSDR_BACKEND_ABI_VERSION */
+  const char *name;         /* e.g. "rtl", as in the module name */
+
+  /* either pair is NULL for receive or transmit only backends */
+  backend_make_source_t make_source;
+  backend_devices_t source_devices;
+  backend_make_sink_t make_sink;
+  backend_devices_t sink_devices;
+};
+
+typedef const osmosdr_backend_t *(*backend_entry_t)( void );
+
+/* adapts the make_xxx_source_c() factory of a backend */
+template < class T, std::shared_ptr< T > (*make)( const std::string & ) >
+source_iface *backend_make_source( const std::string &args,
+                                   gr::basic_block_sptr &block )
+{
+  std::shared_ptr< T > src = make( args );
+  block = src;
+  return src.get();
+}
+
+/* adapts the make_xxx_sink_c() factory of a backend */
+template < class T, std::shared_ptr< T > (*make)( const std::string & ) >
+sink_iface *backend_make_sink( const std::string &args,
+                               gr::basic_block_sptr &block )
+{
+  std::shared_ptr< T > sink = make( args );
+  block = sink;
+  return sink.get();
+}
+
+#define OSMOSDR_BACKEND( backend ) \
+  extern "C" __GR_ATTR_EXPORT const osmosdr_backend_t *osmosdr_backend_entry( void ) \
+  { \
+    return &backend; \
+  }
+
+#endif // OSMOSDR_BACKEND_H
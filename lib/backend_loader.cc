@@ -0,0 +1,343 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include "backend_loader.h"
+
+#ifdef _WIN32
+#define MODULE_PATH_DELIM ';'
+#else
+#define MODULE_PATH_DELIM ':'
+#endif
+
+struct backend_info_t
+{
+  const char *name;
+  int roles;
+  int enum_flags;         /* DEVICE_ENUM_xxx, known before the module loads */
+  const char *aliases[6]; /* further device argument keys, NULL terminated */
+};
+
+/* the backends built along with the library, in the order they are listed */
+static const backend_info_t backends[] = {
+#ifdef ENABLE_FILE
+  { "file", BACKEND_SOURCE | BACKEND_SINK,
+    DEVICE_ENUM_SOFTWARE, { NULL } },
+#endif
+#ifdef ENABLE_FCD
+  { "fcd", BACKEND_SOURCE,
+    DEVICE_ENUM_HOTPLUG, { NULL } },
+#endif
+#ifdef ENABLE_RTL
+  { "rtl", BACKEND_SOURCE,
+    DEVICE_ENUM_HOTPLUG, { NULL } },
+#endif
+#ifdef ENABLE_RTL_TCP
+  { "rtl_tcp", BACKEND_SOURCE,
+    DEVICE_ENUM_SOFTWARE, { NULL } },
+#endif
+#ifdef ENABLE_UHD
+  { "uhd", BACKEND_SOURCE | BACKEND_SINK,
+    DEVICE_ENUM_HOTPLUG | DEVICE_ENUM_NETWORK, { NULL } },
+#endif
+#ifdef ENABLE_MIRI
+  { "miri", BACKEND_SOURCE,
+    DEVICE_ENUM_HOTPLUG, { NULL } },
+#endif
+#ifdef ENABLE_SDRPLAY
+  { "sdrplay", BACKEND_SOURCE,
+    DEVICE_ENUM_HOTPLUG, { NULL } },
+#endif
+#ifdef ENABLE_HACKRF
+  { "hackrf", BACKEND_SOURCE | BACKEND_SINK,
+    DEVICE_ENUM_HOTPLUG, { NULL } },
+#endif
+#ifdef ENABLE_BLADERF
+  { "bladerf", BACKEND_SOURCE | BACKEND_SINK,
+    DEVICE_ENUM_HOTPLUG, { NULL } },
+#endif
+#ifdef ENABLE_RFSPACE
+  { "rfspace", BACKEND_SOURCE,
+    DEVICE_ENUM_HOTPLUG | DEVICE_ENUM_NETWORK |
+    DEVICE_ENUM_FAKE,
+    { "sdr-iq", "sdr-ip", "netsdr", "cloudiq", "cloudsdr", NULL } },
+#endif
+#ifdef ENABLE_AIRSPY
+  { "airspy", BACKEND_SOURCE,
+    DEVICE_ENUM_HOTPLUG, { NULL } },
+#endif
+#ifdef ENABLE_AIRSPYHF
+  { "airspyhf", BACKEND_SOURCE,
+    DEVICE_ENUM_HOTPLUG, { NULL } },
+#endif
+#ifdef ENABLE_SOAPY
+  { "soapy", BACKEND_SOURCE | BACKEND_SINK,
+    DEVICE_ENUM_HOTPLUG | DEVICE_ENUM_NETWORK |
+    DEVICE_ENUM_EXCLUSIVE, { NULL } },
+#endif
+#ifdef ENABLE_REDPITAYA
+  { "redpitaya", BACKEND_SOURCE | BACKEND_SINK,
+    DEVICE_ENUM_SOFTWARE, { NULL } },
+#endif
+#ifdef ENABLE_FREESRP
+  { "freesrp", BACKEND_SOURCE | BACKEND_SINK,
+    DEVICE_ENUM_HOTPLUG, { NULL } },
+#endif
+#ifdef ENABLE_XTRX
+  { "xtrx", BACKEND_SOURCE | BACKEND_SINK,
+    DEVICE_ENUM_HOTPLUG, { NULL } },
+#endif
+  { NULL, 0, 0, { NULL } }
+};
+
+/* one per backend name, held while that module is searched and loaded */
+struct backend_slot_t
+{
+  backend_slot_t() : backend( NULL ) {}
+
+  std::mutex mutex;
+  const osmosdr_backend_t *backend;
+};
+
+/*
+ * Held by reference by the enumeration workers, which may still run while
+ * the library is unloaded.
+ */
+struct loader_t
+{
+  std::mutex mutex; /* only guards the map, modules load without it */
+  std::map< std::string, std::unique_ptr< backend_slot_t > > loaded;
+};
+
+static const std::shared_ptr< loader_t > _loader = std::make_shared< loader_t >();
+
+std::vector< std::string > backend_device_types( int role )
+{
+  std::vector< std::string > types;
+
+  for (const backend_info_t *info = backends; info->name; info++)
+    if ( info->roles & role )
+      types.push_back( info->name );
+
+  return types;
+}
+
+std::string backend_for_args( const dict_t &dict, int role )
+{
+  std::string name;
+
+  /* like the if chain this table replaced, the last match wins */
+  for (const backend_info_t *info = backends; info->name; info++) {
+    if ( ! (info->roles & role) )
+      continue;
+
+    if ( dict.count( info->name ) )
+      name = info->name;
+
+    for (const char * const *alias = info->aliases; *alias; alias++)
+      if ( dict.count( *alias ) )
+        name = info->name;
+  }
+
+  return name;
+}
+
+static std::vector< std::string > module_dirs()
+{
+  std::vector< std::string > dirs;
+
+  if ( const char *env = getenv( "OSMOSDR_MODULE_PATH" ) ) {
+    std::string path = env;
+    size_t pos = 0, delim;
+
+    while ( (delim = path.find( MODULE_PATH_DELIM, pos )) != std::string::npos ) {
+      dirs.push_back( path.substr( pos, delim - pos ) );
+      pos = delim + 1;
+    }
+    dirs.push_back( path.substr( pos ) );
+  }
+
+#ifndef _WIN32
+  /* next to the library, also works from the build tree */
+  Dl_info info;
+  if ( dladdr( (void *)&module_dirs, &info ) && info.dli_fname ) {
+    std::string lib = info.dli_fname;
+    size_t slash = lib.rfind( '/' );
+
+    if ( slash != std::string::npos )
+      dirs.push_back( lib.substr( 0, slash ) + "/gr-osmosdr" );
+  }
+#endif
+
+  dirs.push_back( OSMOSDR_MODULE_DIR );
+
+  return dirs;
+}
+
+static backend_entry_t open_module( const std::string &path )
+{
+#ifdef _WIN32
+  HMODULE handle = LoadLibraryA( path.c_str() );
+  if ( ! handle )
+    throw std::runtime_error( "Failed to load " + path + ", error " +
+                              std::to_string( GetLastError() ) );
+
+  return (backend_entry_t) GetProcAddress( handle, OSMOSDR_BACKEND_ENTRY );
+#else
+  void *handle = dlopen( path.c_str(), RTLD_NOW | RTLD_LOCAL );
+  if ( ! handle )
+    throw std::runtime_error( "Failed to load " + path + ": " + dlerror() );
+
+  return (backend_entry_t) dlsym( handle, OSMOSDR_BACKEND_ENTRY );
+#endif
+}
+
+static const osmosdr_backend_t *load( loader_t &loader,
+                                      const std::string &name, bool required )
+{
+  backend_slot_t *slot;
+
+  {
+    std::lock_guard< std::mutex > lock( loader.mutex );
+
+    std::unique_ptr< backend_slot_t > &p = loader.loaded[ name ];
+    if ( ! p )
+      p.reset( new backend_slot_t );
+    slot = p.get();
+  }
+
+  /* loading one backend does not hold up the others */
+  std::lock_guard< std::mutex > lock( slot->mutex );
+
+  if ( slot->backend )
+    return slot->backend;
+
+  std::string file = OSMOSDR_MODULE_PREFIX + name + OSMOSDR_MODULE_SUFFIX;
+  std::string searched;
+
+  for (std::string dir : module_dirs()) {
+    std::string path = dir + "/" + file;
+
+    searched += " " + dir;
+
+    if ( ! std::ifstream( path.c_str() ).good() )
+      continue;
+
+    /* never unloaded, blocks of the backend may live until exit */
+    backend_entry_t entry = open_module( path );
+    const osmosdr_backend_t *backend = entry ? entry() : NULL;
+
+    if ( ! backend ||
+         OSMOSDR_BACKEND_ABI_VERSION != backend->abi_version ||
+         name != backend->name )
+      throw std::runtime_error( path + " is not a compatible gr-osmosdr "
+                                "backend module." );
+
+    slot->backend = backend;
+
+    return backend;
+  }
+
+  if ( ! required )
+    return NULL;
+
+  throw std::runtime_error( "Backend module " + file + " not found in" +
+                            searched + ", set OSMOSDR_MODULE_PATH." );
+}
+
+const osmosdr_backend_t *backend_load( const std::string &name, bool required )
+{
+  return load( *_loader, name, required );
+}
+
+std::vector< device_enumerator_t > backend_enumerators( int role, bool fake )
+{
+  std::vector< device_enumerator_t > enumerators;
+
+  /* software-only backends go last, hopefully resulting in hardware
+   * devices to be shown first in a graphical interface etc... */
+  for (int software = 0; software < 2; software++) {
+    for (const backend_info_t *info = backends; info->name; info++) {
+      if ( ! (info->roles & role) )
+        continue;
+
+      if ( bool(info->enum_flags & DEVICE_ENUM_SOFTWARE) != bool(software) )
+        continue;
+
+      int flags = info->enum_flags;
+
+      /* then it is the plain list, shared with the other callers */
+      if ( ! fake )
+        flags &= ~DEVICE_ENUM_FAKE;
+
+      enumerators.push_back( { info->name,
+                               backend_devices( info->name, role, fake ),
+                               flags } );
+    }
+  }
+
+  return enumerators;
+}
+
+device_list_fn_t backend_devices( const std::string &name, int role, bool fake )
+{
+  std::shared_ptr< loader_t > loader = _loader;
+
+  return [loader, name, role, fake]() {
+    std::vector< std::string > devices;
+    const osmosdr_backend_t *backend = NULL;
+
+    try {
+      backend = load( *loader, name, false );
+    } catch ( std::runtime_error &ex ) {
+      std::cerr << ex.what() << std::endl;
+    }
+
+    if ( ! backend )
+      return devices;
+
+    backend_devices_t get_devices =
+        ( role & BACKEND_SINK ) ? backend->sink_devices : backend->source_devices;
+
+    if ( get_devices )
+      devices = get_devices( fake );
+
+    return devices;
+  };
+}
@@ -0,0 +1,78 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_BACKEND_LOADER_H
+#define OSMOSDR_BACKEND_LOADER_H
+
+#include <string>
+#include <vector>
+
+#include "arg_helpers.h"
+#include "backend.h"
+#include "device_enum.h"
+
+enum {
+  BACKEND_SOURCE = 1 << 0,
+  BACKEND_SINK   = 1 << 1,
+};
+
+/*!
+ * Names of the backends built for role (BACKEND_SOURCE or BACKEND_SINK).
+ */
+std::vector< std::string > backend_device_types( int role );
+
+/*!
+ * Name of the backend claiming one of the device argument keys in dict,
+ * e.g. "rfspace" for sdr-iq=/dev/ttyUSB0. Empty if there is none. If
+ * several match, the one listed last wins.
+ */
+std::string backend_for_args( const dict_t &dict, int role );
+
+/*!
+ * \brief Loads the module of a backend, once.
+ *
+ * The module is searched in $OSMOSDR_MODULE_PATH, the gr-osmosdr
+ * directory next to the library and the install location. Loaded modules
+ * stay loaded until exit. Different backends may load concurrently.
+ *
+ * \param name the backend name
+ * \param required throw if the module is not installed, else return NULL
+ * \throw std::runtime_error if the module can't be loaded
+ */
+const osmosdr_backend_t *backend_load( const std::string &name,
+                                       bool required = true );
+
+/*!
+ * Device enumerators of all backends built for role, hardware backends
+ * first. With fake, backends may add placeholder devices to their lists.
+ */
+std::vector< device_enumerator_t > backend_enumerators( int role,
+                                                        bool fake = false );
+
+/*!
+ * get_devices() of a backend for device_enumerator_t. The module is only
+ * loaded once the enumeration runs. Missing modules report no devices.
+ */
+device_list_fn_t backend_devices( const std::string &name, int role,
+                                  bool fake = false );
+
+#endif // OSMOSDR_BACKEND_LOADER_H
@@ -140,6 +140,7 @@ bladerf_common::bladerf_common() :
   _samples_per_buffer(NUM_SAMPLES_PER_BUFFER),
   _num_transfers(NUM_TRANSFERS),
   _stream_timeout(STREAM_TIMEOUT_MS),
+  _async(false),
   _format(BLADERF_FORMAT_SC16_Q11)
 {
 }
@@ -313,6 +314,18 @@ void bladerf_common::init(dict_t const &dict, bladerf_direction direction)
     _stream_timeout = boost::lexical_cast<unsigned int>(_get(dict, "stream_timeout_ms"));
   }
 
+  /* Select the streaming interface */
+  if (dict.count("stream")) {
+    if (_get(dict, "stream") == "async") {
+      _async = (direction == BLADERF_RX);
+      if (!_async) {
+        BLADERF_WARNING("Asynchronous streaming is only supported for receive, using sync");
+      }
+    } else if (_get(dict, "stream") != "sync") {
+      BLADERF_THROW("Specified stream mode invalid. Valid modes: [sync|async]");
+    }
+  }
+
   /* Set feature */
   if (dict.count("feature")) {
     if (_get(dict, "feature") == "oversample") {
@@ -334,6 +347,12 @@ void bladerf_common::init(dict_t const &dict, bladerf_direction direction)
     BLADERF_INFO(feature_text + " feature enabled");
   }
 
+  /* Ranges are answered from disk for a device we've seen before, the
+   * feature is part of the key as it changes the sample rate range */
+  if (args_to_caps_cache(dict_to_args_string(dict))) {
+    _caps.load(caps_key(direction));
+  }
+
   /* Explicately set sample_format */
   if (dict.count("sample_format")) {
     if (_get(dict, "sample_format") == "16" || _get(dict, "sample_format") == "16bit") {
@@ -354,8 +373,12 @@ void bladerf_common::init(dict_t const &dict, bladerf_direction direction)
   }
 
   if (dict.count("enable_metadata") > 0) {
-    _format = (_format == BLADERF_FORMAT_SC16_Q11) ? BLADERF_FORMAT_SC16_Q11_META : BLADERF_FORMAT_SC8_Q7_META;
-    BLADERF_INFO("Meta mode enabled");
+    if (_async) {
+      BLADERF_WARNING("Metadata is not available with stream=async, ignoring enable_metadata");
+    } else {
+      _format = (_format == BLADERF_FORMAT_SC16_Q11) ? BLADERF_FORMAT_SC16_Q11_META : BLADERF_FORMAT_SC8_Q7_META;
+      BLADERF_INFO("Meta mode enabled");
+    }
   }
 
   /* Require value to be >= 2 so we can ensure we have twice as many
@@ -388,10 +411,11 @@ void bladerf_common::init(dict_t const &dict, bladerf_direction direction)
   }
 
   BLADERF_INFO(boost::str(boost::format("Buffers: %d, samples per buffer: "
-                "%d, active transfers: %d")
+                "%d, active transfers: %d%s")
                 % _num_buffers
                 % _samples_per_buffer
-                % _num_transfers));
+                % _num_transfers
+                % (_async ? ", async" : "")));
 }
 
 std::vector<std::string> bladerf_common::devices()
@@ -554,6 +578,12 @@ bladerf_channel bladerf_common::chan2channel(bladerf_direction direction,
 }
 
 osmosdr::meta_range_t bladerf_common::sample_rates(bladerf_channel ch)
+{
+  return _caps.get(boost::str(boost::format("sample_rates:%d") % ch),
+                   [this, ch]() { return query_sample_rates(ch); });
+}
+
+osmosdr::meta_range_t bladerf_common::query_sample_rates(bladerf_channel ch)
 {
   osmosdr::meta_range_t sample_rates;
 
@@ -619,6 +649,12 @@ double bladerf_common::get_sample_rate(bladerf_channel ch)
 }
 
 osmosdr::freq_range_t bladerf_common::freq_range(bladerf_channel ch)
+{
+  return _caps.get(boost::str(boost::format("freq_range:%d") % ch),
+                   [this, ch]() { return query_freq_range(ch); });
+}
+
+osmosdr::freq_range_t bladerf_common::query_freq_range(bladerf_channel ch)
 {
 #ifdef BLADERF_COMPATIBILITY
   return osmosdr::freq_range_t( _is_xb_attached(_dev) ? 0 : 280e6,
@@ -673,6 +709,12 @@ double bladerf_common::get_center_freq(bladerf_channel ch)
 }
 
 osmosdr::freq_range_t bladerf_common::filter_bandwidths(bladerf_channel ch)
+{
+  return _caps.get(boost::str(boost::format("bandwidth_range:%d") % ch),
+                   [this, ch]() { return query_filter_bandwidths(ch); });
+}
+
+osmosdr::freq_range_t bladerf_common::query_filter_bandwidths(bladerf_channel ch)
 {
   osmosdr::freq_range_t bandwidths;
 
@@ -772,6 +814,13 @@ osmosdr::gain_range_t bladerf_common::get_gain_range(bladerf_channel ch)
 
 osmosdr::gain_range_t bladerf_common::get_gain_range(std::string const &name,
                                                      bladerf_channel ch)
+{
+  return _caps.get(boost::str(boost::format("gain_range:%d:%s") % ch % name),
+                   [this, &name, ch]() { return query_gain_range(name, ch); });
+}
+
+osmosdr::gain_range_t bladerf_common::query_gain_range(std::string const &name,
+                                                       bladerf_channel ch)
 {
 #ifdef BLADERF_COMPATIBILITY
   if( name == "LNA" ) {
@@ -1236,6 +1285,32 @@ void bladerf_common::print_device_info()
   std::cout << std::endl;
 }
 
+std::string bladerf_common::caps_key(bladerf_direction direction)
+{
+  char serial[BLADERF_SERIAL_LENGTH];
+  struct bladerf_version lib, fw, fpga;
+  bladerf_xb xb = BLADERF_XB_NONE;
+
+  bladerf_version(&lib);
+
+  if (bladerf_get_serial(_dev.get(), serial) != 0 ||
+      bladerf_fw_version(_dev.get(), &fw) != 0 ||
+      bladerf_fpga_version(_dev.get(), &fpga) != 0 ||
+      bladerf_expansion_get_attached(_dev.get(), &xb) != 0) {
+    return "";
+  }
+
+  /* An attached XB-200 changes the frequency range, the feature and the
+   * library release change the sample rate range */
+  return boost::str(boost::format("bladerf %s lib %d.%d.%d fw %d.%d.%d "
+                                  "fpga %d.%d.%d xb %d feature %d %s")
+                    % serial % lib.major % lib.minor % lib.patch
+                    % fw.major % fw.minor % fw.patch
+                    % fpga.major % fpga.minor % fpga.patch % xb
+                    % static_cast<int>(_feature)
+                    % (direction == BLADERF_TX ? "tx" : "rx"));
+}
+
 bool bladerf_common::is_antenna_valid(bladerf_direction dir,
                                       const std::string &antenna)
 {
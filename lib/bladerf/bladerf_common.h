@@ -32,6 +32,7 @@
 
 #include "osmosdr/ranges.h"
 #include "arg_helpers.h"
+#include "caps_cache.h"
 
 #include "bladerf_compat.h"
 
@@ -127,6 +128,8 @@ protected:
    * USB INTERFACE CONTROL:
    *  buffers         (default: NUM_BUFFERS)
    *  buflen          (default: NUM_SAMPLES_PER_BUFFER)
+   *  stream          sync, async (default: sync)
+   *                    ** Note: async is valid on receive channels only
    *  stream_timeout  valid time in milliseconds (default: 3000)
    *  transfers       (default: NUM_TRANSFERS)
    * FPGA CONTROL:
@@ -255,6 +258,7 @@ protected:
   size_t _samples_per_buffer;   /**< how many samples per buffer */
   size_t _num_transfers;        /**< number of active backend transfers */
   unsigned int _stream_timeout; /**< timeout for backend transfers */
+  bool _async;                  /**< use bladerf_stream() instead of sync */
 
   bladerf_feature _feature;     /**< feature assigned to board */
   bladerf_format _format;       /**< sample format to use */
@@ -285,12 +289,23 @@ private:
   static bladerf_sptr get_cached_device(struct bladerf_devinfo devinfo);
   /* Prints a summary of device information */
   void print_device_info();
+  /* Identifies the device for the capability cache, empty if unknown */
+  std::string caps_key(bladerf_direction direction);
+
+  /* Ask libbladeRF for the ranges, bypassing the capability cache */
+  osmosdr::meta_range_t query_sample_rates(bladerf_channel ch);
+  osmosdr::freq_range_t query_freq_range(bladerf_channel ch);
+  osmosdr::freq_range_t query_filter_bandwidths(bladerf_channel ch);
+  osmosdr::gain_range_t query_gain_range(std::string const &name,
+                                         bladerf_channel ch);
 
   bool is_antenna_valid(bladerf_direction dir, const std::string &antenna);
 
   /*****************************************************************************
    * Private members
    ****************************************************************************/
+  caps_cache _caps;               /**< ranges reported by the device */
+
   static std::mutex _devs_mutex;  /**< mutex for access to _devs */
   static std::list<std::weak_ptr<struct bladerf> > _devs;  /**< dev cache */
 };
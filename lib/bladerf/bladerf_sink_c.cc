@@ -40,6 +40,7 @@
 
 #include "arg_helpers.h"
 #include "bladerf_sink_c.h"
+#include "convert_kernels.h"
 #include "osmosdr/sink.h"
 
 using namespace boost::assign;
@@ -69,7 +70,6 @@ bladerf_sink_c::bladerf_sink_c(const std::string &args) :
                   args_to_io_signature(args),
                   gr::io_signature::make(0, 0, 0)),
   _16icbuf(NULL),
-  _32fcbuf(NULL),
   _in_burst(false),
   _running(false)
 {
@@ -184,7 +184,6 @@ bool bladerf_sink_c::start()
   size_t alignment = volk_get_alignment();
 
   _16icbuf = reinterpret_cast<int16_t *>(volk_malloc(2*_samples_per_buffer*sizeof(int16_t), alignment));
-  _32fcbuf = reinterpret_cast<gr_complex *>(volk_malloc(_samples_per_buffer*sizeof(gr_complex), alignment));
 
   _running = true;
 
@@ -216,9 +215,7 @@ bool bladerf_sink_c::stop()
 
   /* Deallocate conversion memory */
   volk_free(_16icbuf);
-  volk_free(_32fcbuf);
   _16icbuf = NULL;
-  _32fcbuf = NULL;
 
   return true;
 }
@@ -237,32 +234,27 @@ int bladerf_sink_c::work(int noutput_items,
     return 0;
   }
 
-  // copy the samples from input_items
   gr_complex const **in = reinterpret_cast<gr_complex const **>(&input_items[0]);
+  int8_t *out8 = reinterpret_cast<int8_t *>(_16icbuf);
+  bool sc8 = (_format == BLADERF_FORMAT_SC8_Q7 ||
+              _format == BLADERF_FORMAT_SC8_Q7_META);
 
+  // convert floating point to fixed point and scale, interleaving the
+  // streams for MIMO on the way
   if (nstreams > 1) {
-    // we need to interleave the streams as we copy
-    gr_complex *intl_out = _32fcbuf;
+    size_t const nitems = noutput_items / nstreams;
 
-    for (size_t i = 0; i < (noutput_items/nstreams); ++i) {
-      for (size_t n = 0; n < nstreams; ++n) {
-        memcpy(intl_out++, in[n]++, sizeof(gr_complex));
-      }
+    if (sc8) {
+      convert_fc32_s8_x2(in[0], in[1], out8, nitems, SCALING_FACTOR_SC8_Q7);
+    } else {
+      convert_fc32_s16_x2(in[0], in[1], _16icbuf, nitems, SCALING_FACTOR_SC16_Q11);
     }
   } else {
-    // no interleaving to do: simply copy everything
-    memcpy(_32fcbuf, in[0], noutput_items * sizeof(gr_complex));
-  }
-
-  // convert floating point to fixed point and scale
-  // input_items is gr_complex (2x float), so num_points is 2*noutput_items
-  if (_format == BLADERF_FORMAT_SC8_Q7 || _format == BLADERF_FORMAT_SC8_Q7_META) {
-    volk_32f_s32f_convert_8i((int8_t*)_16icbuf, reinterpret_cast<float const *>(_32fcbuf),
-                              SCALING_FACTOR_SC8_Q7, 2*noutput_items);
-  }
-  else {
-    volk_32f_s32f_convert_16i(_16icbuf, reinterpret_cast<float const *>(_32fcbuf),
-                              SCALING_FACTOR_SC16_Q11, 2*noutput_items);
+    if (sc8) {
+      convert_fc32_s8(in[0], out8, noutput_items, SCALING_FACTOR_SC8_Q7);
+    } else {
+      convert_fc32_s16(in[0], _16icbuf, noutput_items, SCALING_FACTOR_SC16_Q11);
+    }
   }
 
   // transmit the samples from the temp buffer
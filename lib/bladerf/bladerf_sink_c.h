@@ -124,7 +124,6 @@ private:
 
   // Sample-handling buffers
   int16_t *_16icbuf;              /**< raw samples to bladeRF */
-  gr_complex *_32fcbuf;           /**< intermediate buffer for conversions */
 
   bool _in_burst;                 /**< are we currently in a burst? */
   bool _running;                  /**< is the sink running? */
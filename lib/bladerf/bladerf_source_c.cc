@@ -28,7 +28,10 @@
 #include "config.h"
 #endif
 
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <thread>
 
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
@@ -40,6 +43,7 @@
 
 #include "arg_helpers.h"
 #include "bladerf_source_c.h"
+#include "convert_kernels.h"
 #include "osmosdr/source.h"
 
 using namespace boost::assign;
@@ -67,19 +71,57 @@ bladerf_source_c_sptr make_bladerf_source_c(const std::string &args)
 bladerf_source_c::bladerf_source_c(const std::string &args) :
   gr::sync_block( "bladerf_source_c",
                   gr::io_signature::make(0, 0, 0),
-                  args_to_io_signature(args)),
+                  args_to_io_signature(args,
+                    cpu_format_item_size(args_to_cpu_format(args)))),
   _16icbuf(NULL),
-  _32fcbuf(NULL),
   _running(false),
-  _agcmode(BLADERF_GAIN_DEFAULT)
+  _agcmode(BLADERF_GAIN_DEFAULT),
+  _tagger([this](size_t chan, const gr::tag_t &tag) {
+            if (chan < get_num_channels()) add_item_tag(chan, tag);
+          }, gr::sync_block::name(), args_to_io_signature(args)->max_streams()),
+  _timestamp_rate(0),
+  _stats(args_to_io_signature(args)->max_streams()),
+  _stream(NULL),
+  _stream_bufs(NULL),
+  _cur_buf(NULL),
+  _cur_offset(0),
+  _spare(NULL),
+  _dropping(false),
+  _streaming(false),
+  _start_time(-1),
+  _start_timestamp(0),
+  _start_pending(false),
+  _next_timestamp(0),
+  _have_next_timestamp(false)
 {
   int status;
 
   dict_t dict = params_to_dict(args);
 
+  _cpu_format = args_to_cpu_format(args);
+
   /* Perform src/sink agnostic initializations */
   init(dict, BLADERF_RX);
 
+  /* Timed start at a device time given in seconds, this needs metadata */
+  if (dict.count("rx_start_time")) {
+    if (_async) {
+      BLADERF_WARNING("rx_start_time is not available with stream=async, ignoring it");
+    } else if (_format == BLADERF_FORMAT_SC16_Q11_PACKED) {
+      BLADERF_WARNING("rx_start_time is not available with packed samples, ignoring it");
+    } else {
+      _start_time = boost::lexical_cast<double>(dict["rx_start_time"]);
+
+      if (_format == BLADERF_FORMAT_SC16_Q11) {
+        _format = BLADERF_FORMAT_SC16_Q11_META;
+        BLADERF_INFO("Meta mode enabled for rx_start_time");
+      } else if (_format == BLADERF_FORMAT_SC8_Q7) {
+        _format = BLADERF_FORMAT_SC8_Q7_META;
+        BLADERF_INFO("Meta mode enabled for rx_start_time");
+      }
+    }
+  }
+
   /* Handle setting of sampling mode */
   if (dict.count("sampling")) {
     bladerf_sampling sampling = BLADERF_SAMPLING_UNKNOWN;
@@ -166,11 +208,11 @@ bladerf_source_c::bladerf_source_c(const std::string &args) :
 
     set_output_signature(gr::io_signature::make(get_max_channels(),
                                                 get_max_channels(),
-                                                sizeof(gr_complex)));
+                                                cpu_format_item_size(_cpu_format)));
   }
 
   /* Set up constraints */
-  int const alignment_multiple = volk_get_alignment() / sizeof(gr_complex);
+  int const alignment_multiple = volk_get_alignment() / cpu_format_item_size(_cpu_format);
   set_alignment(std::max(1,alignment_multiple));
   set_max_noutput_items(_samples_per_buffer);
   set_output_multiple(get_num_channels());
@@ -235,11 +277,25 @@ bool bladerf_source_c::start()
     BLADERF_THROW_STATUS(status, "bladeRF enable_feature failed");
   }
 
-  status = bladerf_sync_config(_dev.get(), _layout, _format, _num_buffers,
-                               _samples_per_buffer, _num_transfers,
-                               _stream_timeout);
-  if (status != 0) {
-    BLADERF_THROW_STATUS(status, "bladerf_sync_config failed");
+  if (_async) {
+    status = bladerf_init_stream(&_stream, _dev.get(), stream_callback,
+                                 &_stream_bufs, _num_buffers, _format,
+                                 _samples_per_buffer, _num_transfers, this);
+    if (status != 0) {
+      BLADERF_THROW_STATUS(status, "bladerf_init_stream failed");
+    }
+
+    status = bladerf_set_stream_timeout(_dev.get(), BLADERF_RX, _stream_timeout);
+    if (status != 0) {
+      BLADERF_WARNING("bladerf_set_stream_timeout failed: " << bladerf_strerror(status));
+    }
+  } else {
+    status = bladerf_sync_config(_dev.get(), _layout, _format, _num_buffers,
+                                 _samples_per_buffer, _num_transfers,
+                                 _stream_timeout);
+    if (status != 0) {
+      BLADERF_THROW_STATUS(status, "bladerf_sync_config failed");
+    }
   }
 
   for (size_t ch = 0; ch < get_max_channels(); ++ch) {
@@ -250,11 +306,62 @@ bool bladerf_source_c::start()
     }
   }
 
+  if (_async) {
+    /* bladerf_stream() submits the first _num_transfers buffers itself, the
+     * callback resubmits the others once work() is done with them. Every
+     * buffer may be followed by a gap marker, so _filled holds twice as
+     * many entries. */
+    _filled.reset(new sample_fifo<void *>(2 * _num_buffers));
+    _free.reset(new sample_fifo<void *>(_num_buffers));
+
+    for (size_t i = _num_transfers; i < _num_buffers; ++i) {
+      _free->write(&_stream_bufs[i], 1);
+    }
+
+    _cur_buf = NULL;
+    _spare = NULL;
+    _dropping = false;
+    _streaming = true;
+    _stream_thread = gr::thread::thread([this] { stream_task(); });
+  }
+
+  /* the timestamp counter runs at the sample rate */
+  _timestamp_rate = get_sample_rate();
+
+  _have_next_timestamp = false;
+  _start_pending = (_start_time >= 0);
+  if (_start_pending) {
+    _start_timestamp = static_cast<uint64_t>(std::llround(_start_time * _timestamp_rate));
+
+    // bladerf_sync_rx() would fail on a past timestamp until the
+    // consecutive error limit ends the stream
+    bladerf_timestamp now;
+    status = bladerf_get_timestamp(_dev.get(), BLADERF_RX, &now);
+    if (status != 0) {
+      BLADERF_THROW_STATUS(status, "Failed to read the timestamp counter");
+    }
+
+    if (_start_timestamp <= now) {
+      BLADERF_THROW(boost::str(boost::format("rx_start_time %f s has already "
+                    "passed, the device time is %f s") % _start_time
+                    % (now / _timestamp_rate)));
+    }
+
+    BLADERF_INFO("receiving from timestamp " << _start_timestamp);
+  }
+
   /* Allocate memory for conversions in work() */
   size_t alignment = volk_get_alignment();
 
-  _16icbuf = reinterpret_cast<int16_t *>(volk_malloc(2*_samples_per_buffer*sizeof(int16_t), alignment));
-  _32fcbuf = reinterpret_cast<gr_complex *>(volk_malloc(_samples_per_buffer*sizeof(gr_complex), alignment));
+  if (!_async) {
+    _16icbuf = reinterpret_cast<int16_t *>(volk_malloc(2*_samples_per_buffer*sizeof(int16_t), alignment));
+  }
+
+  _tagger.set_rate(_timestamp_rate);
+  for (size_t ch = 0; ch < get_num_channels(); ++ch) {
+    _tagger.set_freq(get_center_freq(ch), ch);
+  }
+  _tagger.start();
 
   _running = true;
 
@@ -276,6 +383,20 @@ bool bladerf_source_c::stop()
 
   _running = false;
 
+  /* the callback sees the flag on the next buffer, so this has to happen
+   * while the channels are still enabled */
+  if (_async) {
+    _streaming = false;
+    _stream_thread.join();
+
+    bladerf_deinit_stream(_stream);
+    _stream = NULL;
+    _stream_bufs = NULL;
+    _filled.reset();
+    _free.reset();
+    _cur_buf = NULL;
+  }
+
   for (size_t ch = 0; ch < get_max_channels(); ++ch) {
     bladerf_channel brfch = BLADERF_CHANNEL_RX(ch);
     if (get_channel_enable(brfch)) {
@@ -286,11 +407,17 @@ bool bladerf_source_c::stop()
     }
   }
 
+  /* retunes still queued in the device would go untagged after a restart */
+  if (!_retunes.empty()) {
+    for (size_t ch = 0; ch < get_num_channels(); ++ch) {
+      bladerf_cancel_scheduled_retunes(_dev.get(), chan2channel(BLADERF_RX, ch));
+    }
+    _retunes.clear();
+  }
+
   /* Deallocate conversion memory */
   volk_free(_16icbuf);
-  volk_free(_32fcbuf);
   _16icbuf = NULL;
-  _32fcbuf = NULL;
 
   return true;
 }
@@ -304,6 +431,11 @@ int bladerf_source_c::work(int noutput_items,
   struct bladerf_metadata *meta_ptr = NULL;
   size_t nstreams = num_streams(_layout);
 
+  // the stream thread owns the device, work_async() only guards the fifos
+  if (_async) {
+    return work_async(noutput_items, output_items);
+  }
+
   gr::thread::scoped_lock guard(d_mutex);
 
   // if we aren't running, nothing to do here
@@ -311,15 +443,47 @@ int bladerf_source_c::work(int noutput_items,
     return 0;
   }
 
-  // set up metadata
-  if (BLADERF_FORMAT_SC16_Q11_META == _format) {
+  // bladerf_sync_rx() gives up after the stream timeout, so it only gets
+  // the start time once that is less than half a timeout away. Until then
+  // we wait in slices without the lock and let the scheduler call again.
+  if (_start_pending && _stream_timeout > 0) {
+    bladerf_timestamp now;
+    status = bladerf_get_timestamp(_dev.get(), BLADERF_RX, &now);
+
+    if (status == 0 && _start_timestamp > now) {
+      double const half = _stream_timeout / 2.0;
+      double const wait_ms = (_start_timestamp - now) * 1000.0 / _timestamp_rate;
+
+      if (wait_ms > half) {
+        guard.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(
+          static_cast<long>(std::ceil(std::min(wait_ms - half, half)))));
+        return 0;
+      }
+    }
+  }
+
+  // set up metadata, the first read waits for rx_start_time if given
+  if (BLADERF_FORMAT_SC16_Q11_META == _format ||
+      BLADERF_FORMAT_SC8_Q7_META == _format) {
     memset(&meta, 0, sizeof(meta));
-    meta.flags = BLADERF_META_FLAG_RX_NOW;
+    if (_start_pending) {
+      meta.timestamp = _start_timestamp;
+    } else {
+      meta.flags = BLADERF_META_FLAG_RX_NOW;
+    }
     meta_ptr = &meta;
   }
 
+  bool sc8 = (_format == BLADERF_FORMAT_SC8_Q7 ||
+              _format == BLADERF_FORMAT_SC8_Q7_META);
+
+  // SISO int8 needs no conversion and goes straight to the output buffer
+  bool passthrough = (nstreams == 1 && sc8 && _cpu_format == CPU_FORMAT_SC8);
+  void *rxbuf = passthrough ? output_items[0] : static_cast<void *>(_16icbuf);
+
   // grab samples into temp buffer
-  status = bladerf_sync_rx(_dev.get(), static_cast<void *>(_16icbuf),
+  status = bladerf_sync_rx(_dev.get(), rxbuf,
                            noutput_items, meta_ptr, _stream_timeout);
   if (status != 0) {
     BLADERF_WARNING(boost::str(boost::format("bladerf_sync_rx error: %s")
@@ -332,35 +496,261 @@ int bladerf_source_c::work(int noutput_items,
     }
   } else {
     _failures = 0;
+
+    if (meta_ptr != NULL) {
+      _start_pending = false;
+
+      // an overrun cuts the read short, the samples after actual_count are
+      // garbage and the next timestamp jumps over the lost ones
+      noutput_items = meta.actual_count - (meta.actual_count % nstreams);
+
+      check_timestamp(meta.timestamp, noutput_items/nstreams);
+
+      osmosdr::time_spec_t const time =
+        osmosdr::time_spec_t::from_ticks(meta.timestamp, _timestamp_rate);
+      _tagger.tag(nitems_written(0), &time);
+
+      tag_retunes(meta.timestamp, noutput_items/nstreams);
+    } else {
+      _tagger.tag(nitems_written(0));
+    }
+  }
+
+  if (!passthrough) {
+    convert(_16icbuf, output_items, noutput_items);
+  }
+
+  return noutput_items/(get_num_channels());
+}
+
+void bladerf_source_c::check_timestamp(uint64_t timestamp, size_t count)
+{
+  // samples missing between the previous read and this one were dropped
+  if (_have_next_timestamp && timestamp != _next_timestamp) {
+    uint64_t lost = (timestamp > _next_timestamp) ?
+                    timestamp - _next_timestamp : 0;
+
+    BLADERF_DEBUG("timestamp gap of " << lost << " samples");
+
+    for (size_t ch = 0; ch < get_num_channels(); ++ch) {
+      _stats.overflow(lost, ch);
+    }
+    _tagger.discontinuity();
+  }
+
+  _next_timestamp = timestamp + count;
+  _have_next_timestamp = true;
+}
+
+void bladerf_source_c::tag_retunes(uint64_t timestamp, size_t count)
+{
+  // every retune scheduled before the end of this buffer took effect on the
+  // sample at its timestamp, or on the first one if it fell into a gap
+  while (!_retunes.empty() && _retunes.begin()->first < timestamp + count) {
+    uint64_t const when = std::max(_retunes.begin()->first, timestamp);
+
+    // retunes of several channels at the same time share one set of tags
+    while (!_retunes.empty() &&
+           std::max(_retunes.begin()->first, timestamp) == when) {
+      _tagger.set_freq(_retunes.begin()->second.second,
+                       _retunes.begin()->second.first);
+      _retunes.erase(_retunes.begin());
+    }
+
+    osmosdr::time_spec_t const time =
+      osmosdr::time_spec_t::from_ticks(when, _timestamp_rate);
+    _tagger.tag(nitems_written(0) + (when - timestamp), &time);
+  }
+}
+
+int bladerf_source_c::work_async(int noutput_items,
+                                 gr_vector_void_star &output_items)
+{
+  size_t nstreams = num_streams(_layout);
+  bool sc8 = (_format == BLADERF_FORMAT_SC8_Q7);
+  size_t sample_size = sc8 ? 2*sizeof(int8_t) : 2*sizeof(int16_t);
+
+  // set_antenna() restarts the stream at runtime, and stop() frees the
+  // fifos and the buffers we are handing out
+  gr::thread::scoped_lock guard(d_mutex);
+
+  if (!_running) {
+    return 0;
+  }
+
+  // a buffer is held across calls until all of it was handed out
+  while (_cur_buf == NULL) {
+    if (!_filled->wait_for(1, std::chrono::milliseconds(_stream_timeout))) {
+      return _streaming ? 0 : WORK_DONE;
+    }
+
+    _filled->read(&_cur_buf, 1);
+    _cur_offset = 0;
+
+    if (_cur_buf == NULL) {
+      // the callback dropped buffers here
+      _tagger.discontinuity();
+    }
+  }
+
+  _tagger.tag(nitems_written(0));
+
+  size_t count = std::min(static_cast<size_t>(noutput_items),
+                          _samples_per_buffer - _cur_offset);
+
+  convert(static_cast<char const *>(_cur_buf) + _cur_offset * sample_size,
+          output_items, count);
+
+  _cur_offset += count;
+  if (_cur_offset == _samples_per_buffer) {
+    _free->write(&_cur_buf, 1);
+    _cur_buf = NULL;
+  }
+
+  return count/nstreams;
+}
+
+void *bladerf_source_c::stream_callback(struct bladerf *dev,
+                                        struct bladerf_stream *stream,
+                                        struct bladerf_metadata *meta,
+                                        void *samples, size_t num_samples,
+                                        void *user_data)
+{
+  bladerf_source_c *obj = static_cast<bladerf_source_c *>(user_data);
+
+  return obj->stream_callback(samples, num_samples);
+}
+
+void *bladerf_source_c::stream_callback(void *samples, size_t num_samples)
+{
+  void *next = NULL;
+
+  if (!_streaming) {
+    return BLADERF_STREAM_SHUTDOWN;
   }
 
-  // convert from int16_t to float
-  // output_items is gr_complex (2x float), so num_points is 2*noutput_items
-  if (_format == BLADERF_FORMAT_SC8_Q7 || _format == BLADERF_FORMAT_SC8_Q7_META) {
-    volk_8i_s32f_convert_32f(reinterpret_cast<float *>(_32fcbuf), (int8_t*)_16icbuf,
-                              SCALING_FACTOR_SC8_Q7, 2*noutput_items);
+  // hand the filled buffer to work() and resubmit a recycled one. If work()
+  // fell behind, drop the samples and resubmit their own buffer instead.
+  // A recycled buffer that couldn't be used is kept for the next call, as
+  // only work() may write to _free.
+  if (_spare == NULL && _free->read(&_spare, 1) != 1) {
+    _spare = NULL;
+  }
+
+  if (_spare != NULL && _filled->write(&samples, 1) == 1) {
+    next = _spare;
+    _spare = NULL;
+    _dropping = false;
   } else {
-    volk_16i_s32f_convert_32f(reinterpret_cast<float *>(_32fcbuf), _16icbuf,
-                              SCALING_FACTOR_SC16_Q11, 2*noutput_items);
+    next = samples;
+
+    size_t nstreams = num_streams(_layout);
+    for (size_t ch = 0; ch < nstreams; ++ch) {
+      _stats.overflow(num_samples/nstreams, ch);
+    }
+
+    // mark the gap once, so work() can tag the discontinuity in place
+    if (!_dropping) {
+      void *gap = NULL;
+      _dropping = (_filled->write(&gap, 1) == 1);
+    }
   }
-  // copy the samples into output_items
-  gr_complex **out = reinterpret_cast<gr_complex **>(&output_items[0]);
 
-  if (nstreams > 1) {
-    // we need to deinterleave the multiplex as we copy
-    gr_complex const *deint_in = _32fcbuf;
+  return next;
+}
+
+void bladerf_source_c::stream_task()
+{
+  int status = bladerf_stream(_stream, _layout);
+
+  if (status < 0) {
+    BLADERF_WARNING("bladerf_stream error: " << bladerf_strerror(status));
+  }
+
+  // wake up work(), which ends the flowgraph if we stopped on our own
+  _streaming = false;
+  _filled->interrupt();
+}
 
-    for (size_t i = 0; i < (noutput_items/nstreams); ++i) {
-      for (size_t n = 0; n < nstreams; ++n) {
-        memcpy(out[n]++, deint_in++, sizeof(gr_complex));
+void bladerf_source_c::convert(void const *in,
+                               gr_vector_void_star &output_items,
+                               int noutput_items)
+{
+  size_t nstreams = num_streams(_layout);
+  bool sc8 = (_format == BLADERF_FORMAT_SC8_Q7 ||
+              _format == BLADERF_FORMAT_SC8_Q7_META);
+
+  // convert from the wire format to the requested cpu_format, deinterleaving
+  // the MIMO multiplex on the way
+  int16_t const *in16 = static_cast<int16_t const *>(in);
+  int8_t const *in8 = static_cast<int8_t const *>(in);
+
+  if (nstreams > 1) {
+    size_t const nitems = noutput_items / nstreams;
+
+    switch (_cpu_format) {
+    case CPU_FORMAT_SC8:
+      {
+        int8_t **out = reinterpret_cast<int8_t **>(&output_items[0]);
+        if (sc8) {
+          convert_s8_sc8_x2(in8, out[0], out[1], nitems);
+        } else {
+          convert_s16_sc8_x2(in16, out[0], out[1], nitems, 4);
+        }
+      }
+      break;
+    case CPU_FORMAT_SC16:
+      {
+        int16_t **out = reinterpret_cast<int16_t **>(&output_items[0]);
+        if (sc8) {
+          convert_s8_sc16_x2(in8, out[0], out[1], nitems);
+        } else {
+          convert_s16_sc16_x2(in16, out[0], out[1], nitems, 4);
+        }
+      }
+      break;
+    default:
+      {
+        gr_complex **out = reinterpret_cast<gr_complex **>(&output_items[0]);
+        if (sc8) {
+          convert_s8_fc32_x2(in8, out[0], out[1], nitems,
+                             1.0f/SCALING_FACTOR_SC8_Q7);
+        } else {
+          convert_s16_fc32_x2(in16, out[0], out[1], nitems,
+                              1.0f/SCALING_FACTOR_SC16_Q11);
+        }
       }
     }
   } else {
-    // no deinterleaving to do: simply copy everything
-    memcpy(out[0], _32fcbuf, sizeof(gr_complex) * noutput_items);
+    switch (_cpu_format) {
+    case CPU_FORMAT_SC8:
+      if (sc8) {
+        memcpy(output_items[0], in8, 2*noutput_items);
+      } else {
+        convert_s16_sc8(in16, reinterpret_cast<int8_t *>(output_items[0]),
+                        noutput_items, 4);
+      }
+      break;
+    case CPU_FORMAT_SC16:
+      if (sc8) {
+        convert_s8_sc16(in8, reinterpret_cast<int16_t *>(output_items[0]),
+                        noutput_items);
+      } else {
+        convert_s16_sc16(in16, reinterpret_cast<int16_t *>(output_items[0]),
+                         noutput_items, 4);
+      }
+      break;
+    default:
+      if (sc8) {
+        convert_s8_fc32(in8, reinterpret_cast<gr_complex *>(output_items[0]),
+                        noutput_items, 1.0f/SCALING_FACTOR_SC8_Q7);
+      } else {
+        convert_s16_fc32(in16, reinterpret_cast<gr_complex *>(output_items[0]),
+                         noutput_items, 1.0f/SCALING_FACTOR_SC16_Q11);
+      }
+    }
   }
 
-  return noutput_items/(get_num_channels());
 }
 
 osmosdr::meta_range_t bladerf_source_c::get_sample_rates()
@@ -370,7 +760,12 @@ osmosdr::meta_range_t bladerf_source_c::get_sample_rates()
 
 double bladerf_source_c::set_sample_rate(double rate)
 {
-  return bladerf_common::set_sample_rate(rate, chan2channel(BLADERF_RX, 0));
+  double actual = bladerf_common::set_sample_rate(rate, chan2channel(BLADERF_RX, 0));
+
+  _timestamp_rate = actual;
+  _tagger.set_rate(actual);
+
+  return actual;
 }
 
 double bladerf_source_c::get_sample_rate()
@@ -385,7 +780,22 @@ osmosdr::freq_range_t bladerf_source_c::get_freq_range(size_t chan)
 
 double bladerf_source_c::set_center_freq(double freq, size_t chan)
 {
-  return bladerf_common::set_center_freq(freq, chan2channel(BLADERF_RX, chan));
+  bladerf_channel ch = chan2channel(BLADERF_RX, chan);
+  double actual;
+
+  /* a preset skips the tuning calibration */
+  auto preset = _presets.find(std::make_pair(chan, static_cast<uint64_t>(freq + 0.5)));
+  if (preset != _presets.end() &&
+      bladerf_schedule_retune(_dev.get(), ch, BLADERF_RETUNE_NOW,
+                              preset->first.second, &preset->second) == 0) {
+    actual = static_cast<double>(preset->first.second);
+  } else {
+    actual = bladerf_common::set_center_freq(freq, ch);
+  }
+
+  _tagger.set_freq(actual, chan);
+
+  return actual;
 }
 
 double bladerf_source_c::get_center_freq(size_t chan)
@@ -553,6 +963,110 @@ double bladerf_source_c::get_bandwidth(size_t chan)
   return bladerf_common::get_bandwidth(chan2channel(BLADERF_RX, chan));
 }
 
+osmosdr::stream_stats_t bladerf_source_c::get_stream_stats(size_t chan)
+{
+  return _stats.get(chan);
+}
+
+size_t bladerf_source_c::set_retune_presets(const std::vector<double> &freqs,
+                                            size_t chan)
+{
+  int status;
+  bladerf_channel ch = chan2channel(BLADERF_RX, chan);
+  size_t count = 0;
+
+  gr::thread::scoped_lock guard(d_mutex);
+
+  /* the quick tune parameters are read back after tuning to each frequency,
+   * so the receiver hops through the list once */
+  double const current = get_center_freq(chan);
+
+  for (double freq : freqs) {
+    uint64_t freqint = static_cast<uint64_t>(freq + 0.5);
+    struct bladerf_quick_tune qt;
+
+    status = bladerf_set_frequency(_dev.get(), ch, freqint);
+    if (status == 0) {
+      status = bladerf_get_quick_tune(_dev.get(), ch, &qt);
+    }
+
+    if (status != 0) {
+      BLADERF_WARNING(boost::str(boost::format("No retune preset for %d Hz: %s")
+                      % freqint % bladerf_strerror(status)));
+      continue;
+    }
+
+    _presets[std::make_pair(chan, freqint)] = qt;
+    ++count;
+  }
+
+  bladerf_common::set_center_freq(current, ch);
+
+  /* samples received meanwhile were all over the place */
+  _tagger.discontinuity();
+
+  BLADERF_INFO(count << " retune presets for channel " << chan);
+
+  return count;
+}
+
+bool bladerf_source_c::schedule_retune(double freq,
+                                       const osmosdr::time_spec_t &time,
+                                       size_t chan)
+{
+  int status;
+  bladerf_channel ch = chan2channel(BLADERF_RX, chan);
+  uint64_t freqint = static_cast<uint64_t>(freq + 0.5);
+  bladerf_timestamp timestamp = BLADERF_RETUNE_NOW;
+
+  gr::thread::scoped_lock guard(d_mutex);
+
+  if (time.get_real_secs() > 0) {
+    /* tagging the sample where the retune hits needs the timestamps */
+    if (BLADERF_FORMAT_SC16_Q11_META != _format &&
+        BLADERF_FORMAT_SC8_Q7_META != _format) {
+      BLADERF_WARNING("Timed retunes need enable_metadata=1");
+      return false;
+    }
+
+    timestamp = static_cast<bladerf_timestamp>(time.to_ticks(_timestamp_rate));
+  }
+
+  auto preset = _presets.find(std::make_pair(chan, freqint));
+
+  status = bladerf_schedule_retune(_dev.get(), ch, timestamp, freqint,
+                                   preset != _presets.end() ?
+                                   &preset->second : NULL);
+  if (status != 0) {
+    BLADERF_WARNING(boost::str(boost::format("Failed to schedule retune to "
+                    "%d Hz: %s") % freqint % bladerf_strerror(status)));
+    return false;
+  }
+
+  if (BLADERF_RETUNE_NOW == timestamp) {
+    _tagger.set_freq(static_cast<double>(freqint), chan);
+  } else {
+    _retunes.insert(std::make_pair(timestamp,
+                    std::make_pair(chan, static_cast<double>(freqint))));
+  }
+
+  return true;
+}
+
+osmosdr::time_spec_t bladerf_source_c::get_time_now(size_t mboard)
+{
+  int status;
+  bladerf_timestamp timestamp;
+
+  status = bladerf_get_timestamp(_dev.get(), BLADERF_RX, &timestamp);
+  if (status != 0) {
+    BLADERF_THROW_STATUS(status, "Failed to read the timestamp counter");
+  }
+
+  /* the counter runs at the sample rate */
+  return osmosdr::time_spec_t::from_ticks(timestamp, get_sample_rate());
+}
+
 std::vector<std::string> bladerf_source_c::get_clock_sources(size_t mboard)
 {
   return bladerf_common::get_clock_sources(mboard);
@@ -22,8 +22,17 @@
 #define INCLUDED_BLADERF_SOURCE_C_H
 
 #include <gnuradio/sync_block.h>
+#include <gnuradio/thread/thread.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+
 #include "source_iface.h"
 #include "bladerf_common.h"
+#include "rx_tagger.h"
+#include "sample_fifo.h"
+#include "stream_counters.h"
 
 #include "osmosdr/ranges.h"
 
@@ -65,6 +74,21 @@ private:
 
   bool is_antenna_valid(const std::string &antenna);
 
+  void convert(void const *in, gr_vector_void_star &output_items,
+               int noutput_items);
+  void check_timestamp(uint64_t timestamp, size_t count);
+  void tag_retunes(uint64_t timestamp, size_t count);
+
+  /* stream=async */
+  static void *stream_callback(struct bladerf *dev,
+                               struct bladerf_stream *stream,
+                               struct bladerf_metadata *meta,
+                               void *samples, size_t num_samples,
+                               void *user_data);
+  void *stream_callback(void *samples, size_t num_samples);
+  void stream_task();
+  int work_async(int noutput_items, gr_vector_void_star &output_items);
+
 public:
   std::string name();
 
@@ -116,6 +140,14 @@ public:
   double set_bandwidth(double bandwidth, size_t chan = 0);
   double get_bandwidth(size_t chan = 0);
 
+  osmosdr::stream_stats_t get_stream_stats(size_t chan = 0);
+
+  size_t set_retune_presets(const std::vector<double> &freqs, size_t chan = 0);
+  bool schedule_retune(double freq, const osmosdr::time_spec_t &time,
+                       size_t chan = 0);
+
+  osmosdr::time_spec_t get_time_now(size_t mboard = 0);
+
   std::vector<std::string> get_clock_sources(size_t mboard);
   void set_clock_source(const std::string &source, size_t mboard = 0);
   std::string get_clock_source(size_t mboard);
@@ -129,7 +161,8 @@ public:
 private:
   // Sample-handling buffers
   int16_t *_16icbuf;              /**< raw samples from bladeRF */
-  gr_complex *_32fcbuf;           /**< intermediate buffer to gnuradio */
+
+  cpu_format_t _cpu_format;       /**< sample format handed to gnuradio */
 
   bool _running;                  /**< is the source running? */
   bladerf_channel_layout _layout; /**< channel layout */
@@ -137,6 +170,37 @@ private:
 
   gr::thread::mutex d_mutex;      /**< mutex to protect set/work access */
 
+  rx_tagger _tagger;              /**< rx_time/rx_rate/rx_freq tags */
+  double _timestamp_rate;         /**< ticks per second of meta.timestamp */
+  stream_counters _stats;         /**< overflow counters */
+
+  // Asynchronous streaming
+  struct bladerf_stream *_stream; /**< stream handle of bladerf_stream() */
+  void **_stream_bufs;            /**< buffers owned by libbladeRF */
+  std::unique_ptr< sample_fifo<void *> > _filled; /**< buffers for work(),
+                                                       NULL marks a gap */
+  std::unique_ptr< sample_fifo<void *> > _free;   /**< buffers to resubmit */
+  void *_cur_buf;                 /**< buffer work() is consuming */
+  size_t _cur_offset;             /**< samples consumed from _cur_buf */
+  void *_spare;                   /**< recycled buffer held by the callback */
+  bool _dropping;                 /**< gap already marked in _filled */
+  std::atomic<bool> _streaming;   /**< callback keeps resubmitting */
+  gr::thread::thread _stream_thread;
+
+  // Metadata timestamps
+  double _start_time;             /**< rx_start_time in seconds, or < 0 */
+  uint64_t _start_timestamp;      /**< rx_start_time in timestamp ticks */
+  bool _start_pending;            /**< next read waits for the start time */
+  uint64_t _next_timestamp;       /**< expected timestamp of the next read */
+  bool _have_next_timestamp;      /**< _next_timestamp is valid */
+
+  // Fast frequency hopping
+  std::map<std::pair<size_t, uint64_t>,
+           struct bladerf_quick_tune> _presets; /**< by channel and freq */
+  std::multimap<uint64_t, std::pair<size_t, double> > _retunes;
+                                  /**< scheduled retunes not tagged yet,
+                                       by timestamp */
+
   /* Scaling factor used when converting from int16_t to float */
   const float SCALING_FACTOR_SC16_Q11 = 2048.0f;
   const float SCALING_FACTOR_SC8_Q7 = 127.0f;
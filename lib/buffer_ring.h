@@ -0,0 +1,306 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_BUFFER_RING_H
+#define OSMOSDR_BUFFER_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+/*!
+ * \brief Index and wakeup logic shared by buffer_ring and sample_fifo.
+ *
+ * Keeps the producer and consumer positions of a single-producer/
+ * single-consumer ring with capacity entries. Neither side takes a lock
+ * to move them; the mutex is only touched when the consumer is actually
+ * sleeping in wait().
+ *
+ * When the ring is full the producer drops incoming data and bumps the
+ * overrun counters instead of evicting the oldest entries, which would
+ * race with the consumer.
+ */
+class spsc_ring
+{
+public:
+  size_t capacity() const { return _capacity; }
+
+  /* number of filled entries, safe to call from either side */
+  size_t used() const { return _tail.load() - _head.load(); }
+
+  /* accounts for data the producer had to drop, in units of the caller */
+  void overrun( size_t dropped )
+  {
+    _overruns.fetch_add( 1, std::memory_order_relaxed );
+    _dropped.fetch_add( dropped, std::memory_order_relaxed );
+  }
+
+  /*
+   * Blocks until at least count entries are filled. Returns false if the
+   * wait was cut short by interrupt().
+   */
+  bool wait( size_t count )
+  {
+    count = std::min( count, _capacity );
+
+    if ( used() >= count )
+      return true;
+
+    std::unique_lock<std::mutex> lock( _mutex );
+
+    _waiting.store( true );
+    while ( used() < count && ! _interrupted.load() )
+      _cond.wait( lock );
+    _waiting.store( false );
+
+    return used() >= count;
+  }
+
+  /* like wait(), but gives up after timeout and returns false */
+  template <class Rep, class Period>
+  bool wait_for( size_t count, const std::chrono::duration<Rep, Period> &timeout )
+  {
+    count = std::min( count, _capacity );
+
+    if ( used() >= count )
+      return true;
+
+    std::unique_lock<std::mutex> lock( _mutex );
+
+    _waiting.store( true );
+    _cond.wait_for( lock, timeout, [this, count] {
+      return used() >= count || _interrupted.load();
+    } );
+    _waiting.store( false );
+
+    return used() >= count;
+  }
+
+  /* wakes up a sleeping consumer, e.g. when the device stops streaming */
+  void interrupt()
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+
+    _interrupted.store( true );
+    _cond.notify_all();
+  }
+
+  /* must only be called while neither side is active */
+  void reset()
+  {
+    _head.store( 0 );
+    _tail.store( 0 );
+    _interrupted.store( false );
+  }
+
+  /* number of times the producer had to drop data */
+  uint64_t overruns() const { return _overruns.load( std::memory_order_relaxed ); }
+
+  /* amount of data dropped because the consumer fell behind */
+  uint64_t dropped() const { return _dropped.load( std::memory_order_relaxed ); }
+
+  spsc_ring( const spsc_ring & ) = delete;
+  spsc_ring &operator=( const spsc_ring & ) = delete;
+
+protected:
+  explicit spsc_ring( size_t capacity )
+    : _capacity(capacity), _head(0), _tail(0), _waiting(false),
+      _interrupted(false), _overruns(0), _dropped(0)
+  {
+    if ( 0 == capacity )
+      throw std::runtime_error("Invalid ring capacity.");
+  }
+
+  /*
+   * Producer side: position of the first free entry, *len receives the
+   * number of free entries up to the wrap-around point.
+   */
+  size_t write_pos( size_t *len ) const
+  {
+    size_t tail = _tail.load( std::memory_order_relaxed );
+    size_t free = _capacity - (tail - _head.load( std::memory_order_acquire ));
+    size_t pos = tail % _capacity;
+
+    *len = std::min( free, _capacity - pos );
+
+    return pos;
+  }
+
+  /* publishes n entries starting at write_pos() */
+  void produce( size_t n )
+  {
+    _tail.store( _tail.load( std::memory_order_relaxed ) + n );
+
+    if ( _waiting.load() ) {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _cond.notify_one();
+    }
+  }
+
+  /*
+   * Consumer side: position of the oldest filled entry, *len receives the
+   * number of filled entries up to the wrap-around point.
+   */
+  size_t read_pos( size_t *len ) const
+  {
+    size_t head = _head.load( std::memory_order_relaxed );
+    size_t used = _tail.load( std::memory_order_acquire ) - head;
+    size_t pos = head % _capacity;
+
+    *len = std::min( used, _capacity - pos );
+
+    return pos;
+  }
+
+  /* hands n entries starting at read_pos() back to the producer */
+  void consume_entries( size_t n )
+  {
+    _head.store( _head.load( std::memory_order_relaxed ) + n,
+                 std::memory_order_release );
+  }
+
+private:
+  const size_t _capacity;
+
+  /* keep producer and consumer indices on separate cache lines */
+  char _pad0[64];
+  std::atomic<size_t> _head;
+  char _pad1[64];
+  std::atomic<size_t> _tail;
+  char _pad2[64];
+  std::atomic<bool> _waiting;
+  std::atomic<bool> _interrupted;
+
+  std::atomic<uint64_t> _overruns;
+  std::atomic<uint64_t> _dropped;
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+};
+
+/*!
+ * \brief Lock-free single-producer/single-consumer ring of buffer slots.
+ *
+ * The producer (usually a driver callback) fills the slot returned by
+ * write_slot() and publishes it with commit(). The consumer (usually
+ * work()) reads the slot returned by read_slot() and hands it back with
+ * release(). The overrun counters count dropped buffers and bytes.
+ */
+class buffer_ring : public spsc_ring
+{
+public:
+  buffer_ring( size_t num, size_t len )
+    : spsc_ring(num), _len(len), _mem(NULL), _lens(num, 0)
+  {
+    if ( 0 == _len )
+      throw std::runtime_error("Invalid buffer ring geometry.");
+
+    _mem = (unsigned char *) malloc( num * _len );
+    if ( ! _mem )
+      throw std::runtime_error("Failed to allocate buffer ring.");
+  }
+
+  ~buffer_ring()
+  {
+    free( _mem );
+    _mem = NULL;
+  }
+
+  size_t len() const { return _len; }
+
+  /*
+   * Producer side
+   */
+
+  /* returns the next free slot or NULL if the ring is full */
+  unsigned char *write_slot()
+  {
+    size_t free;
+    size_t pos = write_pos( &free );
+
+    return free ? _mem + pos * _len : NULL;
+  }
+
+  /* publishes the slot previously returned by write_slot() */
+  void commit( size_t len )
+  {
+    size_t free;
+
+    _lens[ write_pos( &free ) ] = len;
+    produce( 1 );
+  }
+
+  /* convenience for producers that have to copy out of a transient buffer */
+  bool push( const unsigned char *buf, size_t len )
+  {
+    unsigned char *slot = write_slot();
+
+    if ( ! slot || len > _len ) {
+      overrun( len );
+      return false;
+    }
+
+    memcpy( slot, buf, len );
+    commit( len );
+
+    return true;
+  }
+
+  /*
+   * Consumer side
+   */
+
+  /* returns the oldest filled slot or NULL if the ring is empty */
+  unsigned char *read_slot( size_t *len = NULL )
+  {
+    size_t filled;
+    size_t pos = read_pos( &filled );
+
+    if ( ! filled )
+      return NULL;
+
+    if ( len )
+      *len = _lens[ pos ];
+
+    return _mem + pos * _len;
+  }
+
+  /* hands the slot returned by read_slot() back to the producer */
+  void release()
+  {
+    consume_entries( 1 );
+  }
+
+private:
+  const size_t _len;
+  unsigned char *_mem;
+  std::vector<size_t> _lens;
+};
+
+#endif // OSMOSDR_BUFFER_RING_H
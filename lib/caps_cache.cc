@@ -0,0 +1,255 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cerrno>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <locale>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "caps_cache.h"
+
+/* bump whenever the layout of the cache files changes */
+#define CAPS_CACHE_FORMAT "1"
+
+/*
+ * File layout, the ranges of an entry are "start stop step" triples:
+ *
+ *   gr-osmosdr caps <format> <library version>
+ *   key <key>
+ *   <name>\t<number of ranges> <ranges...>
+ *   ...
+ */
+static const std::string caps_header = "gr-osmosdr caps " CAPS_CACHE_FORMAT
+                                       " " GR_OSMOSDR_VERSION;
+
+static std::string caps_dir()
+{
+  const char *env;
+
+  /* relative paths are invalid according to the XDG spec and get ignored */
+  if ( (env = getenv( "XDG_CACHE_HOME" )) && env[0] == '/' )
+    return std::string( env ) + "/gr-osmosdr/caps";
+
+  if ( (env = getenv( "HOME" )) && env[0] )
+    return std::string( env ) + "/.cache/gr-osmosdr/caps";
+
+#ifdef _WIN32
+  if ( (env = getenv( "LOCALAPPDATA" )) && env[0] )
+    return std::string( env ) + "/gr-osmosdr/caps";
+#endif
+
+  return "";
+}
+
+static bool make_dirs( const std::string &path )
+{
+  size_t pos = 0;
+
+  do {
+    pos = path.find( '/', pos + 1 );
+    std::string dir = path.substr( 0, pos );
+#ifdef _WIN32
+    int ret = _mkdir( dir.c_str() );
+#else
+    int ret = mkdir( dir.c_str(), 0755 );
+#endif
+    if ( ret != 0 && errno != EEXIST )
+      return false;
+  } while ( pos != std::string::npos );
+
+  return true;
+}
+
+/* FNV-1a, unlike std::hash the file names must not change between builds */
+static uint64_t hash_key( const std::string &key )
+{
+  uint64_t hash = 14695981039346656037ULL;
+
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+caps_cache::caps_cache()
+{
+}
+
+void caps_cache::load( const std::string &key )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _key.clear();
+  _path.clear();
+  _ranges.clear();
+
+  if ( key.empty() || key.find( '\n' ) != std::string::npos )
+    return;
+
+  _key = key;
+
+  /* without a cache directory the ranges are at least kept in memory */
+  std::string dir = caps_dir();
+  if ( dir.empty() )
+    return;
+
+  char name[32];
+  snprintf( name, sizeof(name), "%016" PRIx64 ".caps", hash_key( key ) );
+  _path = dir + "/" + name;
+
+  if ( ! read() )
+    _ranges.clear();
+}
+
+osmosdr::meta_range_t caps_cache::get( const std::string &name,
+                                       const query_t &query )
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+
+  if ( _key.empty() || name.find_first_of( "\t\n" ) != std::string::npos ) {
+    lock.unlock();
+    return query();
+  }
+
+  std::map< std::string, osmosdr::meta_range_t >::const_iterator it =
+      _ranges.find( name );
+  if ( it != _ranges.end() )
+    return it->second;
+
+  /* the query may well end up here again for another entry */
+  lock.unlock();
+  osmosdr::meta_range_t range = query();
+  lock.lock();
+
+  _ranges[name] = range;
+  write();
+
+  return range;
+}
+
+bool caps_cache::read()
+{
+  std::ifstream file( _path.c_str() );
+  std::string line;
+
+  if ( ! std::getline( file, line ) || line != caps_header )
+    return false;
+
+  /* a different device whose key happens to hash to the same file */
+  if ( ! std::getline( file, line ) || line != "key " + _key )
+    return false;
+
+  while ( std::getline( file, line ) ) {
+    size_t tab = line.find( '\t' );
+    if ( tab == std::string::npos || tab == 0 )
+      return false;
+
+    std::istringstream values( line.substr( tab + 1 ) );
+    values.imbue( std::locale::classic() );
+
+    size_t count;
+    if ( ! (values >> count) )
+      return false;
+
+    osmosdr::meta_range_t range;
+    for (size_t i = 0; i < count; i++) {
+      double start, stop, step;
+
+      if ( ! (values >> start >> stop >> step) )
+        return false;
+
+      if ( ! std::isfinite( start ) || ! std::isfinite( stop ) ||
+           ! std::isfinite( step ) || stop < start || step < 0 )
+        return false;
+
+      range.push_back( osmosdr::range_t( start, stop, step ) );
+    }
+
+    if ( ! (values >> std::ws).eof() )
+      return false;
+
+    _ranges[ line.substr( 0, tab ) ] = range;
+  }
+
+  return true;
+}
+
+void caps_cache::write()
+{
+  if ( _path.empty() )
+    return;
+
+  std::string tmp = _path + "." + std::to_string( getpid() );
+  bool ok = make_dirs( _path.substr( 0, _path.rfind( '/' ) ) );
+
+  if ( ok ) {
+    std::ofstream file( tmp.c_str() );
+    file.imbue( std::locale::classic() );
+    file.precision( 17 ); /* enough to read back the same doubles */
+
+    file << caps_header << "\n" << "key " << _key << "\n";
+
+    for (const auto &entry : _ranges) {
+      file << entry.first << "\t" << entry.second.size();
+      for (const osmosdr::range_t &r : entry.second)
+        file << " " << r.start() << " " << r.stop() << " " << r.step();
+      file << "\n";
+    }
+
+    ok = bool( file.flush() );
+  }
+
+#ifdef _WIN32
+  if ( ok )
+    remove( _path.c_str() );
+#endif
+
+  /* replace the file in one go, concurrent readers see either version */
+  if ( ok && rename( tmp.c_str(), _path.c_str() ) == 0 )
+    return;
+
+  remove( tmp.c_str() );
+
+  std::cerr << "Failed to write capability cache " << _path
+            << ", not trying again." << std::endl;
+  _path.clear();
+}
@@ -0,0 +1,75 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_CAPS_CACHE_H
+#define OSMOSDR_CAPS_CACHE_H
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <osmosdr/ranges.h>
+
+/*!
+ * \brief Persistent store for the ranges a device reports.
+ *
+ * Some backends have to ask the hardware every time a sample rate,
+ * frequency, gain or bandwidth range is requested. Once loaded with a key
+ * identifying the hardware (serial number, firmware version, direction),
+ * the ranges are kept in $XDG_CACHE_HOME/gr-osmosdr/caps (~/.cache if
+ * unset), so later sessions with the same device answer them from disk.
+ *
+ * A cache file is discarded as a whole if it is malformed or has been
+ * written for another key or library version. Until load() has been
+ * called with a non-empty key every request goes to the hardware.
+ */
+class caps_cache
+{
+public:
+  typedef std::function< osmosdr::meta_range_t() > query_t;
+
+  caps_cache();
+
+  /* reads the entries stored for key, an empty key disables the cache */
+  void load( const std::string &key );
+
+  /*
+   * Returns the stored range called name or calls query and stores its
+   * result. Exceptions thrown by query are passed on, nothing is stored.
+   */
+  osmosdr::meta_range_t get( const std::string &name, const query_t &query );
+
+  caps_cache( const caps_cache & ) = delete;
+  caps_cache &operator=( const caps_cache & ) = delete;
+
+private:
+  bool read();
+  void write();
+
+  std::string _key;
+  std::string _path;
+  std::map< std::string, osmosdr::meta_range_t > _ranges;
+  std::mutex _mutex;
+};
+
+#endif // OSMOSDR_CAPS_CACHE_H
@@ -0,0 +1,46 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+
+#include "command_handler.h"
+
+static const pmt::pmt_t COMMAND_PORT = pmt::mp("command");
+
+command_handler_sptr make_command_handler( const command_callback_t &callback )
+{
+  return gnuradio::get_initial_sptr( new command_handler( callback ) );
+}
+
+command_handler::command_handler( const command_callback_t &callback )
+  : gr::block( "command_handler",
+               gr::io_signature::make( 0, 0, 0 ),
+               gr::io_signature::make( 0, 0, 0 ) ),
+    _callback( callback )
+{
+  message_port_register_in( COMMAND_PORT );
+  set_msg_handler( COMMAND_PORT, [this]( pmt::pmt_t msg ) { _callback( msg ); } );
+}
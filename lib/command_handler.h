@@ -0,0 +1,55 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_COMMAND_HANDLER_H
+#define OSMOSDR_COMMAND_HANDLER_H
+
+#include <gnuradio/block.h>
+
+#include <functional>
+
+class command_handler;
+
+typedef std::shared_ptr< command_handler > command_handler_sptr;
+
+/* called from the message thread for every message received */
+typedef std::function< void( pmt::pmt_t ) > command_callback_t;
+
+command_handler_sptr make_command_handler( const command_callback_t &callback );
+
+/*!
+ * \brief Message only block passing the "command" port to a callback.
+ *
+ * Hierarchical blocks cannot handle messages themselves, so source_impl
+ * connects its "command" port to one of these.
+ */
+class command_handler : public gr::block
+{
+private:
+  friend command_handler_sptr make_command_handler( const command_callback_t &callback );
+
+  command_handler( const command_callback_t &callback );
+
+  command_callback_t _callback;
+};
+
+#endif // OSMOSDR_COMMAND_HANDLER_H
@@ -0,0 +1,1587 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * config.h is generated by configure.  It contains the results
+ * of probing for features, options etc.  It should be the first
+ * file included in your .cc file.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "convert_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CONVERT_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* lets us emit code for instruction sets the compiler wasn't asked to target */
+#if defined(__GNUC__) || defined(__clang__)
+#define CONVERT_TARGET(arch) __attribute__((target(arch)))
+#else
+#define CONVERT_TARGET(arch)
+#endif
+
+/*
+ * All kernels work on n scalar values, i.e. twice the number of IQ pairs,
+ * except for the packed 12/24 bit and the two channel ones which count
+ * IQ pairs (per channel).
+ */
+typedef void (*u8_kernel_t)( const uint8_t *in, float *out, size_t n,
+                             float offset, float scale );
+typedef void (*s8_kernel_t)( const int8_t *in, float *out, size_t n,
+                             float scale );
+typedef void (*s16_kernel_t)( const int16_t *in, float *out, size_t n,
+                              float scale );
+typedef void (*s12p_kernel_t)( const uint8_t *in, float *out, size_t nitems,
+                               float scale );
+typedef void (*s16x2_kernel_t)( const int16_t *in, float *out0, float *out1,
+                                size_t nitems, float scale );
+typedef void (*s24_kernel_t)( const uint8_t *in, float *out, size_t nitems,
+                              float scale );
+typedef void (*s24x2_kernel_t)( const uint8_t *in, float *out0, float *out1,
+                                size_t nitems, float scale );
+typedef void (*to_s16_kernel_t)( const float *in, int16_t *out, size_t n,
+                                 float scale );
+typedef void (*to_s8_kernel_t)( const float *in, int8_t *out, size_t n,
+                                float scale );
+typedef void (*s8x2_kernel_t)( const int8_t *in, float *out0, float *out1,
+                               size_t nitems, float scale );
+typedef void (*to_s16x2_kernel_t)( const float *in0, const float *in1,
+                                   int16_t *out, size_t nitems, float scale );
+typedef void (*to_s8x2_kernel_t)( const float *in0, const float *in1,
+                                  int8_t *out, size_t nitems, float scale );
+
+struct convert_kernels_t
+{
+  const char *arch;
+  u8_kernel_t u8;
+  s8_kernel_t s8;
+  s16_kernel_t s16;
+  s12p_kernel_t s12p;
+  s16x2_kernel_t s16x2;
+  s24_kernel_t s24;
+  s24x2_kernel_t s24x2;
+  to_s16_kernel_t to_s16;
+  to_s8_kernel_t to_s8;
+  s8x2_kernel_t s8x2;
+  to_s16x2_kernel_t to_s16x2;
+  to_s8x2_kernel_t to_s8x2;
+};
+
+/*
+ * Portable versions, also used for the tails of the SIMD variants
+ */
+
+static void u8_generic( const uint8_t *in, float *out, size_t n,
+                        float offset, float scale )
+{
+  for (size_t i = 0; i < n; i++)
+    out[i] = (float(in[i]) - offset) * scale;
+}
+
+static void s8_generic( const int8_t *in, float *out, size_t n, float scale )
+{
+  for (size_t i = 0; i < n; i++)
+    out[i] = float(in[i]) * scale;
+}
+
+static void s16_generic( const int16_t *in, float *out, size_t n, float scale )
+{
+  for (size_t i = 0; i < n; i++)
+    out[i] = float(in[i]) * scale;
+}
+
+static void s12p_generic( const uint8_t *in, float *out, size_t nitems,
+                          float scale )
+{
+  for (size_t i = 0; i < nitems; i++, in += 3) {
+    /* left-align both 12 bit values in 16 bits, then shift the sign back in */
+    int16_t re = int16_t( (uint16_t(in[1]) << 12) | (uint16_t(in[0]) << 4) );
+    int16_t im = int16_t( (uint16_t(in[2]) << 8) | (in[1] & 0xf0) );
+
+    *out++ = float(re >> 4) * scale;
+    *out++ = float(im >> 4) * scale;
+  }
+}
+
+static void s16x2_generic( const int16_t *in, float *out0, float *out1,
+                           size_t nitems, float scale )
+{
+  for (size_t i = 0; i < nitems; i++, in += 4) {
+    *out0++ = float(in[0]) * scale;
+    *out0++ = float(in[1]) * scale;
+    *out1++ = float(in[2]) * scale;
+    *out1++ = float(in[3]) * scale;
+  }
+}
+
+/* sign extends a little endian 24 bit value */
+static inline float s24_value( const uint8_t *in )
+{
+  return float( int32_t( (uint32_t(in[2]) << 24) |
+                         (uint32_t(in[1]) << 16) |
+                         (uint32_t(in[0]) <<  8) ) >> 8 );
+}
+
+static void s24_generic( const uint8_t *in, float *out, size_t nitems,
+                         float scale )
+{
+  for (size_t i = 0; i < nitems * 2; i++, in += 3)
+    out[i] = s24_value( in ) * scale;
+}
+
+static void s24x2_generic( const uint8_t *in, float *out0, float *out1,
+                           size_t nitems, float scale )
+{
+  for (size_t i = 0; i < nitems; i++, in += 12) {
+    *out0++ = s24_value( in + 0 ) * scale;
+    *out0++ = s24_value( in + 3 ) * scale;
+    *out1++ = s24_value( in + 6 ) * scale;
+    *out1++ = s24_value( in + 9 ) * scale;
+  }
+}
+
+static void s8x2_generic( const int8_t *in, float *out0, float *out1,
+                          size_t nitems, float scale )
+{
+  for (size_t i = 0; i < nitems; i++, in += 4) {
+    *out0++ = float(in[0]) * scale;
+    *out0++ = float(in[1]) * scale;
+    *out1++ = float(in[2]) * scale;
+    *out1++ = float(in[3]) * scale;
+  }
+}
+
+static inline int16_t to_s16_value( float v )
+{
+  return int16_t( lrintf( std::min( std::max( v, -32768.0f ), 32767.0f ) ) );
+}
+
+static inline int8_t to_s8_value( float v )
+{
+  return int8_t( lrintf( std::min( std::max( v, -128.0f ), 127.0f ) ) );
+}
+
+static void to_s16_generic( const float *in, int16_t *out, size_t n,
+                            float scale )
+{
+  for (size_t i = 0; i < n; i++)
+    out[i] = to_s16_value( in[i] * scale );
+}
+
+static void to_s8_generic( const float *in, int8_t *out, size_t n,
+                           float scale )
+{
+  for (size_t i = 0; i < n; i++)
+    out[i] = to_s8_value( in[i] * scale );
+}
+
+static void to_s16x2_generic( const float *in0, const float *in1, int16_t *out,
+                              size_t nitems, float scale )
+{
+  for (size_t i = 0; i < nitems; i++, out += 4) {
+    out[0] = to_s16_value( *in0++ * scale );
+    out[1] = to_s16_value( *in0++ * scale );
+    out[2] = to_s16_value( *in1++ * scale );
+    out[3] = to_s16_value( *in1++ * scale );
+  }
+}
+
+static void to_s8x2_generic( const float *in0, const float *in1, int8_t *out,
+                             size_t nitems, float scale )
+{
+  for (size_t i = 0; i < nitems; i++, out += 4) {
+    out[0] = to_s8_value( *in0++ * scale );
+    out[1] = to_s8_value( *in0++ * scale );
+    out[2] = to_s8_value( *in1++ * scale );
+    out[3] = to_s8_value( *in1++ * scale );
+  }
+}
+
+#ifdef CONVERT_X86
+
+/*
+ * SSE2
+ */
+
+CONVERT_TARGET("sse2")
+static void u8_sse2( const uint8_t *in, float *out, size_t n,
+                     float offset, float scale )
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 voffset = _mm_set1_ps( offset );
+  const __m128 vscale = _mm_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128( (const __m128i *)(in + i) );
+    __m128i lo = _mm_unpacklo_epi8( v, zero );
+    __m128i hi = _mm_unpackhi_epi8( v, zero );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo, zero ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo, zero ) );
+    __m128 f2 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi, zero ) );
+    __m128 f3 = _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi, zero ) );
+
+    _mm_storeu_ps( out + i +  0, _mm_mul_ps( _mm_sub_ps( f0, voffset ), vscale ) );
+    _mm_storeu_ps( out + i +  4, _mm_mul_ps( _mm_sub_ps( f1, voffset ), vscale ) );
+    _mm_storeu_ps( out + i +  8, _mm_mul_ps( _mm_sub_ps( f2, voffset ), vscale ) );
+    _mm_storeu_ps( out + i + 12, _mm_mul_ps( _mm_sub_ps( f3, voffset ), vscale ) );
+  }
+
+  u8_generic( in + i, out + i, n - i, offset, scale );
+}
+
+CONVERT_TARGET("sse2")
+static void s8_sse2( const int8_t *in, float *out, size_t n, float scale )
+{
+  const __m128 vscale = _mm_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128( (const __m128i *)(in + i) );
+    /* sign extend by duplicating each byte and shifting arithmetically */
+    __m128i lo = _mm_srai_epi16( _mm_unpacklo_epi8( v, v ), 8 );
+    __m128i hi = _mm_srai_epi16( _mm_unpackhi_epi8( v, v ), 8 );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( lo, lo ), 16 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( lo, lo ), 16 ) );
+    __m128 f2 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( hi, hi ), 16 ) );
+    __m128 f3 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( hi, hi ), 16 ) );
+
+    _mm_storeu_ps( out + i +  0, _mm_mul_ps( f0, vscale ) );
+    _mm_storeu_ps( out + i +  4, _mm_mul_ps( f1, vscale ) );
+    _mm_storeu_ps( out + i +  8, _mm_mul_ps( f2, vscale ) );
+    _mm_storeu_ps( out + i + 12, _mm_mul_ps( f3, vscale ) );
+  }
+
+  s8_generic( in + i, out + i, n - i, scale );
+}
+
+CONVERT_TARGET("sse2")
+static void s16_sse2( const int16_t *in, float *out, size_t n, float scale )
+{
+  const __m128 vscale = _mm_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m128i v = _mm_loadu_si128( (const __m128i *)(in + i) );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 ) );
+
+    _mm_storeu_ps( out + i + 0, _mm_mul_ps( f0, vscale ) );
+    _mm_storeu_ps( out + i + 4, _mm_mul_ps( f1, vscale ) );
+  }
+
+  s16_generic( in + i, out + i, n - i, scale );
+}
+
+CONVERT_TARGET("sse2")
+static void s16x2_sse2( const int16_t *in, float *out0, float *out1,
+                        size_t nitems, float scale )
+{
+  const __m128 vscale = _mm_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 2 <= nitems; i += 2) {
+    __m128i v = _mm_loadu_si128( (const __m128i *)(in + i * 4) );
+
+    /* f0 = a0 b0, f1 = a1 b1 when viewed as complex pairs */
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 ) );
+
+    __m128d d0 = _mm_castps_pd( _mm_mul_ps( f0, vscale ) );
+    __m128d d1 = _mm_castps_pd( _mm_mul_ps( f1, vscale ) );
+
+    _mm_storeu_pd( (double *)(out0 + i * 2), _mm_unpacklo_pd( d0, d1 ) );
+    _mm_storeu_pd( (double *)(out1 + i * 2), _mm_unpackhi_pd( d0, d1 ) );
+  }
+
+  s16x2_generic( in + i * 4, out0 + i * 2, out1 + i * 2, nitems - i, scale );
+}
+
+/* the clamp keeps cvtps from returning 0x80000000 for large positive values */
+CONVERT_TARGET("sse2")
+static void to_s16_sse2( const float *in, int16_t *out, size_t n, float scale )
+{
+  const __m128 vscale = _mm_set1_ps( scale );
+  const __m128 vmin = _mm_set1_ps( -32768.0f );
+  const __m128 vmax = _mm_set1_ps( 32767.0f );
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m128 f0 = _mm_mul_ps( _mm_loadu_ps( in + i + 0 ), vscale );
+    __m128 f1 = _mm_mul_ps( _mm_loadu_ps( in + i + 4 ), vscale );
+
+    __m128i v0 = _mm_cvtps_epi32( _mm_min_ps( _mm_max_ps( f0, vmin ), vmax ) );
+    __m128i v1 = _mm_cvtps_epi32( _mm_min_ps( _mm_max_ps( f1, vmin ), vmax ) );
+
+    _mm_storeu_si128( (__m128i *)(out + i), _mm_packs_epi32( v0, v1 ) );
+  }
+
+  to_s16_generic( in + i, out + i, n - i, scale );
+}
+
+CONVERT_TARGET("sse2")
+static void to_s8_sse2( const float *in, int8_t *out, size_t n, float scale )
+{
+  const __m128 vscale = _mm_set1_ps( scale );
+  const __m128 vmin = _mm_set1_ps( -128.0f );
+  const __m128 vmax = _mm_set1_ps( 127.0f );
+  size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i v[4];
+
+    for (int j = 0; j < 4; j++) {
+      __m128 f = _mm_mul_ps( _mm_loadu_ps( in + i + j * 4 ), vscale );
+      v[j] = _mm_cvtps_epi32( _mm_min_ps( _mm_max_ps( f, vmin ), vmax ) );
+    }
+
+    __m128i lo = _mm_packs_epi32( v[0], v[1] );
+    __m128i hi = _mm_packs_epi32( v[2], v[3] );
+
+    _mm_storeu_si128( (__m128i *)(out + i), _mm_packs_epi16( lo, hi ) );
+  }
+
+  to_s8_generic( in + i, out + i, n - i, scale );
+}
+
+CONVERT_TARGET("sse2")
+static void s8x2_sse2( const int8_t *in, float *out0, float *out1,
+                       size_t nitems, float scale )
+{
+  const __m128 vscale = _mm_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 4 <= nitems; i += 4) {
+    __m128i v = _mm_loadu_si128( (const __m128i *)(in + i * 4) );
+    __m128i w[2] = { _mm_unpacklo_epi8( v, v ), _mm_unpackhi_epi8( v, v ) };
+
+    for (int j = 0; j < 2; j++) {
+      /* each byte is now replicated across a 32 bit value */
+      __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( w[j], w[j] ), 24 ) );
+      __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( w[j], w[j] ), 24 ) );
+
+      __m128d d0 = _mm_castps_pd( _mm_mul_ps( f0, vscale ) );
+      __m128d d1 = _mm_castps_pd( _mm_mul_ps( f1, vscale ) );
+
+      _mm_storeu_pd( (double *)(out0 + (i + j * 2) * 2), _mm_unpacklo_pd( d0, d1 ) );
+      _mm_storeu_pd( (double *)(out1 + (i + j * 2) * 2), _mm_unpackhi_pd( d0, d1 ) );
+    }
+  }
+
+  s8x2_generic( in + i * 4, out0 + i * 2, out1 + i * 2, nitems - i, scale );
+}
+
+/* interleaves two IQ pairs of each channel, then scales and clamps them */
+CONVERT_TARGET("sse2")
+static inline void to_x2_sse2( const float *in0, const float *in1,
+                               __m128 vscale, __m128 vmin, __m128 vmax,
+                               __m128i *v0, __m128i *v1 )
+{
+  __m128d a = _mm_loadu_pd( (const double *)in0 );
+  __m128d b = _mm_loadu_pd( (const double *)in1 );
+
+  __m128 f0 = _mm_mul_ps( _mm_castpd_ps( _mm_unpacklo_pd( a, b ) ), vscale );
+  __m128 f1 = _mm_mul_ps( _mm_castpd_ps( _mm_unpackhi_pd( a, b ) ), vscale );
+
+  *v0 = _mm_cvtps_epi32( _mm_min_ps( _mm_max_ps( f0, vmin ), vmax ) );
+  *v1 = _mm_cvtps_epi32( _mm_min_ps( _mm_max_ps( f1, vmin ), vmax ) );
+}
+
+CONVERT_TARGET("sse2")
+static void to_s16x2_sse2( const float *in0, const float *in1, int16_t *out,
+                           size_t nitems, float scale )
+{
+  const __m128 vscale = _mm_set1_ps( scale );
+  const __m128 vmin = _mm_set1_ps( -32768.0f );
+  const __m128 vmax = _mm_set1_ps( 32767.0f );
+  size_t i = 0;
+
+  for (; i + 2 <= nitems; i += 2) {
+    __m128i v0, v1;
+
+    to_x2_sse2( in0 + i * 2, in1 + i * 2, vscale, vmin, vmax, &v0, &v1 );
+    _mm_storeu_si128( (__m128i *)(out + i * 4), _mm_packs_epi32( v0, v1 ) );
+  }
+
+  to_s16x2_generic( in0 + i * 2, in1 + i * 2, out + i * 4, nitems - i, scale );
+}
+
+CONVERT_TARGET("sse2")
+static void to_s8x2_sse2( const float *in0, const float *in1, int8_t *out,
+                          size_t nitems, float scale )
+{
+  const __m128 vscale = _mm_set1_ps( scale );
+  const __m128 vmin = _mm_set1_ps( -128.0f );
+  const __m128 vmax = _mm_set1_ps( 127.0f );
+  size_t i = 0;
+
+  for (; i + 4 <= nitems; i += 4) {
+    __m128i v0, v1, v2, v3;
+
+    to_x2_sse2( in0 + i * 2 + 0, in1 + i * 2 + 0, vscale, vmin, vmax, &v0, &v1 );
+    to_x2_sse2( in0 + i * 2 + 4, in1 + i * 2 + 4, vscale, vmin, vmax, &v2, &v3 );
+
+    __m128i lo = _mm_packs_epi32( v0, v1 );
+    __m128i hi = _mm_packs_epi32( v2, v3 );
+
+    _mm_storeu_si128( (__m128i *)(out + i * 4), _mm_packs_epi16( lo, hi ) );
+  }
+
+  to_s8x2_generic( in0 + i * 2, in1 + i * 2, out + i * 4, nitems - i, scale );
+}
+
+/* loads the little endian 32 bit words at p, p + step, p + 2 * step and
+ * p + 3 * step, for the packed formats SSE2 can't shuffle */
+CONVERT_TARGET("sse2")
+static inline __m128i load_x4_sse2( const uint8_t *p, size_t step )
+{
+  int32_t w[4];
+
+  for (int j = 0; j < 4; j++)
+    memcpy( &w[j], p + j * step, sizeof(w[j]) );
+
+  return _mm_setr_epi32( w[0], w[1], w[2], w[3] );
+}
+
+CONVERT_TARGET("sse2")
+static void s24_sse2( const uint8_t *in, float *out, size_t nitems,
+                      float scale )
+{
+  const __m128 vscale = _mm_set1_ps( scale );
+  size_t i = 0;
+
+  /* every iteration reads 25 bytes but consumes only 24 (4 pairs) */
+  for (; i + 5 <= nitems; i += 4) {
+    __m128i v0 = load_x4_sse2( in + i * 6 +  0, 3 );
+    __m128i v1 = load_x4_sse2( in + i * 6 + 12, 3 );
+
+    /* drop the byte of the next value, then shift the sign back in */
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_slli_epi32( v0, 8 ), 8 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_slli_epi32( v1, 8 ), 8 ) );
+
+    _mm_storeu_ps( out + i * 2 + 0, _mm_mul_ps( f0, vscale ) );
+    _mm_storeu_ps( out + i * 2 + 4, _mm_mul_ps( f1, vscale ) );
+  }
+
+  s24_generic( in + i * 6, out + i * 2, nitems - i, scale );
+}
+
+CONVERT_TARGET("sse2")
+static void s24x2_sse2( const uint8_t *in, float *out0, float *out1,
+                        size_t nitems, float scale )
+{
+  const __m128 vscale = _mm_set1_ps( scale );
+  size_t i = 0;
+
+  /* every iteration reads 25 bytes but consumes only 24 (2 pairs per channel) */
+  for (; i + 3 <= nitems; i += 2) {
+    __m128i v0 = load_x4_sse2( in + i * 12 +  0, 3 );
+    __m128i v1 = load_x4_sse2( in + i * 12 + 12, 3 );
+
+    /* same shuffle as s16x2_sse2() */
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_slli_epi32( v0, 8 ), 8 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_slli_epi32( v1, 8 ), 8 ) );
+
+    __m128d d0 = _mm_castps_pd( _mm_mul_ps( f0, vscale ) );
+    __m128d d1 = _mm_castps_pd( _mm_mul_ps( f1, vscale ) );
+
+    _mm_storeu_pd( (double *)(out0 + i * 2), _mm_unpacklo_pd( d0, d1 ) );
+    _mm_storeu_pd( (double *)(out1 + i * 2), _mm_unpackhi_pd( d0, d1 ) );
+  }
+
+  s24x2_generic( in + i * 12, out0 + i * 2, out1 + i * 2, nitems - i, scale );
+}
+
+CONVERT_TARGET("sse2")
+static void s12p_sse2( const uint8_t *in, float *out, size_t nitems,
+                       float scale )
+{
+  const __m128 vscale = _mm_set1_ps( scale );
+  size_t i = 0;
+
+  /* every iteration reads 13 bytes but consumes only 12 (4 pairs) */
+  for (; i + 5 <= nitems; i += 4) {
+    __m128i v = load_x4_sse2( in + i * 3, 3 );
+
+    /* I sits in bits 0-11, Q in bits 12-23 of each word */
+    __m128i re = _mm_srai_epi32( _mm_slli_epi32( v, 20 ), 20 );
+    __m128i im = _mm_srai_epi32( _mm_slli_epi32( v, 8 ), 20 );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_unpacklo_epi32( re, im ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_unpackhi_epi32( re, im ) );
+
+    _mm_storeu_ps( out + i * 2 + 0, _mm_mul_ps( f0, vscale ) );
+    _mm_storeu_ps( out + i * 2 + 4, _mm_mul_ps( f1, vscale ) );
+  }
+
+  s12p_generic( in + i * 3, out + i * 2, nitems - i, scale );
+}
+
+/*
+ * AVX2
+ */
+
+CONVERT_TARGET("avx2")
+static void u8_avx2( const uint8_t *in, float *out, size_t n,
+                     float offset, float scale )
+{
+  const __m256 voffset = _mm256_set1_ps( offset );
+  const __m256 vscale = _mm256_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i v0 = _mm_loadl_epi64( (const __m128i *)(in + i + 0) );
+    __m128i v1 = _mm_loadl_epi64( (const __m128i *)(in + i + 8) );
+
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( v0 ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( v1 ) );
+
+    _mm256_storeu_ps( out + i + 0, _mm256_mul_ps( _mm256_sub_ps( f0, voffset ), vscale ) );
+    _mm256_storeu_ps( out + i + 8, _mm256_mul_ps( _mm256_sub_ps( f1, voffset ), vscale ) );
+  }
+
+  u8_generic( in + i, out + i, n - i, offset, scale );
+}
+
+CONVERT_TARGET("avx2")
+static void s8_avx2( const int8_t *in, float *out, size_t n, float scale )
+{
+  const __m256 vscale = _mm256_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i v0 = _mm_loadl_epi64( (const __m128i *)(in + i + 0) );
+    __m128i v1 = _mm_loadl_epi64( (const __m128i *)(in + i + 8) );
+
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( v0 ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( v1 ) );
+
+    _mm256_storeu_ps( out + i + 0, _mm256_mul_ps( f0, vscale ) );
+    _mm256_storeu_ps( out + i + 8, _mm256_mul_ps( f1, vscale ) );
+  }
+
+  s8_generic( in + i, out + i, n - i, scale );
+}
+
+CONVERT_TARGET("avx2")
+static void s16_avx2( const int16_t *in, float *out, size_t n, float scale )
+{
+  const __m256 vscale = _mm256_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i v0 = _mm_loadu_si128( (const __m128i *)(in + i + 0) );
+    __m128i v1 = _mm_loadu_si128( (const __m128i *)(in + i + 8) );
+
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( v0 ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( v1 ) );
+
+    _mm256_storeu_ps( out + i + 0, _mm256_mul_ps( f0, vscale ) );
+    _mm256_storeu_ps( out + i + 8, _mm256_mul_ps( f1, vscale ) );
+  }
+
+  s16_generic( in + i, out + i, n - i, scale );
+}
+
+CONVERT_TARGET("avx2")
+static void s16x2_avx2( const int16_t *in, float *out0, float *out1,
+                        size_t nitems, float scale )
+{
+  const __m256 vscale = _mm256_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 4 <= nitems; i += 4) {
+    __m128i v0 = _mm_loadu_si128( (const __m128i *)(in + i * 4 + 0) );
+    __m128i v1 = _mm_loadu_si128( (const __m128i *)(in + i * 4 + 8) );
+
+    /* f0 = a0 b0 a1 b1, f1 = a2 b2 a3 b3 when viewed as complex pairs */
+    __m256 f0 = _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( v0 ) ), vscale );
+    __m256 f1 = _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( v1 ) ), vscale );
+
+    /* a0 a2 a1 a3 and b0 b2 b1 b3, then restore the order across lanes */
+    __m256d a = _mm256_unpacklo_pd( _mm256_castps_pd( f0 ), _mm256_castps_pd( f1 ) );
+    __m256d b = _mm256_unpackhi_pd( _mm256_castps_pd( f0 ), _mm256_castps_pd( f1 ) );
+
+    _mm256_storeu_pd( (double *)(out0 + i * 2), _mm256_permute4x64_pd( a, 0xd8 ) );
+    _mm256_storeu_pd( (double *)(out1 + i * 2), _mm256_permute4x64_pd( b, 0xd8 ) );
+  }
+
+  s16x2_generic( in + i * 4, out0 + i * 2, out1 + i * 2, nitems - i, scale );
+}
+
+/* loads 8 packed 24 bit values, reading 28 bytes */
+CONVERT_TARGET("avx2")
+static inline __m256 s24_load_avx2( const uint8_t *p )
+{
+  /* per 128 bit lane, move the 3 bytes of each value into the upper bytes
+   * of a 32 bit word, then shift the sign back in */
+  const __m256i shuffle = _mm256_setr_epi8(
+        -1, 0, 1, 2,  -1, 3, 4, 5,  -1, 6, 7, 8,  -1, 9, 10, 11,
+        -1, 0, 1, 2,  -1, 3, 4, 5,  -1, 6, 7, 8,  -1, 9, 10, 11 );
+
+  __m256i v = _mm256_inserti128_si256(
+                _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i *)(p + 0) ) ),
+                _mm_loadu_si128( (const __m128i *)(p + 12) ), 1 );
+
+  return _mm256_cvtepi32_ps( _mm256_srai_epi32( _mm256_shuffle_epi8( v, shuffle ), 8 ) );
+}
+
+CONVERT_TARGET("avx2")
+static void s24_avx2( const uint8_t *in, float *out, size_t nitems,
+                      float scale )
+{
+  const __m256 vscale = _mm256_set1_ps( scale );
+  size_t i = 0;
+
+  /* every iteration reads 28 bytes but consumes only 24 (4 pairs) */
+  for (; i + 5 <= nitems; i += 4)
+    _mm256_storeu_ps( out + i * 2, _mm256_mul_ps( s24_load_avx2( in + i * 6 ), vscale ) );
+
+  s24_generic( in + i * 6, out + i * 2, nitems - i, scale );
+}
+
+CONVERT_TARGET("avx2")
+static void s24x2_avx2( const uint8_t *in, float *out0, float *out1,
+                        size_t nitems, float scale )
+{
+  const __m256 vscale = _mm256_set1_ps( scale );
+  size_t i = 0;
+
+  /* every iteration reads 52 bytes but consumes only 48 (4 pairs per channel) */
+  for (; i + 5 <= nitems; i += 4) {
+    __m256 f0 = _mm256_mul_ps( s24_load_avx2( in + i * 12 +  0 ), vscale );
+    __m256 f1 = _mm256_mul_ps( s24_load_avx2( in + i * 12 + 24 ), vscale );
+
+    /* same shuffle as s16x2_avx2() */
+    __m256d a = _mm256_unpacklo_pd( _mm256_castps_pd( f0 ), _mm256_castps_pd( f1 ) );
+    __m256d b = _mm256_unpackhi_pd( _mm256_castps_pd( f0 ), _mm256_castps_pd( f1 ) );
+
+    _mm256_storeu_pd( (double *)(out0 + i * 2), _mm256_permute4x64_pd( a, 0xd8 ) );
+    _mm256_storeu_pd( (double *)(out1 + i * 2), _mm256_permute4x64_pd( b, 0xd8 ) );
+  }
+
+  s24x2_generic( in + i * 12, out0 + i * 2, out1 + i * 2, nitems - i, scale );
+}
+
+CONVERT_TARGET("avx2")
+static void s12p_avx2( const uint8_t *in, float *out, size_t nitems,
+                       float scale )
+{
+  /* per 128 bit lane, gather bytes [b0 b1] and [b1 b2] of 4 packed pairs
+   * into 16 bit words: even words hold I, odd words hold Q */
+  const __m256i shuffle = _mm256_setr_epi8(
+        0, 1, 1, 2,  3, 4, 4, 5,  6, 7, 7, 8,  9, 10, 10, 11,
+        0, 1, 1, 2,  3, 4, 4, 5,  6, 7, 7, 8,  9, 10, 10, 11 );
+  const __m256 vscale = _mm256_set1_ps( scale );
+  size_t i = 0;
+
+  /* every iteration reads 28 bytes but consumes only 24 (8 pairs) */
+  for (; i + 10 <= nitems; i += 8) {
+    const uint8_t *p = in + i * 3;
+
+    __m256i v = _mm256_inserti128_si256(
+                  _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i *)(p + 0) ) ),
+                  _mm_loadu_si128( (const __m128i *)(p + 12) ), 1 );
+    v = _mm256_shuffle_epi8( v, shuffle );
+
+    /* I sits in the low 12 bits, Q in the high 12 bits of each word */
+    __m256i re = _mm256_srai_epi16( _mm256_slli_epi16( v, 4 ), 4 );
+    __m256i im = _mm256_srai_epi16( v, 4 );
+    v = _mm256_blend_epi16( re, im, 0xAA );
+
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( _mm256_castsi256_si128( v ) ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( _mm256_extracti128_si256( v, 1 ) ) );
+
+    _mm256_storeu_ps( out + i * 2 + 0, _mm256_mul_ps( f0, vscale ) );
+    _mm256_storeu_ps( out + i * 2 + 8, _mm256_mul_ps( f1, vscale ) );
+  }
+
+  s12p_generic( in + i * 3, out + i * 2, nitems - i, scale );
+}
+
+CONVERT_TARGET("avx2")
+static void to_s16_avx2( const float *in, int16_t *out, size_t n, float scale )
+{
+  const __m256 vscale = _mm256_set1_ps( scale );
+  const __m256 vmin = _mm256_set1_ps( -32768.0f );
+  const __m256 vmax = _mm256_set1_ps( 32767.0f );
+  size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m256 f0 = _mm256_mul_ps( _mm256_loadu_ps( in + i + 0 ), vscale );
+    __m256 f1 = _mm256_mul_ps( _mm256_loadu_ps( in + i + 8 ), vscale );
+
+    __m256i v0 = _mm256_cvtps_epi32( _mm256_min_ps( _mm256_max_ps( f0, vmin ), vmax ) );
+    __m256i v1 = _mm256_cvtps_epi32( _mm256_min_ps( _mm256_max_ps( f1, vmin ), vmax ) );
+
+    /* packs works per 128 bit lane, put the quarters back in order */
+    __m256i v = _mm256_permute4x64_epi64( _mm256_packs_epi32( v0, v1 ), 0xd8 );
+
+    _mm256_storeu_si256( (__m256i *)(out + i), v );
+  }
+
+  to_s16_generic( in + i, out + i, n - i, scale );
+}
+
+CONVERT_TARGET("avx2")
+static void to_s8_avx2( const float *in, int8_t *out, size_t n, float scale )
+{
+  const __m256 vscale = _mm256_set1_ps( scale );
+  const __m256 vmin = _mm256_set1_ps( -128.0f );
+  const __m256 vmax = _mm256_set1_ps( 127.0f );
+  const __m256i order = _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 );
+  size_t i = 0;
+
+  for (; i + 32 <= n; i += 32) {
+    __m256i v[4];
+
+    for (int j = 0; j < 4; j++) {
+      __m256 f = _mm256_mul_ps( _mm256_loadu_ps( in + i + j * 8 ), vscale );
+      v[j] = _mm256_cvtps_epi32( _mm256_min_ps( _mm256_max_ps( f, vmin ), vmax ) );
+    }
+
+    __m256i lo = _mm256_packs_epi32( v[0], v[1] );
+    __m256i hi = _mm256_packs_epi32( v[2], v[3] );
+    __m256i b = _mm256_permutevar8x32_epi32( _mm256_packs_epi16( lo, hi ), order );
+
+    _mm256_storeu_si256( (__m256i *)(out + i), b );
+  }
+
+  to_s8_generic( in + i, out + i, n - i, scale );
+}
+
+CONVERT_TARGET("avx2")
+static void s8x2_avx2( const int8_t *in, float *out0, float *out1,
+                       size_t nitems, float scale )
+{
+  const __m256 vscale = _mm256_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 4 <= nitems; i += 4) {
+    __m128i v0 = _mm_loadl_epi64( (const __m128i *)(in + i * 4 + 0) );
+    __m128i v1 = _mm_loadl_epi64( (const __m128i *)(in + i * 4 + 8) );
+
+    /* same shuffle as s16x2_avx2() */
+    __m256 f0 = _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( v0 ) ), vscale );
+    __m256 f1 = _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( v1 ) ), vscale );
+
+    __m256d a = _mm256_unpacklo_pd( _mm256_castps_pd( f0 ), _mm256_castps_pd( f1 ) );
+    __m256d b = _mm256_unpackhi_pd( _mm256_castps_pd( f0 ), _mm256_castps_pd( f1 ) );
+
+    _mm256_storeu_pd( (double *)(out0 + i * 2), _mm256_permute4x64_pd( a, 0xd8 ) );
+    _mm256_storeu_pd( (double *)(out1 + i * 2), _mm256_permute4x64_pd( b, 0xd8 ) );
+  }
+
+  s8x2_generic( in + i * 4, out0 + i * 2, out1 + i * 2, nitems - i, scale );
+}
+
+/* interleaves four IQ pairs of each channel, then scales and clamps them */
+CONVERT_TARGET("avx2")
+static inline void to_x2_avx2( const float *in0, const float *in1,
+                               __m256 vscale, __m256 vmin, __m256 vmax,
+                               __m256i *v0, __m256i *v1 )
+{
+  __m256d a = _mm256_loadu_pd( (const double *)in0 );
+  __m256d b = _mm256_loadu_pd( (const double *)in1 );
+
+  /* a0 b0 a2 b2 and a1 b1 a3 b3, then restore the order across lanes */
+  __m256d lo = _mm256_unpacklo_pd( a, b );
+  __m256d hi = _mm256_unpackhi_pd( a, b );
+
+  __m256 f0 = _mm256_mul_ps( _mm256_castpd_ps( _mm256_permute2f128_pd( lo, hi, 0x20 ) ), vscale );
+  __m256 f1 = _mm256_mul_ps( _mm256_castpd_ps( _mm256_permute2f128_pd( lo, hi, 0x31 ) ), vscale );
+
+  *v0 = _mm256_cvtps_epi32( _mm256_min_ps( _mm256_max_ps( f0, vmin ), vmax ) );
+  *v1 = _mm256_cvtps_epi32( _mm256_min_ps( _mm256_max_ps( f1, vmin ), vmax ) );
+}
+
+CONVERT_TARGET("avx2")
+static void to_s16x2_avx2( const float *in0, const float *in1, int16_t *out,
+                           size_t nitems, float scale )
+{
+  const __m256 vscale = _mm256_set1_ps( scale );
+  const __m256 vmin = _mm256_set1_ps( -32768.0f );
+  const __m256 vmax = _mm256_set1_ps( 32767.0f );
+  size_t i = 0;
+
+  for (; i + 4 <= nitems; i += 4) {
+    __m256i v0, v1;
+
+    to_x2_avx2( in0 + i * 2, in1 + i * 2, vscale, vmin, vmax, &v0, &v1 );
+
+    __m256i v = _mm256_permute4x64_epi64( _mm256_packs_epi32( v0, v1 ), 0xd8 );
+    _mm256_storeu_si256( (__m256i *)(out + i * 4), v );
+  }
+
+  to_s16x2_generic( in0 + i * 2, in1 + i * 2, out + i * 4, nitems - i, scale );
+}
+
+CONVERT_TARGET("avx2")
+static void to_s8x2_avx2( const float *in0, const float *in1, int8_t *out,
+                          size_t nitems, float scale )
+{
+  const __m256 vscale = _mm256_set1_ps( scale );
+  const __m256 vmin = _mm256_set1_ps( -128.0f );
+  const __m256 vmax = _mm256_set1_ps( 127.0f );
+  const __m256i order = _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 );
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    __m256i v0, v1, v2, v3;
+
+    to_x2_avx2( in0 + i * 2 + 0, in1 + i * 2 + 0, vscale, vmin, vmax, &v0, &v1 );
+    to_x2_avx2( in0 + i * 2 + 8, in1 + i * 2 + 8, vscale, vmin, vmax, &v2, &v3 );
+
+    __m256i lo = _mm256_packs_epi32( v0, v1 );
+    __m256i hi = _mm256_packs_epi32( v2, v3 );
+    __m256i b = _mm256_permutevar8x32_epi32( _mm256_packs_epi16( lo, hi ), order );
+
+    _mm256_storeu_si256( (__m256i *)(out + i * 4), b );
+  }
+
+  to_s8x2_generic( in0 + i * 2, in1 + i * 2, out + i * 4, nitems - i, scale );
+}
+
+/*
+ * AVX-512
+ */
+
+#if defined(__GNUC__) && !defined(__clang__)
+/* some GCC releases warn about _mm512_undefined_*() in their own headers */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+CONVERT_TARGET("avx512f")
+static void u8_avx512( const uint8_t *in, float *out, size_t n,
+                       float offset, float scale )
+{
+  const __m512 voffset = _mm512_set1_ps( offset );
+  const __m512 vscale = _mm512_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 32 <= n; i += 32) {
+    __m128i v0 = _mm_loadu_si128( (const __m128i *)(in + i +  0) );
+    __m128i v1 = _mm_loadu_si128( (const __m128i *)(in + i + 16) );
+
+    __m512 f0 = _mm512_cvtepi32_ps( _mm512_cvtepu8_epi32( v0 ) );
+    __m512 f1 = _mm512_cvtepi32_ps( _mm512_cvtepu8_epi32( v1 ) );
+
+    _mm512_storeu_ps( out + i +  0, _mm512_mul_ps( _mm512_sub_ps( f0, voffset ), vscale ) );
+    _mm512_storeu_ps( out + i + 16, _mm512_mul_ps( _mm512_sub_ps( f1, voffset ), vscale ) );
+  }
+
+  u8_generic( in + i, out + i, n - i, offset, scale );
+}
+
+CONVERT_TARGET("avx512f")
+static void s8_avx512( const int8_t *in, float *out, size_t n, float scale )
+{
+  const __m512 vscale = _mm512_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 32 <= n; i += 32) {
+    __m128i v0 = _mm_loadu_si128( (const __m128i *)(in + i +  0) );
+    __m128i v1 = _mm_loadu_si128( (const __m128i *)(in + i + 16) );
+
+    __m512 f0 = _mm512_cvtepi32_ps( _mm512_cvtepi8_epi32( v0 ) );
+    __m512 f1 = _mm512_cvtepi32_ps( _mm512_cvtepi8_epi32( v1 ) );
+
+    _mm512_storeu_ps( out + i +  0, _mm512_mul_ps( f0, vscale ) );
+    _mm512_storeu_ps( out + i + 16, _mm512_mul_ps( f1, vscale ) );
+  }
+
+  s8_generic( in + i, out + i, n - i, scale );
+}
+
+CONVERT_TARGET("avx512f")
+static void s16_avx512( const int16_t *in, float *out, size_t n, float scale )
+{
+  const __m512 vscale = _mm512_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 32 <= n; i += 32) {
+    __m256i v0 = _mm256_loadu_si256( (const __m256i *)(in + i +  0) );
+    __m256i v1 = _mm256_loadu_si256( (const __m256i *)(in + i + 16) );
+
+    __m512 f0 = _mm512_cvtepi32_ps( _mm512_cvtepi16_epi32( v0 ) );
+    __m512 f1 = _mm512_cvtepi32_ps( _mm512_cvtepi16_epi32( v1 ) );
+
+    _mm512_storeu_ps( out + i +  0, _mm512_mul_ps( f0, vscale ) );
+    _mm512_storeu_ps( out + i + 16, _mm512_mul_ps( f1, vscale ) );
+  }
+
+  s16_generic( in + i, out + i, n - i, scale );
+}
+
+/* vpmovsdw/vpmovsdb narrow in order, no lane fix-up as with AVX2 packs */
+CONVERT_TARGET("avx512f")
+static void to_s16_avx512( const float *in, int16_t *out, size_t n, float scale )
+{
+  const __m512 vscale = _mm512_set1_ps( scale );
+  const __m512 vmin = _mm512_set1_ps( -32768.0f );
+  const __m512 vmax = _mm512_set1_ps( 32767.0f );
+  size_t i = 0;
+
+  for (; i + 32 <= n; i += 32) {
+    __m512 f0 = _mm512_mul_ps( _mm512_loadu_ps( in + i +  0 ), vscale );
+    __m512 f1 = _mm512_mul_ps( _mm512_loadu_ps( in + i + 16 ), vscale );
+
+    __m512i v0 = _mm512_cvtps_epi32( _mm512_min_ps( _mm512_max_ps( f0, vmin ), vmax ) );
+    __m512i v1 = _mm512_cvtps_epi32( _mm512_min_ps( _mm512_max_ps( f1, vmin ), vmax ) );
+
+    _mm256_storeu_si256( (__m256i *)(out + i +  0), _mm512_cvtsepi32_epi16( v0 ) );
+    _mm256_storeu_si256( (__m256i *)(out + i + 16), _mm512_cvtsepi32_epi16( v1 ) );
+  }
+
+  to_s16_generic( in + i, out + i, n - i, scale );
+}
+
+CONVERT_TARGET("avx512f")
+static void to_s8_avx512( const float *in, int8_t *out, size_t n, float scale )
+{
+  const __m512 vscale = _mm512_set1_ps( scale );
+  const __m512 vmin = _mm512_set1_ps( -128.0f );
+  const __m512 vmax = _mm512_set1_ps( 127.0f );
+  size_t i = 0;
+
+  for (; i + 64 <= n; i += 64) {
+    for (int j = 0; j < 4; j++) {
+      __m512 f = _mm512_mul_ps( _mm512_loadu_ps( in + i + j * 16 ), vscale );
+      __m512i v = _mm512_cvtps_epi32( _mm512_min_ps( _mm512_max_ps( f, vmin ), vmax ) );
+
+      _mm_storeu_si128( (__m128i *)(out + i + j * 16), _mm512_cvtsepi32_epi8( v ) );
+    }
+  }
+
+  to_s8_generic( in + i, out + i, n - i, scale );
+}
+
+/* the IQ pairs of channel 0 and 1 in two vectors of four pairs of both */
+static const int x2_split_avx512[16] = {
+  0, 1, 4, 5, 8, 9, 12, 13, 16, 17, 20, 21, 24, 25, 28, 29 };
+
+/* separates f0 and f1 holding 4 pairs of both channels each, like s16x2 */
+CONVERT_TARGET("avx512f")
+static inline void x2_store_avx512( __m512 f0, __m512 f1,
+                                    float *out0, float *out1 )
+{
+  const __m512i idx = _mm512_loadu_si512( x2_split_avx512 );
+  const __m512i two = _mm512_set1_epi32( 2 );
+
+  _mm512_storeu_ps( out0, _mm512_permutex2var_ps( f0, idx, f1 ) );
+  _mm512_storeu_ps( out1, _mm512_permutex2var_ps( f0, _mm512_add_epi32( idx, two ), f1 ) );
+}
+
+CONVERT_TARGET("avx512f")
+static void s16x2_avx512( const int16_t *in, float *out0, float *out1,
+                          size_t nitems, float scale )
+{
+  const __m512 vscale = _mm512_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    __m256i v0 = _mm256_loadu_si256( (const __m256i *)(in + i * 4 +  0) );
+    __m256i v1 = _mm256_loadu_si256( (const __m256i *)(in + i * 4 + 16) );
+
+    __m512 f0 = _mm512_mul_ps( _mm512_cvtepi32_ps( _mm512_cvtepi16_epi32( v0 ) ), vscale );
+    __m512 f1 = _mm512_mul_ps( _mm512_cvtepi32_ps( _mm512_cvtepi16_epi32( v1 ) ), vscale );
+
+    x2_store_avx512( f0, f1, out0 + i * 2, out1 + i * 2 );
+  }
+
+  s16x2_generic( in + i * 4, out0 + i * 2, out1 + i * 2, nitems - i, scale );
+}
+
+CONVERT_TARGET("avx512f")
+static void s8x2_avx512( const int8_t *in, float *out0, float *out1,
+                         size_t nitems, float scale )
+{
+  const __m512 vscale = _mm512_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    __m128i v0 = _mm_loadu_si128( (const __m128i *)(in + i * 4 +  0) );
+    __m128i v1 = _mm_loadu_si128( (const __m128i *)(in + i * 4 + 16) );
+
+    __m512 f0 = _mm512_mul_ps( _mm512_cvtepi32_ps( _mm512_cvtepi8_epi32( v0 ) ), vscale );
+    __m512 f1 = _mm512_mul_ps( _mm512_cvtepi32_ps( _mm512_cvtepi8_epi32( v1 ) ), vscale );
+
+    x2_store_avx512( f0, f1, out0 + i * 2, out1 + i * 2 );
+  }
+
+  s8x2_generic( in + i * 4, out0 + i * 2, out1 + i * 2, nitems - i, scale );
+}
+
+/*
+ * AVX-512F has no byte shuffle, the 24 bit words at 3 byte steps are put
+ * together from the two 32 bit words they straddle with variable shifts.
+ */
+static const int s24_word_avx512[16] = {
+  0, 0, 1, 2, 3, 3, 4, 5, 6, 6, 7, 8, 9, 9, 10, 11 };
+static const int s24_shift_avx512[16] = {
+  0, 24, 16, 8, 0, 24, 16, 8, 0, 24, 16, 8, 0, 24, 16, 8 };
+
+/* loads 16 packed 24 bit words, reading exactly 48 bytes */
+CONVERT_TARGET("avx512f")
+static inline __m512i s24_load_avx512( const uint8_t *p )
+{
+  const __m512i word = _mm512_loadu_si512( s24_word_avx512 );
+  const __m512i shift = _mm512_loadu_si512( s24_shift_avx512 );
+  const __m512i one = _mm512_set1_epi32( 1 );
+  const __m512i bits = _mm512_set1_epi32( 32 );
+
+  __m512i v = _mm512_maskz_loadu_epi32( 0x0fff, p );
+
+  __m512i lo = _mm512_permutexvar_epi32( word, v );
+  __m512i hi = _mm512_permutexvar_epi32( _mm512_add_epi32( word, one ), v );
+
+  /* shifts by 32 yield 0, as needed for the words that don't straddle */
+  return _mm512_or_si512( _mm512_srlv_epi32( lo, shift ),
+                          _mm512_sllv_epi32( hi, _mm512_sub_epi32( bits, shift ) ) );
+}
+
+CONVERT_TARGET("avx512f")
+static void s24_avx512( const uint8_t *in, float *out, size_t nitems,
+                        float scale )
+{
+  const __m512 vscale = _mm512_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    __m512i v = s24_load_avx512( in + i * 6 );
+
+    /* drop the byte of the next value, then shift the sign back in */
+    v = _mm512_srai_epi32( _mm512_slli_epi32( v, 8 ), 8 );
+
+    _mm512_storeu_ps( out + i * 2, _mm512_mul_ps( _mm512_cvtepi32_ps( v ), vscale ) );
+  }
+
+  s24_generic( in + i * 6, out + i * 2, nitems - i, scale );
+}
+
+CONVERT_TARGET("avx512f")
+static void s24x2_avx512( const uint8_t *in, float *out0, float *out1,
+                          size_t nitems, float scale )
+{
+  const __m512 vscale = _mm512_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    __m512i v0 = s24_load_avx512( in + i * 12 +  0 );
+    __m512i v1 = s24_load_avx512( in + i * 12 + 48 );
+
+    v0 = _mm512_srai_epi32( _mm512_slli_epi32( v0, 8 ), 8 );
+    v1 = _mm512_srai_epi32( _mm512_slli_epi32( v1, 8 ), 8 );
+
+    x2_store_avx512( _mm512_mul_ps( _mm512_cvtepi32_ps( v0 ), vscale ),
+                     _mm512_mul_ps( _mm512_cvtepi32_ps( v1 ), vscale ),
+                     out0 + i * 2, out1 + i * 2 );
+  }
+
+  s24x2_generic( in + i * 12, out0 + i * 2, out1 + i * 2, nitems - i, scale );
+}
+
+/* pairs I and Q of 16 pairs held in two separate vectors */
+static const int iq_lo_avx512[16] = {
+  0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23 };
+static const int iq_hi_avx512[16] = {
+  8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31 };
+
+CONVERT_TARGET("avx512f")
+static void s12p_avx512( const uint8_t *in, float *out, size_t nitems,
+                         float scale )
+{
+  const __m512i lo = _mm512_loadu_si512( iq_lo_avx512 );
+  const __m512i hi = _mm512_loadu_si512( iq_hi_avx512 );
+  const __m512 vscale = _mm512_set1_ps( scale );
+  size_t i = 0;
+
+  for (; i + 16 <= nitems; i += 16) {
+    /* every pair is a 24 bit word, I in bits 0-11, Q in bits 12-23 */
+    __m512i v = s24_load_avx512( in + i * 3 );
+
+    __m512 re = _mm512_cvtepi32_ps( _mm512_srai_epi32( _mm512_slli_epi32( v, 20 ), 20 ) );
+    __m512 im = _mm512_cvtepi32_ps( _mm512_srai_epi32( _mm512_slli_epi32( v, 8 ), 20 ) );
+
+    _mm512_storeu_ps( out + i * 2 +  0, _mm512_mul_ps( _mm512_permutex2var_ps( re, lo, im ), vscale ) );
+    _mm512_storeu_ps( out + i * 2 + 16, _mm512_mul_ps( _mm512_permutex2var_ps( re, hi, im ), vscale ) );
+  }
+
+  s12p_generic( in + i * 3, out + i * 2, nitems - i, scale );
+}
+
+/* the pairs of in0 and in1 interleaved as channel 0, 1, 0, 1 ... */
+static const int x2_merge_lo_avx512[16] = {
+  0, 1, 16, 17, 2, 3, 18, 19, 4, 5, 20, 21, 6, 7, 22, 23 };
+static const int x2_merge_hi_avx512[16] = {
+  8, 9, 24, 25, 10, 11, 26, 27, 12, 13, 28, 29, 14, 15, 30, 31 };
+
+/* interleaves eight IQ pairs of each channel, then scales and clamps them */
+CONVERT_TARGET("avx512f")
+static inline void to_x2_avx512( const float *in0, const float *in1,
+                                 __m512 vscale, __m512 vmin, __m512 vmax,
+                                 __m512i *v0, __m512i *v1 )
+{
+  const __m512i lo = _mm512_loadu_si512( x2_merge_lo_avx512 );
+  const __m512i hi = _mm512_loadu_si512( x2_merge_hi_avx512 );
+
+  __m512 a = _mm512_loadu_ps( in0 );
+  __m512 b = _mm512_loadu_ps( in1 );
+
+  __m512 f0 = _mm512_mul_ps( _mm512_permutex2var_ps( a, lo, b ), vscale );
+  __m512 f1 = _mm512_mul_ps( _mm512_permutex2var_ps( a, hi, b ), vscale );
+
+  *v0 = _mm512_cvtps_epi32( _mm512_min_ps( _mm512_max_ps( f0, vmin ), vmax ) );
+  *v1 = _mm512_cvtps_epi32( _mm512_min_ps( _mm512_max_ps( f1, vmin ), vmax ) );
+}
+
+CONVERT_TARGET("avx512f")
+static void to_s16x2_avx512( const float *in0, const float *in1, int16_t *out,
+                             size_t nitems, float scale )
+{
+  const __m512 vscale = _mm512_set1_ps( scale );
+  const __m512 vmin = _mm512_set1_ps( -32768.0f );
+  const __m512 vmax = _mm512_set1_ps( 32767.0f );
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    __m512i v0, v1;
+
+    to_x2_avx512( in0 + i * 2, in1 + i * 2, vscale, vmin, vmax, &v0, &v1 );
+
+    _mm256_storeu_si256( (__m256i *)(out + i * 4 +  0), _mm512_cvtsepi32_epi16( v0 ) );
+    _mm256_storeu_si256( (__m256i *)(out + i * 4 + 16), _mm512_cvtsepi32_epi16( v1 ) );
+  }
+
+  to_s16x2_generic( in0 + i * 2, in1 + i * 2, out + i * 4, nitems - i, scale );
+}
+
+CONVERT_TARGET("avx512f")
+static void to_s8x2_avx512( const float *in0, const float *in1, int8_t *out,
+                            size_t nitems, float scale )
+{
+  const __m512 vscale = _mm512_set1_ps( scale );
+  const __m512 vmin = _mm512_set1_ps( -128.0f );
+  const __m512 vmax = _mm512_set1_ps( 127.0f );
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    __m512i v0, v1;
+
+    to_x2_avx512( in0 + i * 2, in1 + i * 2, vscale, vmin, vmax, &v0, &v1 );
+
+    _mm_storeu_si128( (__m128i *)(out + i * 4 +  0), _mm512_cvtsepi32_epi8( v0 ) );
+    _mm_storeu_si128( (__m128i *)(out + i * 4 + 16), _mm512_cvtsepi32_epi8( v1 ) );
+  }
+
+  to_s8x2_generic( in0 + i * 2, in1 + i * 2, out + i * 4, nitems - i, scale );
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#if defined(_MSC_VER)
+static bool x86_has( int leaf, int reg, int bit )
+{
+  int regs[4];
+
+  __cpuid( regs, 0 );
+  if ( regs[0] < leaf )
+    return false;
+
+  __cpuidex( regs, leaf, 0 );
+  return (regs[reg] >> bit) & 1;
+}
+
+static bool os_saves( unsigned long long mask )
+{
+  /* OSXSAVE has to be set before xgetbv may be executed */
+  if ( ! x86_has( 1, 2, 27 ) )
+    return false;
+
+  return (_xgetbv( 0 ) & mask) == mask;
+}
+
+static bool cpu_has_sse2()    { return x86_has( 1, 3, 26 ); }
+static bool cpu_has_avx2()    { return x86_has( 7, 1, 5 ) && os_saves( 0x06 ); }
+static bool cpu_has_avx512f() { return x86_has( 7, 1, 16 ) && os_saves( 0xe6 ); }
+#else
+/* libgcc/compiler-rt also check that the OS saves the extended state */
+static bool cpu_has_sse2()    { __builtin_cpu_init(); return __builtin_cpu_supports( "sse2" ); }
+static bool cpu_has_avx2()    { __builtin_cpu_init(); return __builtin_cpu_supports( "avx2" ); }
+static bool cpu_has_avx512f() { __builtin_cpu_init(); return __builtin_cpu_supports( "avx512f" ); }
+#endif
+
+#endif /* CONVERT_X86 */
+
+#ifdef CONVERT_NEON
+
+/*
+ * NEON, always present on aarch64 and on armhf builds with -mfpu=neon
+ */
+
+static void u8_neon( const uint8_t *in, float *out, size_t n,
+                     float offset, float scale )
+{
+  const float32x4_t voffset = vdupq_n_f32( offset );
+  const float32x4_t vscale = vdupq_n_f32( scale );
+  size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t v = vld1q_u8( in + i );
+    uint16x8_t lo = vmovl_u8( vget_low_u8( v ) );
+    uint16x8_t hi = vmovl_u8( vget_high_u8( v ) );
+
+    float32x4_t f0 = vcvtq_f32_u32( vmovl_u16( vget_low_u16( lo ) ) );
+    float32x4_t f1 = vcvtq_f32_u32( vmovl_u16( vget_high_u16( lo ) ) );
+    float32x4_t f2 = vcvtq_f32_u32( vmovl_u16( vget_low_u16( hi ) ) );
+    float32x4_t f3 = vcvtq_f32_u32( vmovl_u16( vget_high_u16( hi ) ) );
+
+    vst1q_f32( out + i +  0, vmulq_f32( vsubq_f32( f0, voffset ), vscale ) );
+    vst1q_f32( out + i +  4, vmulq_f32( vsubq_f32( f1, voffset ), vscale ) );
+    vst1q_f32( out + i +  8, vmulq_f32( vsubq_f32( f2, voffset ), vscale ) );
+    vst1q_f32( out + i + 12, vmulq_f32( vsubq_f32( f3, voffset ), vscale ) );
+  }
+
+  u8_generic( in + i, out + i, n - i, offset, scale );
+}
+
+static void s8_neon( const int8_t *in, float *out, size_t n, float scale )
+{
+  const float32x4_t vscale = vdupq_n_f32( scale );
+  size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    int8x16_t v = vld1q_s8( in + i );
+    int16x8_t lo = vmovl_s8( vget_low_s8( v ) );
+    int16x8_t hi = vmovl_s8( vget_high_s8( v ) );
+
+    float32x4_t f0 = vcvtq_f32_s32( vmovl_s16( vget_low_s16( lo ) ) );
+    float32x4_t f1 = vcvtq_f32_s32( vmovl_s16( vget_high_s16( lo ) ) );
+    float32x4_t f2 = vcvtq_f32_s32( vmovl_s16( vget_low_s16( hi ) ) );
+    float32x4_t f3 = vcvtq_f32_s32( vmovl_s16( vget_high_s16( hi ) ) );
+
+    vst1q_f32( out + i +  0, vmulq_f32( f0, vscale ) );
+    vst1q_f32( out + i +  4, vmulq_f32( f1, vscale ) );
+    vst1q_f32( out + i +  8, vmulq_f32( f2, vscale ) );
+    vst1q_f32( out + i + 12, vmulq_f32( f3, vscale ) );
+  }
+
+  s8_generic( in + i, out + i, n - i, scale );
+}
+
+static void s16_neon( const int16_t *in, float *out, size_t n, float scale )
+{
+  const float32x4_t vscale = vdupq_n_f32( scale );
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t v = vld1q_s16( in + i );
+
+    float32x4_t f0 = vcvtq_f32_s32( vmovl_s16( vget_low_s16( v ) ) );
+    float32x4_t f1 = vcvtq_f32_s32( vmovl_s16( vget_high_s16( v ) ) );
+
+    vst1q_f32( out + i + 0, vmulq_f32( f0, vscale ) );
+    vst1q_f32( out + i + 4, vmulq_f32( f1, vscale ) );
+  }
+
+  s16_generic( in + i, out + i, n - i, scale );
+}
+
+static void s16x2_neon( const int16_t *in, float *out0, float *out1,
+                        size_t nitems, float scale )
+{
+  const float32x4_t vscale = vdupq_n_f32( scale );
+  size_t i = 0;
+
+  for (; i + 4 <= nitems; i += 4) {
+    /* splits I and Q of both channels into separate vectors */
+    int16x4x4_t v = vld4_s16( in + i * 4 );
+    float32x4x2_t a, b;
+
+    a.val[0] = vmulq_f32( vcvtq_f32_s32( vmovl_s16( v.val[0] ) ), vscale );
+    a.val[1] = vmulq_f32( vcvtq_f32_s32( vmovl_s16( v.val[1] ) ), vscale );
+    b.val[0] = vmulq_f32( vcvtq_f32_s32( vmovl_s16( v.val[2] ) ), vscale );
+    b.val[1] = vmulq_f32( vcvtq_f32_s32( vmovl_s16( v.val[3] ) ), vscale );
+
+    vst2q_f32( out0 + i * 2, a );
+    vst2q_f32( out1 + i * 2, b );
+  }
+
+  s16x2_generic( in + i * 4, out0 + i * 2, out1 + i * 2, nitems - i, scale );
+}
+
+#endif /* CONVERT_NEON */
+
+/* the variants the host CPU supports, fastest first, "generic" last */
+static std::vector< convert_kernels_t > usable_kernels()
+{
+  std::vector< convert_kernels_t > usable;
+
+#ifdef CONVERT_X86
+  if ( cpu_has_avx512f() && cpu_has_avx2() ) {
+    convert_kernels_t k = { "avx512", u8_avx512, s8_avx512, s16_avx512, s12p_avx512,
+                             s16x2_avx512, s24_avx512, s24x2_avx512,
+                             to_s16_avx512, to_s8_avx512,
+                             s8x2_avx512, to_s16x2_avx512, to_s8x2_avx512 };
+    usable.push_back( k );
+  }
+
+  if ( cpu_has_avx2() ) {
+    convert_kernels_t k = { "avx2", u8_avx2, s8_avx2, s16_avx2, s12p_avx2,
+                             s16x2_avx2, s24_avx2, s24x2_avx2,
+                             to_s16_avx2, to_s8_avx2,
+                             s8x2_avx2, to_s16x2_avx2, to_s8x2_avx2 };
+    usable.push_back( k );
+  }
+
+  if ( cpu_has_sse2() ) {
+    convert_kernels_t k = { "sse2", u8_sse2, s8_sse2, s16_sse2, s12p_sse2,
+                             s16x2_sse2, s24_sse2, s24x2_sse2,
+                             to_s16_sse2, to_s8_sse2,
+                             s8x2_sse2, to_s16x2_sse2, to_s8x2_sse2 };
+    usable.push_back( k );
+  }
+#endif
+
+#ifdef CONVERT_NEON
+  {
+    /* see convert_kernels.h for the ones falling back to generic */
+    convert_kernels_t k = { "neon", u8_neon, s8_neon, s16_neon, s12p_generic,
+                             s16x2_neon, s24_generic, s24x2_generic,
+                             to_s16_generic, to_s8_generic,
+                             s8x2_generic, to_s16x2_generic, to_s8x2_generic };
+    usable.push_back( k );
+  }
+#endif
+
+  convert_kernels_t k = { "generic", u8_generic, s8_generic, s16_generic,
+                           s12p_generic, s16x2_generic, s24_generic,
+                           s24x2_generic, to_s16_generic, to_s8_generic,
+                           s8x2_generic, to_s16x2_generic, to_s8x2_generic };
+  usable.push_back( k );
+
+  return usable;
+}
+
+static convert_kernels_t select_kernels()
+{
+  return usable_kernels().front();
+}
+
+static const convert_kernels_t &kernels()
+{
+  static const convert_kernels_t k = select_kernels();
+  return k;
+}
+
+void convert_u8_fc32( const uint8_t *in, gr_complex *out, size_t nitems,
+                      float offset, float scale )
+{
+  kernels().u8( in, reinterpret_cast<float *>(out), nitems * 2, offset, scale );
+}
+
+void convert_s8_fc32( const int8_t *in, gr_complex *out, size_t nitems,
+                      float scale )
+{
+  kernels().s8( in, reinterpret_cast<float *>(out), nitems * 2, scale );
+}
+
+void convert_s16_fc32( const int16_t *in, gr_complex *out, size_t nitems,
+                       float scale )
+{
+  kernels().s16( in, reinterpret_cast<float *>(out), nitems * 2, scale );
+}
+
+void convert_s12p_fc32( const uint8_t *in, gr_complex *out, size_t nitems,
+                        float scale )
+{
+  kernels().s12p( in, reinterpret_cast<float *>(out), nitems, scale );
+}
+
+void convert_s24_fc32( const uint8_t *in, gr_complex *out, size_t nitems,
+                       float scale )
+{
+  kernels().s24( in, reinterpret_cast<float *>(out), nitems, scale );
+}
+
+void convert_s24_fc32_x2( const uint8_t *in, gr_complex *out0, gr_complex *out1,
+                          size_t nitems, float scale )
+{
+  kernels().s24x2( in, reinterpret_cast<float *>(out0),
+                   reinterpret_cast<float *>(out1), nitems, scale );
+}
+
+void convert_s16_fc32_x2( const int16_t *in, gr_complex *out0, gr_complex *out1,
+                          size_t nitems, float scale )
+{
+  kernels().s16x2( in, reinterpret_cast<float *>(out0),
+                   reinterpret_cast<float *>(out1), nitems, scale );
+}
+
+void convert_fc32_s16( const gr_complex *in, int16_t *out, size_t nitems,
+                       float scale )
+{
+  kernels().to_s16( reinterpret_cast<const float *>(in), out, nitems * 2, scale );
+}
+
+void convert_fc32_s8( const gr_complex *in, int8_t *out, size_t nitems,
+                      float scale )
+{
+  kernels().to_s8( reinterpret_cast<const float *>(in), out, nitems * 2, scale );
+}
+
+void convert_s8_fc32_x2( const int8_t *in, gr_complex *out0, gr_complex *out1,
+                         size_t nitems, float scale )
+{
+  kernels().s8x2( in, reinterpret_cast<float *>(out0),
+                  reinterpret_cast<float *>(out1), nitems, scale );
+}
+
+void convert_fc32_s16_x2( const gr_complex *in0, const gr_complex *in1,
+                          int16_t *out, size_t nitems, float scale )
+{
+  kernels().to_s16x2( reinterpret_cast<const float *>(in0),
+                      reinterpret_cast<const float *>(in1), out, nitems, scale );
+}
+
+void convert_fc32_s8_x2( const gr_complex *in0, const gr_complex *in1,
+                         int8_t *out, size_t nitems, float scale )
+{
+  kernels().to_s8x2( reinterpret_cast<const float *>(in0),
+                     reinterpret_cast<const float *>(in1), out, nitems, scale );
+}
+
+/*
+ * Integer outputs. These are simple enough for the compiler to vectorize
+ * at the baseline instruction set, so they are not dispatched.
+ */
+
+/*
+ * Rescaling is done in int and saturated, a full scale input shifted to
+ * the range of the output type would wrap around to the opposite sign.
+ */
+static inline int16_t shift_s16_value( int16_t v, int shift )
+{
+  return int16_t( std::min( std::max( v * (1 << shift), -32768 ), 32767 ) );
+}
+
+static inline int8_t shift_s8_value( int16_t v, int shift )
+{
+  return int8_t( std::min( std::max( v / (1 << shift) - (v % (1 << shift) < 0),
+                                     -128 ), 127 ) );
+}
+
+void convert_u8_sc8( const uint8_t *in, int8_t *out, size_t nitems )
+{
+  for (size_t i = 0; i < nitems * 2; i++)
+    out[i] = int8_t(in[i] ^ 0x80);
+}
+
+void convert_u8_sc16( const uint8_t *in, int16_t *out, size_t nitems )
+{
+  for (size_t i = 0; i < nitems * 2; i++)
+    out[i] = int16_t((in[i] ^ 0x80) << 8);
+}
+
+void convert_s8_sc16( const int8_t *in, int16_t *out, size_t nitems )
+{
+  for (size_t i = 0; i < nitems * 2; i++)
+    out[i] = int16_t(in[i] * 256);
+}
+
+void convert_s16_sc16( const int16_t *in, int16_t *out, size_t nitems,
+                       int shift )
+{
+  for (size_t i = 0; i < nitems * 2; i++)
+    out[i] = shift_s16_value(in[i], shift);
+}
+
+void convert_s16_sc8( const int16_t *in, int8_t *out, size_t nitems,
+                      int shift )
+{
+  for (size_t i = 0; i < nitems * 2; i++)
+    out[i] = shift_s8_value(in[i], shift);
+}
+
+void convert_s8_sc8_x2( const int8_t *in, int8_t *out0, int8_t *out1,
+                        size_t nitems )
+{
+  for (size_t i = 0; i < nitems; i++, in += 4) {
+    *out0++ = in[0]; *out0++ = in[1];
+    *out1++ = in[2]; *out1++ = in[3];
+  }
+}
+
+void convert_s8_sc16_x2( const int8_t *in, int16_t *out0, int16_t *out1,
+                         size_t nitems )
+{
+  for (size_t i = 0; i < nitems; i++, in += 4) {
+    *out0++ = int16_t(in[0] * 256); *out0++ = int16_t(in[1] * 256);
+    *out1++ = int16_t(in[2] * 256); *out1++ = int16_t(in[3] * 256);
+  }
+}
+
+void convert_s16_sc16_x2( const int16_t *in, int16_t *out0, int16_t *out1,
+                          size_t nitems, int shift )
+{
+  for (size_t i = 0; i < nitems; i++, in += 4) {
+    *out0++ = shift_s16_value(in[0], shift); *out0++ = shift_s16_value(in[1], shift);
+    *out1++ = shift_s16_value(in[2], shift); *out1++ = shift_s16_value(in[3], shift);
+  }
+}
+
+void convert_s16_sc8_x2( const int16_t *in, int8_t *out0, int8_t *out1,
+                         size_t nitems, int shift )
+{
+  for (size_t i = 0; i < nitems; i++, in += 4) {
+    *out0++ = shift_s8_value(in[0], shift); *out0++ = shift_s8_value(in[1], shift);
+    *out1++ = shift_s8_value(in[2], shift); *out1++ = shift_s8_value(in[3], shift);
+  }
+}
+
+const char *convert_kernels_arch()
+{
+  return kernels().arch;
+}
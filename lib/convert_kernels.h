@@ -0,0 +1,186 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_CONVERT_KERNELS_H
+#define OSMOSDR_CONVERT_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <gnuradio/gr_complex.h>
+
+/*
+ * Sample format conversion kernels shared by the backends.
+ *
+ * Every kernel converts nitems interleaved IQ pairs. The fastest variant
+ * supported by the host CPU (AVX-512, AVX2, SSE2 or NEON, with a portable
+ * fallback) is selected once on first use.
+ *
+ * AVX-512, AVX2 and SSE2 implement every float kernel below. NEON only has
+ * convert_u8_fc32(), convert_s8_fc32(), convert_s16_fc32() and
+ * convert_s16_fc32_x2(), the others use the portable code there. The
+ * integer outputs for cpu_format=sc16|sc8 are not dispatched at all.
+ */
+
+/*!
+ * Unsigned 8 bit offset binary (rtl, rtl_tcp).
+ * out = (in - offset) * scale
+ */
+void convert_u8_fc32( const uint8_t *in, gr_complex *out, size_t nitems,
+                      float offset = 127.4f, float scale = 1.0f/128.0f );
+
+/*!
+ * Signed 8 bit (hackrf, bladeRF SC8_Q7).
+ * out = in * scale
+ */
+void convert_s8_fc32( const int8_t *in, gr_complex *out, size_t nitems,
+                      float scale = 1.0f/128.0f );
+
+/*!
+ * Signed 16 bit (miri, bladeRF SC16_Q11, rfspace).
+ * out = in * scale
+ */
+void convert_s16_fc32( const int16_t *in, gr_complex *out, size_t nitems,
+                       float scale = 1.0f/32768.0f );
+
+/*!
+ * Signed 12 bit packed into 3 bytes per IQ pair (SoapySDR CS12 layout):
+ * I = in[0] | (in[1] & 0x0f) << 8, Q = (in[1] >> 4) | in[2] << 4.
+ * out = in * scale
+ */
+void convert_s12p_fc32( const uint8_t *in, gr_complex *out, size_t nitems,
+                        float scale = 1.0f/2048.0f );
+
+/*!
+ * Signed 24 bit little endian, 3 bytes per value (rfspace 24 bit mode).
+ * out = in * scale
+ */
+void convert_s24_fc32( const uint8_t *in, gr_complex *out, size_t nitems,
+                       float scale = 1.0f/8388608.0f );
+
+/*!
+ * Two channels of signed 24 bit, interleaved like convert_s16_fc32_x2().
+ */
+void convert_s24_fc32_x2( const uint8_t *in, gr_complex *out0, gr_complex *out1,
+                          size_t nitems, float scale = 1.0f/8388608.0f );
+
+/*!
+ * Two channels of signed 16 bit, interleaved per IQ pair (rfspace nchan=2,
+ * bladeRF MIMO): I0 Q0 I1 Q1 I0 Q0 ...
+ * out0 = in[0,1] * scale, out1 = in[2,3] * scale, nitems per channel.
+ */
+void convert_s16_fc32_x2( const int16_t *in, gr_complex *out0, gr_complex *out1,
+                          size_t nitems, float scale = 1.0f/32768.0f );
+
+/*!
+ * Two channels of signed 8 bit, interleaved like convert_s16_fc32_x2()
+ * (bladeRF MIMO with SC8_Q7).
+ */
+void convert_s8_fc32_x2( const int8_t *in, gr_complex *out0, gr_complex *out1,
+                         size_t nitems, float scale = 1.0f/128.0f );
+
+/*
+ * Integer outputs for cpu_format=sc16|sc8. The results use the full range
+ * of the output type, i.e. they equal the float conversion multiplied by
+ * 32768 or 128 respectively.
+ */
+
+/*!
+ * Unsigned 8 bit offset binary to signed 8 bit. The offset is 128, there
+ * is no room for the fractional DC correction of convert_u8_fc32().
+ */
+void convert_u8_sc8( const uint8_t *in, int8_t *out, size_t nitems );
+
+/*!
+ * Unsigned 8 bit offset binary to signed 16 bit.
+ */
+void convert_u8_sc16( const uint8_t *in, int16_t *out, size_t nitems );
+
+/*!
+ * Signed 8 bit to signed 16 bit.
+ */
+void convert_s8_sc16( const int8_t *in, int16_t *out, size_t nitems );
+
+/*!
+ * Signed 16 bit with fewer significant bits to full scale signed 16 bit.
+ * out = in << shift, e.g. shift 4 for 12 bit samples, saturated.
+ */
+void convert_s16_sc16( const int16_t *in, int16_t *out, size_t nitems,
+                       int shift );
+
+/*!
+ * Signed 16 bit to signed 8 bit, keeping the upper bits.
+ * out = in >> shift, e.g. shift 4 for 12 bit samples, saturated.
+ */
+void convert_s16_sc8( const int16_t *in, int8_t *out, size_t nitems,
+                      int shift );
+
+/*
+ * Two channel variants of the above, deinterleaving I0 Q0 I1 Q1 ...
+ */
+void convert_s8_sc8_x2( const int8_t *in, int8_t *out0, int8_t *out1,
+                        size_t nitems );
+void convert_s8_sc16_x2( const int8_t *in, int16_t *out0, int16_t *out1,
+                         size_t nitems );
+void convert_s16_sc16_x2( const int16_t *in, int16_t *out0, int16_t *out1,
+                          size_t nitems, int shift );
+void convert_s16_sc8_x2( const int16_t *in, int8_t *out0, int8_t *out1,
+                         size_t nitems, int shift );
+
+/*
+ * Transmit side. Values are scaled, rounded to nearest and saturated to
+ * the range of the output type.
+ */
+
+/*!
+ * Float to signed 16 bit (soapy sink, bladeRF SC16_Q11).
+ * out = in * scale
+ */
+void convert_fc32_s16( const gr_complex *in, int16_t *out, size_t nitems,
+                       float scale = 32767.0f );
+
+/*!
+ * Float to signed 8 bit (soapy sink, bladeRF SC8_Q7).
+ * out = in * scale
+ */
+void convert_fc32_s8( const gr_complex *in, int8_t *out, size_t nitems,
+                      float scale = 127.0f );
+
+/*!
+ * Two channels of float interleaved into signed 16 bit (bladeRF MIMO):
+ * out = I0 Q0 I1 Q1 I0 Q0 ... * scale, nitems per channel.
+ */
+void convert_fc32_s16_x2( const gr_complex *in0, const gr_complex *in1,
+                          int16_t *out, size_t nitems, float scale = 32767.0f );
+
+/*!
+ * Two channels of float interleaved into signed 8 bit, see above.
+ */
+void convert_fc32_s8_x2( const gr_complex *in0, const gr_complex *in1,
+                         int8_t *out, size_t nitems, float scale = 127.0f );
+
+/*!
+ * Name of the kernel variant in use, e.g. "avx2".
+ */
+const char *convert_kernels_arch();
+
+#endif // OSMOSDR_CONVERT_KERNELS_H
@@ -22,74 +22,28 @@
 #include <stdexcept>
 #include <boost/format.hpp>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <sstream>
+#include <thread>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
-#ifdef ENABLE_FCD
-#include <fcd_source_c.h>
-#endif
-
-#ifdef ENABLE_FILE
-#include <file_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL
-#include <rtl_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL_TCP
-#include <rtl_tcp_source_c.h>
-#endif
-
-#ifdef ENABLE_UHD
-#include <uhd_source_c.h>
-#endif
-
-#ifdef ENABLE_MIRI
-#include <miri_source_c.h>
-#endif
-
-#ifdef ENABLE_SDRPLAY
-#include <sdrplay_source_c.h>
-#endif
-
-#ifdef ENABLE_HACKRF
-#include <hackrf_source_c.h>
-#endif
-
-#ifdef ENABLE_BLADERF
-#include <bladerf_source_c.h>
-#endif
-
-#ifdef ENABLE_RFSPACE
-#include <rfspace_source_c.h>
-#endif
-
-#ifdef ENABLE_AIRSPY
-#include <airspy_source_c.h>
-#endif
-
-#ifdef ENABLE_AIRSPYHF
-#include <airspyhf_source_c.h>
-#endif
-
-#ifdef ENABLE_SOAPY
-#include <soapy_source_c.h>
-#endif
-
-#ifdef ENABLE_REDPITAYA
-#include <redpitaya_source_c.h>
-#endif
-
-#ifdef ENABLE_FREESRP
-#include <freesrp_source_c.h>
+#ifdef HAVE_LIBUDEV
+#include <libudev.h>
+#include <poll.h>
+#include <cerrno>
 #endif
 
 #include "arg_helpers.h"
+#include "device_enum.h"
+#include "backend_loader.h"
 
 using namespace osmosdr;
 
@@ -134,6 +88,250 @@ std::string device_t::to_string(void) const
   return ss.str();
 }
 
+/*
+ * Process wide registry of device lists, one entry per backend.
+ *
+ * Asking the hardware backends opens every device on the bus and network
+ * discovery takes seconds, so the lists are kept between enumerations.
+ * Lists of USB and serial devices (DEVICE_ENUM_HOTPLUG) are only kept
+ * while the udev monitor is running, which drops them on every hotplug
+ * event. Lists from network discovery (DEVICE_ENUM_NETWORK) expire after
+ * NETWORK_CACHE_MS, every completed discovery updates them. Everything
+ * else is asked again each time.
+ */
+
+#define NETWORK_CACHE_MS 10000
+
+struct registry_entry_t
+{
+  registry_entry_t() : valid(false), flags(0), generation(0) {}
+
+  std::vector< std::string > devices;
+  bool valid;
+  int flags;
+  uint64_t generation; /* bumped on invalidation, drops late results */
+  std::chrono::steady_clock::time_point stamp;
+};
+
+/*
+ * Held by reference by the enumeration workers and the udev monitor,
+ * which may still run while the library is unloaded.
+ */
+struct registry_t
+{
+  registry_t() : next_hook_id(0), hotplug_monitor(false) {}
+
+  std::mutex mutex;
+  std::map< std::string, registry_entry_t > entries;
+  /* copied out for the calls, hooks may hold a Python callable whose
+   * copies need the GIL */
+  std::map< size_t, std::shared_ptr< device::invalidate_cb_t > > hooks;
+  size_t next_hook_id;
+  bool hotplug_monitor;
+};
+
+typedef std::shared_ptr< registry_t > registry_ptr;
+
+static const registry_ptr _registry = std::make_shared< registry_t >();
+
+static std::string registry_key( const device_enumerator_t &e )
+{
+  return (e.flags & DEVICE_ENUM_FAKE) ? e.name + ",fake" : e.name;
+}
+
+/* drops the entries of one backend (all if empty) having any of flags */
+static void registry_invalidate( registry_t &reg,
+                                 const std::string &backend, int flags )
+{
+  std::vector< std::shared_ptr< device::invalidate_cb_t > > hooks;
+
+  {
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    for (auto &entry : reg.entries) {
+      const std::string &key = entry.first;
+
+      if ( backend.size() && key != backend && key != backend + ",fake" )
+        continue;
+
+      if ( ! (entry.second.flags & flags) )
+        continue;
+
+      entry.second.valid = false;
+      entry.second.devices.clear();
+      entry.second.generation++;
+    }
+
+    for (auto &hook : reg.hooks)
+      hooks.push_back( hook.second );
+  }
+
+  /* outside the lock, so the hooks may call find() again */
+  for (auto &hook : hooks)
+    (*hook)( backend );
+}
+
+#ifdef HAVE_LIBUDEV
+static void hotplug_monitor( registry_ptr reg,
+                             struct udev *udev, struct udev_monitor *mon )
+{
+  struct pollfd pfd;
+
+  pfd.fd = udev_monitor_get_fd( mon );
+  pfd.events = POLLIN;
+
+  for (;;) {
+    if ( poll( &pfd, 1, -1 ) < 0 ) {
+      if ( EINTR == errno )
+        continue;
+
+      std::cerr << "Device hotplug monitor failed: "
+                << strerror( errno ) << std::endl;
+      break;
+    }
+
+    struct udev_device *dev = udev_monitor_receive_device( mon );
+    if ( ! dev )
+      continue;
+
+    const char *action = udev_device_get_action( dev );
+
+    if ( action && ( ! strcmp( action, "add" ) || ! strcmp( action, "remove" ) ) )
+      registry_invalidate( *reg, "", DEVICE_ENUM_HOTPLUG );
+
+    udev_device_unref( dev );
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(reg->mutex);
+    reg->hotplug_monitor = false;
+  }
+
+  registry_invalidate( *reg, "", DEVICE_ENUM_HOTPLUG );
+
+  udev_monitor_unref( mon );
+  udev_unref( udev );
+}
+#endif
+
+/* must be called before anything is cached, the monitor runs forever */
+static void start_hotplug_monitor()
+{
+#ifdef HAVE_LIBUDEV
+  struct udev *udev = udev_new();
+  if ( ! udev )
+    return;
+
+  struct udev_monitor *mon = udev_monitor_new_from_netlink( udev, "udev" );
+  if ( ! mon ) {
+    udev_unref( udev );
+    return;
+  }
+
+  /* USB devices and USB serial adapters (SDR-IQ) */
+  if ( udev_monitor_filter_add_match_subsystem_devtype( mon, "usb", "usb_device" ) < 0 ||
+       udev_monitor_filter_add_match_subsystem_devtype( mon, "tty", NULL ) < 0 ||
+       udev_monitor_enable_receiving( mon ) < 0 ) {
+    udev_monitor_unref( mon );
+    udev_unref( udev );
+    return;
+  }
+
+  try {
+    std::thread( hotplug_monitor, _registry, udev, mon ).detach();
+  } catch ( ... ) {
+    udev_monitor_unref( mon );
+    udev_unref( udev );
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(_registry->mutex);
+  _registry->hotplug_monitor = true;
+#endif
+}
+
+/* looks up a valid list, called with reg.mutex held */
+static bool registry_lookup( registry_t &reg, const device_enumerator_t &e,
+                             std::vector< std::string > &devices,
+                             uint64_t &generation )
+{
+  registry_entry_t &entry = reg.entries[ registry_key( e ) ];
+
+  entry.flags = e.flags;
+  generation = entry.generation;
+
+  if ( (e.flags & DEVICE_ENUM_HOTPLUG) && ! reg.hotplug_monitor )
+    return false;
+
+  if ( ! (e.flags & (DEVICE_ENUM_HOTPLUG | DEVICE_ENUM_NETWORK)) )
+    return false;
+
+  if ( ! entry.valid )
+    return false;
+
+  if ( (e.flags & DEVICE_ENUM_NETWORK) &&
+       std::chrono::steady_clock::now() - entry.stamp >
+         std::chrono::milliseconds( NETWORK_CACHE_MS ) )
+    return false;
+
+  devices = entry.devices;
+
+  return true;
+}
+
+/* stores a fresh list unless it was invalidated while being taken */
+static void registry_store( registry_t &reg, const device_enumerator_t &e,
+                            const std::vector< std::string > &devices,
+                            uint64_t generation )
+{
+  std::lock_guard<std::mutex> lock(reg.mutex);
+
+  registry_entry_t &entry = reg.entries[ registry_key( e ) ];
+
+  if ( entry.generation != generation )
+    return;
+
+  entry.devices = devices;
+  entry.valid = true;
+  entry.stamp = std::chrono::steady_clock::now();
+}
+
+std::vector< std::string >
+registry_enumerate( const std::vector< device_enumerator_t > &enumerators,
+                    unsigned int timeout_ms, bool first_only )
+{
+  static std::once_flag monitor_once;
+  std::call_once( monitor_once, start_hotplug_monitor );
+
+  registry_ptr reg = _registry;
+  std::vector< device_enumerator_t > cached;
+
+  {
+    std::lock_guard<std::mutex> lock(reg->mutex);
+
+    for (const device_enumerator_t &e : enumerators) {
+      std::vector< std::string > devices;
+      uint64_t generation;
+      device_enumerator_t c = e;
+
+      if ( registry_lookup( *reg, e, devices, generation ) ) {
+        c.get_devices = [devices]() { return devices; };
+      } else {
+        /* also fills the registry when the caller gave up waiting */
+        c.get_devices = [reg, e, generation]() {
+          std::vector< std::string > devices = e.get_devices();
+          registry_store( *reg, e, devices, generation );
+          return devices;
+        };
+      }
+
+      cached.push_back( c );
+    }
+  }
+
+  return enumerate_devices( cached, timeout_ms, first_only );
+}
+
 devices_t device::find(const device_t &hint)
 {
   std::lock_guard<std::mutex> lock(_device_mutex);
@@ -143,73 +341,58 @@ devices_t device::find(const device_t &hint)
   if ( hint.count("nofake") )
     fake = false;
 
-  devices_t devices;
+  unsigned int timeout_ms = hint.cast< unsigned int >( "enum_timeout_ms", 0 );
 
-#ifdef ENABLE_FCD
-  for (std::string dev : fcd_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_RTL
-  for (std::string dev : rtl_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_UHD
-  for (std::string dev : uhd_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_MIRI
-  for (std::string dev : miri_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_SDRPLAY
-  for (std::string dev : sdrplay_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_BLADERF
-  for (std::string dev : bladerf_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_HACKRF
-  for (std::string dev : hackrf_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_RFSPACE
-  for (std::string dev : rfspace_source_c::get_devices( fake ))
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_AIRSPY
-  for (std::string dev : airspy_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_AIRSPYHF
-  for (std::string dev : airspyhf_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_FREESRP
-  for (std::string dev : freesrp_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_SOAPY
-  for (std::string dev : soapy_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
+  std::vector< device_enumerator_t > enumerators =
+      backend_enumerators( BACKEND_SOURCE, fake );
 
-  /* software-only sources should be appended at the very end,
-   * hopefully resulting in hardware sources to be shown first
-   * in a graphical interface etc... */
+  devices_t devices;
 
-#ifdef ENABLE_RTL_TCP
-  for (std::string dev : rtl_tcp_source_c::get_devices( fake ))
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_REDPITAYA
-  for (std::string dev : redpitaya_source_c::get_devices( fake ))
+  /* backends are asked concurrently, results keep the order of the list */
+  for (std::string dev : registry_enumerate( enumerators, timeout_ms ))
     devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_FILE
-  for (std::string dev : file_source_c::get_devices( fake ))
-    devices.push_back( device_t(dev) );
-#endif
 
   return devices;
 }
+
+devices_t device::refresh(const device_t &hint)
+{
+  invalidate();
+
+  return find(hint);
+}
+
+void device::invalidate(const std::string &backend)
+{
+  registry_invalidate( *_registry, backend,
+                       DEVICE_ENUM_HOTPLUG | DEVICE_ENUM_NETWORK );
+}
+
+size_t device::add_invalidate_hook(const invalidate_cb_t &hook)
+{
+  std::shared_ptr< invalidate_cb_t > p = std::make_shared< invalidate_cb_t >( hook );
+
+  std::lock_guard<std::mutex> lock(_registry->mutex);
+
+  _registry->hooks[ _registry->next_hook_id ] = p;
+
+  return _registry->next_hook_id++;
+}
+
+void device::remove_invalidate_hook(size_t id)
+{
+  std::shared_ptr< invalidate_cb_t > hook;
+
+  {
+    std::lock_guard<std::mutex> lock(_registry->mutex);
+
+    auto it = _registry->hooks.find( id );
+    if ( it == _registry->hooks.end() )
+      return;
+
+    hook = std::move( it->second );
+    _registry->hooks.erase( it );
+  }
+
+  /* hook is released on return, outside the lock */
+}
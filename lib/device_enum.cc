@@ -0,0 +1,298 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "device_enum.h"
+
+namespace {
+
+/* shared with the workers, which may outlive the call after a timeout */
+struct enum_state
+{
+  explicit enum_state( size_t count )
+    : results(count), errors(count), done(count, false)
+  {}
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::vector< std::vector< std::string > > results;
+  std::vector< std::exception_ptr > errors;
+  std::vector< char > done; /* not vector<bool>, the workers write concurrently */
+};
+
+/*
+ * One get_devices() call and the enumerations waiting for its result.
+ * A search started while the previous one of a backend still runs waits
+ * for that one instead of asking the backend again.
+ */
+struct enum_job
+{
+  std::string name;
+  bool fake;       /* DEVICE_ENUM_FAKE lists are kept apart */
+  bool exclusive;
+  bool running;
+  device_list_fn_t get_devices;
+  std::vector< std::pair< std::shared_ptr< enum_state >, size_t > > waiting;
+};
+
+/*
+ * Worker threads of all enumerations, including abandoned ones. Finished
+ * workers are joined when the next one is started or the library is
+ * unloaded, the rest are detached then. Every worker holds a reference,
+ * so a hung one may outlive the library without touching freed state.
+ *
+ * Only one worker of a backend runs at a time. DEVICE_ENUM_EXCLUSIVE
+ * workers only run when no other worker does, as they call into the same
+ * vendor libraries as the native backends.
+ */
+class worker_registry : public std::enable_shared_from_this< worker_registry >
+{
+public:
+  worker_registry() : _next_id(0), _shared(0), _exclusive(0), _detach(false) {}
+
+  /* called on unload, waiting for a backend which hangs would block exit */
+  void shutdown()
+  {
+    std::map< size_t, std::thread > threads;
+    std::vector< size_t > finished;
+
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      threads.swap( _threads );
+      finished.swap( _finished );
+      _detach = true;
+    }
+
+    for (size_t id : finished) {
+      threads[ id ].join();
+      threads.erase( id );
+    }
+
+    for (auto &t : threads)
+      t.second.detach();
+  }
+
+  /* result i of state is filled once e.get_devices() has been called */
+  void start( const device_enumerator_t &e,
+              std::shared_ptr< enum_state > state, size_t i )
+  {
+    const bool fake = (e.flags & DEVICE_ENUM_FAKE);
+    const bool exclusive = (e.flags & DEVICE_ENUM_EXCLUSIVE);
+
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    /* they are past their last use of _mutex */
+    for (size_t id : _finished) {
+      auto t = _threads.find( id );
+      if ( t != _threads.end() ) {
+        t->second.join();
+        _threads.erase( t );
+      }
+    }
+    _finished.clear();
+
+    for (std::shared_ptr< enum_job > &job : _jobs) {
+      if ( job->name == e.name && job->fake == fake ) {
+        job->waiting.push_back( std::make_pair( state, i ) );
+        return;
+      }
+    }
+
+    std::shared_ptr< enum_job > job = std::make_shared< enum_job >();
+    job->name = e.name;
+    job->fake = fake;
+    job->exclusive = exclusive;
+    job->running = false;
+    job->get_devices = e.get_devices;
+    job->waiting.push_back( std::make_pair( state, i ) );
+
+    /* counted right away, so exclusive workers started after this one
+     * are sure to wait for it */
+    if ( ! exclusive )
+      _shared++;
+
+    try {
+      std::thread t( &worker_registry::run, shared_from_this(), job, _next_id );
+
+      if ( _detach )
+        t.detach();
+      else
+        _threads[ _next_id ] = std::move( t );
+    } catch ( ... ) {
+      if ( ! exclusive )
+        _shared--;
+      throw;
+    }
+
+    _next_id++;
+    _jobs.push_back( job );
+  }
+
+private:
+  /* another worker of the same backend is running, called with _mutex held */
+  bool backend_busy( const std::shared_ptr< enum_job > &job )
+  {
+    for (std::shared_ptr< enum_job > &other : _jobs)
+      if ( other != job && other->running && other->name == job->name )
+        return true;
+
+    return false;
+  }
+
+  void run( std::shared_ptr< enum_job > job, size_t id )
+  {
+    {
+      std::unique_lock< std::mutex > lock( _mutex );
+
+      if ( job->exclusive ) {
+        _gate.wait( lock, [this, &job]() {
+          return 0 == _shared && 0 == _exclusive && ! backend_busy( job );
+        } );
+        _exclusive++;
+      } else {
+        _gate.wait( lock, [this, &job]() { return ! backend_busy( job ); } );
+      }
+
+      job->running = true;
+    }
+
+    std::vector< std::string > devices;
+    std::exception_ptr error;
+
+    try {
+      devices = job->get_devices();
+    } catch ( ... ) {
+      error = std::current_exception();
+    }
+
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+
+      if ( job->exclusive )
+        _exclusive--;
+      else
+        _shared--;
+
+      /* no one can join the job from here on */
+      _jobs.remove( job );
+      _finished.push_back( id );
+      _gate.notify_all();
+    }
+
+    for (auto &w : job->waiting) {
+      std::shared_ptr< enum_state > &state = w.first;
+      size_t i = w.second;
+
+      std::lock_guard< std::mutex > lock( state->mutex );
+      state->results[i] = devices;
+      state->errors[i] = error;
+      state->done[i] = true;
+      state->cond.notify_all();
+    }
+  }
+
+  std::mutex _mutex;
+  std::condition_variable _gate;
+  std::list< std::shared_ptr< enum_job > > _jobs; /* waiting or running */
+  std::map< size_t, std::thread > _threads;
+  std::vector< size_t > _finished;
+  size_t _next_id;
+  size_t _shared;     /* other workers started and not finished */
+  size_t _exclusive;  /* exclusive workers running */
+  bool _detach;       /* unloading, no more joins */
+};
+
+struct workers_t
+{
+  workers_t() : registry( std::make_shared< worker_registry >() ) {}
+  ~workers_t() { registry->shutdown(); }
+
+  std::shared_ptr< worker_registry > registry;
+};
+
+workers_t workers;
+
+}
+
+std::vector< std::string >
+enumerate_devices( const std::vector< device_enumerator_t > &enumerators,
+                   unsigned int timeout_ms, bool first_only )
+{
+  std::shared_ptr< enum_state > state =
+      std::make_shared< enum_state >( enumerators.size() );
+
+  /* exclusive backends are started last, so they run after the others */
+  for (int pass = 0; pass < 2; pass++) {
+    for (size_t i = 0; i < enumerators.size(); i++) {
+      const device_enumerator_t &e = enumerators[i];
+
+      if ( bool(e.flags & DEVICE_ENUM_EXCLUSIVE) != (pass == 1) )
+        continue;
+
+      workers.registry->start( e, state, i );
+    }
+  }
+
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds( timeout_ms );
+
+  std::vector< std::string > devices;
+  std::unique_lock< std::mutex > lock( state->mutex );
+
+  for (size_t i = 0; i < enumerators.size(); i++) {
+    auto finished = [&state, i]() { return 0 != state->done[i]; };
+
+    if ( 0 == timeout_ms ) {
+      state->cond.wait( lock, finished );
+    } else if ( ! state->cond.wait_until( lock, deadline, finished ) ) {
+      std::cerr << "Skipping " << enumerators[i].name << " devices, "
+                << "enumeration did not finish within "
+                << timeout_ms << " ms." << std::endl;
+      continue;
+    }
+
+    if ( state->errors[i] )
+      std::rethrow_exception( state->errors[i] );
+
+    devices.insert( devices.end(),
+                    state->results[i].begin(), state->results[i].end() );
+
+    if ( first_only && devices.size() )
+      break;
+  }
+
+  return devices;
+}
@@ -0,0 +1,90 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_DEVICE_ENUM_H
+#define OSMOSDR_DEVICE_ENUM_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+typedef std::function< std::vector< std::string >( void ) > device_list_fn_t;
+
+/* how the device list of a backend is taken and cached, see device.cc */
+enum {
+  DEVICE_ENUM_NOCACHE = 0,
+  DEVICE_ENUM_HOTPLUG = 1 << 0, /* changes with USB or serial hotplug */
+  DEVICE_ENUM_NETWORK = 1 << 1, /* network discovery, the list expires */
+  DEVICE_ENUM_FAKE    = 1 << 2, /* contains placeholders, kept apart */
+  DEVICE_ENUM_EXCLUSIVE = 1 << 3, /* shares vendor libraries with the
+                                     other backends, never runs alongside */
+  DEVICE_ENUM_SOFTWARE = 1 << 4,  /* no hardware, listed after the others */
+};
+
+/*!
+ * One backend taking part in device enumeration.
+ */
+struct device_enumerator_t
+{
+  /* backend name, source and sink of the same backend must share it as
+   * their device lists are taken to be the same */
+  std::string name;
+  device_list_fn_t get_devices;
+  int flags;
+};
+
+/*!
+ * \brief Runs the get_devices() calls of all backends concurrently.
+ *
+ * Backends flagged DEVICE_ENUM_EXCLUSIVE, i.e. SoapySDR whose modules
+ * init and exit the same vendor libraries as the native backends, only
+ * start once all other enumerations have finished.
+ *
+ * The results are merged in the order of the list, so the outcome does
+ * not depend on which backend happens to answer first. A backend which
+ * did not answer within timeout_ms (0 waits forever) is skipped with a
+ * warning and left to finish in the background. With first_only, the
+ * merge stops at the first backend reporting any device, without waiting
+ * for the ones after it.
+ *
+ * A backend is not asked again while its previous enumeration is still
+ * running, the call waits for that result instead, within the same
+ * timeout_ms.
+ *
+ * An exception thrown by a backend is passed on to the caller once its
+ * turn in the merge has come.
+ */
+std::vector< std::string >
+enumerate_devices( const std::vector< device_enumerator_t > &enumerators,
+                   unsigned int timeout_ms = 0, bool first_only = false );
+
+/*!
+ * \brief Like enumerate_devices(), but answers from the process wide
+ * device registry wherever a backend's cached list is still valid.
+ *
+ * Implemented in device.cc along with osmosdr::device::invalidate().
+ */
+std::vector< std::string >
+registry_enumerate( const std::vector< device_enumerator_t > &enumerators,
+                    unsigned int timeout_ms = 0, bool first_only = false );
+
+#endif // OSMOSDR_DEVICE_ENUM_H
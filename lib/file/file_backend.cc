@@ -0,0 +1,41 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "backend.h"
+
+#include "file_source_c.h"
+#include "file_sink_c.h"
+
+static const osmosdr_backend_t backend = {
+  OSMOSDR_BACKEND_ABI_VERSION,
+  "file",
+  backend_make_source< file_source_c, make_file_source_c >,
+  []( bool fake ) { return file_source_c::get_devices( fake ); },
+  backend_make_sink< file_sink_c, make_file_sink_c >,
+  []( bool fake ) { return file_sink_c::get_devices( fake ); }
+};
+
+OSMOSDR_BACKEND( backend )
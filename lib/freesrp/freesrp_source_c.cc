@@ -32,6 +32,10 @@ freesrp_source_c::freesrp_source_c (const std::string & args) : gr::sync_block (
 
 bool freesrp_source_c::start()
 {
+    _tagger.set_rate(get_sample_rate());
+    _tagger.set_freq(get_center_freq());
+    _tagger.start();
+
     FreeSRP::response res = _srp->send_cmd({FreeSRP::SET_DATAPATH_EN, 1});
     if(res.error != FreeSRP::CMD_OK)
     {
@@ -58,6 +62,8 @@ void freesrp_source_c::freesrp_rx_callback(const std::vector<FreeSRP::sample> &s
 {
     std::unique_lock<std::mutex> lk(_buf_mut);
 
+    size_t dropped = 0;
+
     for(const FreeSRP::sample &s : samples)
     {
         if(!_buf_queue.try_enqueue(s))
@@ -66,6 +72,7 @@ void freesrp_source_c::freesrp_rx_callback(const std::vector<FreeSRP::sample> &s
 	    {
 		throw std::runtime_error("RX buffer overflow");
 	    }
+	    dropped++;
         }
         else
         {
@@ -73,6 +80,12 @@ void freesrp_source_c::freesrp_rx_callback(const std::vector<FreeSRP::sample> &s
         }
     }
 
+    if(dropped)
+    {
+        _stats.overflow(dropped);
+        _tagger.discontinuity();
+    }
+
     _buf_cond.notify_one();
 }
 
@@ -93,6 +106,8 @@ int freesrp_source_c::work(int noutput_items, gr_vector_const_void_star& input_i
         _buf_cond.wait(lk);
     }
 
+    _tagger.tag(nitems_written(0));
+
     for(int i = 0; i < noutput_items; ++i)
     {
         FreeSRP::sample s;
@@ -123,6 +138,7 @@ double freesrp_source_c::set_sample_rate( double rate )
     }
     else
     {
+        _tagger.set_rate(static_cast<double>(r.param));
         return static_cast<double>(r.param);
     }
 }
@@ -152,6 +168,7 @@ double freesrp_source_c::set_center_freq( double freq, size_t chan )
     }
     else
     {
+        _tagger.set_freq(static_cast<double>(r.param), chan);
         return static_cast<double>(r.param);
     }
 }
@@ -27,6 +27,8 @@
 
 #include "osmosdr/ranges.h"
 #include "source_iface.h"
+#include "stream_counters.h"
+#include "rx_tagger.h"
 
 #include "freesrp_common.h"
 
@@ -116,6 +118,8 @@ public:
     double set_bandwidth( double bandwidth, size_t chan = 0 );
     double get_bandwidth( size_t chan = 0 );
 
+    osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 ) { return _stats.get(chan); }
+
 private:
 
     void freesrp_rx_callback(const std::vector<FreeSRP::sample> &samples);
@@ -126,6 +130,9 @@ private:
     std::condition_variable _buf_cond{};
     size_t _buf_num_samples = 0;
     moodycamel::ReaderWriterQueue<FreeSRP::sample> _buf_queue{FREESRP_RX_TX_QUEUE_SIZE};
+    stream_counters _stats;
+    rx_tagger _tagger{[this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+                      gr::sync_block::name()};
 };
 
 #endif /* INCLUDED_FREESRP_SOURCE_C_H */
@@ -32,17 +32,14 @@
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
-#ifdef USE_AVX
-#include <immintrin.h>
-#elif USE_SSE2
-#include <emmintrin.h>
-#endif
+#include <cstring>
 
 #include <gnuradio/io_signature.h>
 
 #include "hackrf_sink_c.h"
 
 #include "arg_helpers.h"
+#include "convert_kernels.h"
 
 static inline bool cb_init(circular_buffer_t *cb, size_t capacity, size_t sz)
 {
@@ -83,11 +80,17 @@ static inline bool cb_is_empty(circular_buffer_t *cb)
   return cb->count == 0;
 }
 
-static inline bool cb_push_back(circular_buffer_t *cb, const void *item)
+/* the slot at the head, only to be written while cb_has_room() */
+static inline int8_t *cb_head(circular_buffer_t *cb)
+{
+  return (int8_t *)cb->head;
+}
+
+/* hands the filled head slot to the consumer */
+static inline bool cb_commit(circular_buffer_t *cb)
 {
   if(cb->count == cb->capacity)
     return false; // handle error
-  memcpy(cb->head, item, cb->sz);
   cb->head = (int8_t *)cb->head + cb->sz;
   if(cb->head == cb->buffer_end)
     cb->head = cb->buffer;
@@ -134,7 +137,6 @@ hackrf_sink_c::hackrf_sink_c (const std::string &args)
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
     hackrf_common::hackrf_common(args),
-    _buf(NULL),
     _vga_gain(0)
 {
   dict_t dict = params_to_dict(args);
@@ -167,8 +169,6 @@ hackrf_sink_c::hackrf_sink_c (const std::string &args)
     hackrf_common::set_bias(dict["bias_tx"] == "1");
   }
 
-  _buf = (int8_t *) malloc( BUF_LEN );
-
   cb_init( &_cbuf, _buf_num, BUF_LEN );
 }
 
@@ -177,9 +177,6 @@ hackrf_sink_c::hackrf_sink_c (const std::string &args)
  */
 hackrf_sink_c::~hackrf_sink_c ()
 {
-  free(_buf);
-  _buf = NULL;
-
   cb_free( &_cbuf );
 }
 
@@ -204,7 +201,7 @@ int hackrf_sink_c::hackrf_tx_callback(unsigned char *buffer, uint32_t length)
         _buf_cond.notify_one();
         return -1;
       } else {
-        std::cerr << "U" << std::flush;
+        _stats.underflow(length / BYTES_PER_SAMPLE);
       }
     } else {
 //      std::cerr << "-" << std::flush;
@@ -245,17 +242,17 @@ bool hackrf_sink_c::stop()
       _buf_cond.wait( lock );
 
     // Fill the rest of the current buffer with silence.
-    memset(_buf + _buf_used, 0, BUF_LEN - _buf_used);
-    cb_push_back( &_cbuf, _buf );
+    memset(cb_head(&_cbuf) + _buf_used, 0, BUF_LEN - _buf_used);
+    cb_commit( &_cbuf );
     _buf_used = 0;
 
     // Add some more silence so the end doesn't get cut off.
-    memset(_buf, 0, BUF_LEN);
     for (i = 0; i < 5; i++) {
       while ( ! cb_has_room(&_cbuf) )
         _buf_cond.wait( lock );
 
-      cb_push_back( &_cbuf, _buf );
+      memset(cb_head(&_cbuf), 0, BUF_LEN);
+      cb_commit( &_cbuf );
     }
 
     _stopping = true;
@@ -273,68 +270,6 @@ bool hackrf_sink_c::stop()
   return true;
 }
 
-#ifdef USE_AVX
-void convert_avx(const float* inbuf, int8_t* outbuf,const unsigned int count)
-{
-  __m256 mulme = _mm256_set_ps(127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f);
-  for(unsigned int i=0; i<count;i++){
-
-  __m256i itmp3 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&inbuf[i*16+0]), mulme));
-  __m256i itmp4 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&inbuf[i*16+8]), mulme));
-
-  __m128i a1 = _mm256_extractf128_si256(itmp3, 1);
-  __m128i a0 = _mm256_castsi256_si128(itmp3);
-  __m128i a3 = _mm256_extractf128_si256(itmp4, 1);
-  __m128i a2 = _mm256_castsi256_si128(itmp4);
-
-  __m128i outshorts1 = _mm_packs_epi32(a0, a1);
-  __m128i outshorts2 = _mm_packs_epi32(a2, a3);
-
-  __m128i outbytes = _mm_packs_epi16(outshorts1, outshorts2);
-
-  _mm_storeu_si128 ((__m128i*)&outbuf[i*16], outbytes);
-  }
-}
-
-#elif USE_SSE2
-void convert_sse2(const float* inbuf, int8_t* outbuf,const unsigned int count)
-{
-  const __m128 mulme = _mm_set_ps( 127.0f, 127.0f, 127.0f, 127.0f );
-  __m128 itmp1,itmp2,itmp3,itmp4;
-  __m128i otmp1,otmp2,otmp3,otmp4;
-
-  __m128i outshorts1,outshorts2;
-  __m128i outbytes;
-
-  for(unsigned int i=0; i<count;i++){
-
-  itmp1 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+0]), mulme);
-  itmp2 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+4]), mulme);
-  itmp3 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+8]), mulme);
-  itmp4 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+12]), mulme);
-
-  otmp1 = _mm_cvtps_epi32(itmp1);
-  otmp2 = _mm_cvtps_epi32(itmp2);
-  otmp3 = _mm_cvtps_epi32(itmp3);
-  otmp4 = _mm_cvtps_epi32(itmp4);
-
-  outshorts1 = _mm_packs_epi32(otmp1, otmp2);
-  outshorts2 = _mm_packs_epi32(otmp3, otmp4);
-
-  outbytes = _mm_packs_epi16(outshorts1, outshorts2);
-
-  _mm_storeu_si128 ((__m128i*)&outbuf[i*16], outbytes);
-  }
-}
-#endif
-
-void convert_default(float* inbuf, int8_t* outbuf,const unsigned int count)
-{
-  for(unsigned int i=0; i<count;i++){
-    outbuf[i]= inbuf[i]*127;
-  }
-}
-
 int hackrf_sink_c::work( int noutput_items,
                          gr_vector_const_void_star &input_items,
                          gr_vector_void_star &output_items )
@@ -348,46 +283,24 @@ int hackrf_sink_c::work( int noutput_items,
       _buf_cond.wait( lock );
   }
 
-  int8_t *buf = _buf + _buf_used;
-  unsigned int prev_buf_used = _buf_used;
+  /* the head slot belongs to us until it is committed, convert into it */
+  unsigned int remaining = (BUF_LEN - _buf_used) / BYTES_PER_SAMPLE;
+  unsigned int count = std::min( (unsigned int)noutput_items, remaining );
 
-  unsigned int remaining = (BUF_LEN-_buf_used)/2; //complex
+  convert_fc32_s8( in, cb_head(&_cbuf) + _buf_used, count );
 
-  unsigned int count = std::min((unsigned int)noutput_items,remaining);
-  unsigned int sse_rem = count/8; // 8 complex = 16f==512bit for avx
-  unsigned int nosse_rem = count%8; // remainder
+  _buf_used += count * BYTES_PER_SAMPLE;
 
-#ifdef USE_AVX
-  convert_avx((float*)in, buf, sse_rem);
-  convert_default((float*)(in+sse_rem*8), buf+(sse_rem*8*2), nosse_rem*2);
-#elif USE_SSE2
-  convert_sse2((float*)in, buf, sse_rem);
-  convert_default((float*)(in+sse_rem*8), buf+(sse_rem*8*2), nosse_rem*2);
-#else
-  convert_default((float*)in, buf, count*2);
-#endif
-
-  _buf_used += (sse_rem*8+nosse_rem)*2;
-  int items_consumed = sse_rem*8+nosse_rem;
-
-  if((unsigned int)noutput_items >= remaining) {
-    {
-      std::lock_guard<std::mutex> lock(_buf_mutex);
+  if ( _buf_used == BUF_LEN ) {
+    std::lock_guard<std::mutex> lock(_buf_mutex);
 
-      if ( ! cb_push_back( &_cbuf, _buf ) ) {
-        _buf_used = prev_buf_used;
-        items_consumed = 0;
-        std::cerr << "O" << std::flush;
-      } else {
-//        std::cerr << "+" << std::flush;
-        _buf_used = 0;
-      }
-    }
+    cb_commit( &_cbuf );
+    _buf_used = 0;
   }
 
   // Tell runtime system how many input items we consumed on
   // each input stream.
-  consume_each(items_consumed);
+  consume_each(count);
 
   // Tell runtime system how many output items we produced.
   return 0;
@@ -565,3 +478,8 @@ osmosdr::freq_range_t hackrf_sink_c::get_bandwidth_range( size_t chan )
 {
   return hackrf_common::get_bandwidth_range(chan);
 }
+
+osmosdr::stream_stats_t hackrf_sink_c::get_stream_stats( size_t chan )
+{
+  return _stats.get( chan );
+}
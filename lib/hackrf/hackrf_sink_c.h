@@ -30,6 +30,7 @@
 
 #include "sink_iface.h"
 #include "hackrf_common.h"
+#include "stream_counters.h"
 
 class hackrf_sink_c;
 
@@ -123,15 +124,17 @@ public:
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
 private:
   static int _hackrf_tx_callback(hackrf_transfer* transfer);
   int hackrf_tx_callback(unsigned char *buffer, uint32_t length);
 
   circular_buffer_t _cbuf;
-  int8_t *_buf;
   unsigned int _buf_num;
-  unsigned int _buf_used;
+  unsigned int _buf_used; /* bytes converted into the head slot */
   bool _stopping;
+  stream_counters _stats;
   std::mutex _buf_mutex;
   std::condition_variable _buf_cond;
 
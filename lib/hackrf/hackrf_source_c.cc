@@ -31,12 +31,18 @@
 #include <stdexcept>
 #include <iostream>
 #include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include <gnuradio/io_signature.h>
 
 #include "hackrf_source_c.h"
 
 #include "arg_helpers.h"
+#include "convert_kernels.h"
 
 hackrf_source_c_sptr make_hackrf_source_c (const std::string & args)
 {
@@ -57,20 +63,35 @@ static const int MAX_IN = 0;	// maximum number of input streams
 static const int MIN_OUT = 1;	// minimum number of output streams
 static const int MAX_OUT = 1;	// maximum number of output streams
 
+/* in sweep mode every block starts with 0x7f 0x7f and the 64 bit little
+ * endian frequency the firmware tuned to, minus the offset */
+static const unsigned int SWEEP_HEADER_LEN = 10;
+
 /*
  * The private constructor
  */
 hackrf_source_c::hackrf_source_c (const std::string &args)
   : gr::sync_block ("hackrf_source_c",
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
-        gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+        gr::io_signature::make(MIN_OUT, MAX_OUT,
+          cpu_format_item_size(args_to_cpu_format(args)))),
     hackrf_common::hackrf_common(args),
     _buf(NULL),
     _lna_gain(0),
-    _vga_gain(0)
+    _vga_gain(0),
+    _tagger([this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+            gr::sync_block::name()),
+    _sweep(false),
+    _sweep_start(0),
+    _sweep_stop(0),
+    _sweep_step(0),
+    _sweep_blocks(1),
+    _latency_ms(0)
 {
   dict_t dict = params_to_dict(args);
 
+  _cpu_format = args_to_cpu_format(args);
+
   _buf_num = _buf_len = _buf_head = _buf_used = _buf_offset = 0;
 
   if (dict.count("buffers"))
@@ -87,9 +108,38 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
 
   _samp_avail = _buf_len / BYTES_PER_SAMPLE;
 
-  // create a lookup table for gr_complex values
-  for (unsigned int i = 0; i <= 0xff; i++) {
-    _lut.push_back( float(int8_t(i)) * (1.0f/128.0f) );
+  /* libhackrf fixes the transfer size, so this only stops work() from
+   * collecting several transfers before handing out samples */
+  if (dict.count("latency_ms"))
+    _latency_ms = boost::lexical_cast< unsigned int >( dict["latency_ms"] );
+
+  if (dict.count("sweep")) {
+#ifdef HACKRF_SWEEP_SUPPORT
+    std::vector< std::string > tokens;
+    boost::algorithm::split( tokens, dict["sweep"], boost::is_any_of(":") );
+
+    if ( tokens.size() != 3 )
+      throw std::runtime_error("Invalid sweep range, expected sweep=start:stop:step in Hz.");
+
+    _sweep_start = boost::lexical_cast< double >( tokens[0] );
+    _sweep_stop = boost::lexical_cast< double >( tokens[1] );
+    _sweep_step = boost::lexical_cast< double >( tokens[2] );
+
+    if ( _sweep_step <= 0 || _sweep_stop < _sweep_start || _sweep_start < 0 )
+      throw std::runtime_error("Invalid sweep range, expected sweep=start:stop:step in Hz.");
+
+    if (dict.count("sweep_blocks"))
+      _sweep_blocks = std::max( 1, std::stoi(dict["sweep_blocks"]) );
+
+    _sweep = true;
+
+    std::cerr << "Sweeping " << _sweep_start / 1e6 << " to " << _sweep_stop / 1e6
+              << " MHz in steps of " << _sweep_step / 1e6 << " MHz, "
+              << _sweep_blocks * BYTES_PER_BLOCK / BYTES_PER_SAMPLE
+              << " samples per step." << std::endl;
+#else
+    throw std::runtime_error("HackRF sweep mode needs libhackrf 0.5 or newer.");
+#endif
   }
 
   if ( BUF_NUM != _buf_num || BUF_LEN != _buf_len ) {
@@ -97,7 +147,8 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
               << std::endl;
   }
 
-  set_center_freq( (get_freq_range().start() + get_freq_range().stop()) / 2.0 );
+  if ( ! _sweep )
+    set_center_freq( (get_freq_range().start() + get_freq_range().stop()) / 2.0 );
   set_sample_rate( get_sample_rates().start() );
   set_bandwidth( 0 );
 
@@ -118,6 +169,11 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
     for(unsigned int i = 0; i < _buf_num; ++i)
       _buf[i] = (unsigned char *) malloc(_buf_len);
   }
+
+#ifdef HACKRF_SWEEP_SUPPORT
+  if (_sweep)
+    _block_freq.assign(_buf_num, std::vector<double>(_buf_len / BYTES_PER_BLOCK, 0));
+#endif
 }
 
 /*
@@ -149,8 +205,13 @@ int hackrf_source_c::hackrf_rx_callback(unsigned char *buf, uint32_t len)
     int buf_tail = (_buf_head + _buf_used) % _buf_num;
     memcpy(_buf[buf_tail], buf, len);
 
+    if (_sweep)
+      parse_sweep_headers(buf_tail, len);
+
     if (_buf_used == _buf_num) {
-      std::cerr << "O" << std::flush;
+      /* the oldest buffer gets overwritten */
+      _stats.overflow(_buf_len / BYTES_PER_SAMPLE);
+      _tagger.discontinuity();
       _buf_head = (_buf_head + 1) % _buf_num;
     } else {
       _buf_used++;
@@ -162,13 +223,74 @@ int hackrf_source_c::hackrf_rx_callback(unsigned char *buf, uint32_t len)
   return 0; // TODO: return -1 on error/stop
 }
 
+void hackrf_source_c::parse_sweep_headers(unsigned int slot, uint32_t len)
+{
+#ifdef HACKRF_SWEEP_SUPPORT
+  unsigned char *block = _buf[slot];
+
+  for (unsigned int i = 0; i < _block_freq[slot].size(); i++, block += BYTES_PER_BLOCK) {
+    _block_freq[slot][i] = 0;
+
+    if ((i + 1) * BYTES_PER_BLOCK > len || block[0] != 0x7f || block[1] != 0x7f)
+      continue;
+
+    uint64_t freq = 0;
+    for (int b = SWEEP_HEADER_LEN - 1; b >= 2; b--)
+      freq = (freq << 8) | block[b];
+
+    /* the radio sits half a step above the reported frequency */
+    _block_freq[slot][i] = double(freq) + std::floor(_sweep_step / 2);
+
+    /* the header samples become silence, this keeps the blocks aligned */
+    memset(block, 0, SWEEP_HEADER_LEN);
+  }
+#endif
+}
+
 bool hackrf_source_c::start()
 {
   if ( ! _dev.get() )
     return false;
 
+  _tagger.set_rate( get_sample_rate() );
+  _tagger.set_freq( _sweep ? _sweep_start + std::floor(_sweep_step / 2)
+                           : get_center_freq() );
+  _tagger.start();
+
   hackrf_common::start();
-  int ret = hackrf_start_rx( _dev.get(), _hackrf_rx_callback, (void *)this );
+
+  if ( _latency_ms ) {
+    double transfer_ms = 1000.0 * _buf_len / BYTES_PER_SAMPLE / get_sample_rate();
+
+    if ( transfer_ms > _latency_ms )
+      std::cerr << "Each transfer takes " << transfer_ms << " ms at this sample rate, "
+                << "latency_ms=" << _latency_ms << " can't be met." << std::endl;
+  }
+
+  int ret;
+#ifdef HACKRF_SWEEP_SUPPORT
+  if ( _sweep ) {
+    if ( _sweep_step > get_sample_rate() )
+      std::cerr << "Sweep step exceeds the sample rate, the spectrum will have gaps."
+                << std::endl;
+
+    /* the firmware takes the range in whole MHz */
+    uint16_t range[2] = { uint16_t(_sweep_start / 1e6),
+                          uint16_t(std::ceil(_sweep_stop / 1e6)) };
+
+    ret = hackrf_init_sweep( _dev.get(), range, 1,
+                             _sweep_blocks * BYTES_PER_BLOCK,
+                             uint32_t(_sweep_step), uint32_t(_sweep_step / 2),
+                             LINEAR );
+    if ( ret != HACKRF_SUCCESS ) {
+      std::cerr << "Failed to set up sweep (" << ret << ")" << std::endl;
+      return false;
+    }
+
+    ret = hackrf_start_rx_sweep( _dev.get(), _hackrf_rx_callback, (void *)this );
+  } else
+#endif
+  ret = hackrf_start_rx( _dev.get(), _hackrf_rx_callback, (void *)this );
   if ( ret != HACKRF_SUCCESS ) {
     std::cerr << "Failed to start RX streaming (" << ret << ")" << std::endl;
     return false;
@@ -194,17 +316,23 @@ int hackrf_source_c::work( int noutput_items,
                         gr_vector_const_void_star &input_items,
                         gr_vector_void_star &output_items )
 {
-  gr_complex *out = (gr_complex *)output_items[0];
+  char *out = (char *)output_items[0];
 
   bool running = false;
 
   if ( _dev.get() )
     running = (hackrf_is_streaming( _dev.get() ) == HACKRF_TRUE);
 
+  /* in low latency mode a single buffer will do, unless the head one has
+   * been used up already */
+  unsigned int wanted = 3; // collect at least 3 buffers
+  if ( _latency_ms )
+    wanted = (_samp_avail > 0) ? 1 : 2;
+
   {
     std::unique_lock<std::mutex> lock(_buf_mutex);
 
-    while (_buf_used < 3 && running) { // collect at least 3 buffers
+    while (_buf_used < wanted && running) {
       _buf_cond.wait_for( lock , std::chrono::milliseconds(100));
 
       // Re-check whether the device has closed or stopped streaming
@@ -213,23 +341,32 @@ int hackrf_source_c::work( int noutput_items,
       else
         running = false;
     }
+
+    // don't run into a buffer that hasn't arrived yet
+    if (_buf_used < 2 && noutput_items > _samp_avail)
+      noutput_items = _samp_avail;
   }
 
   if ( ! running )
     return WORK_DONE;
 
-  const uint8_t *buf = _buf[_buf_head] + _buf_offset * BYTES_PER_SAMPLE;
-#define TO_COMPLEX(p) gr_complex( _lut[(p)[0]], _lut[(p)[1]] )
+  _tagger.tag( nitems_written(0) );
+
+  const int8_t *buf = (const int8_t *)_buf[_buf_head] + _buf_offset * BYTES_PER_SAMPLE;
 
   if (noutput_items <= _samp_avail) {
-    for (int i = 0; i < noutput_items; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+    if (_sweep)
+      tag_sweep( _buf_head, _buf_offset, noutput_items, nitems_written(0) );
+
+    convert( buf, out, noutput_items );
 
     _buf_offset += noutput_items;
     _samp_avail -= noutput_items;
   } else {
-    for (int i = 0; i < _samp_avail; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+    if (_sweep)
+      tag_sweep( _buf_head, _buf_offset, _samp_avail, nitems_written(0) );
+
+    out = convert( buf, out, _samp_avail );
 
     {
       std::lock_guard<std::mutex> lock(_buf_mutex);
@@ -238,12 +375,14 @@ int hackrf_source_c::work( int noutput_items,
       _buf_used--;
     }
 
-    buf = _buf[_buf_head];
+    buf = (const int8_t *)_buf[_buf_head];
 
     int remaining = noutput_items - _samp_avail;
 
-    for (int i = 0; i < remaining; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+    if (_sweep)
+      tag_sweep( _buf_head, 0, remaining, nitems_written(0) + _samp_avail );
+
+    convert( buf, out, remaining );
 
     _buf_offset = remaining;
     _samp_avail = (_buf_len / BYTES_PER_SAMPLE) - remaining;
@@ -252,6 +391,41 @@ int hackrf_source_c::work( int noutput_items,
   return noutput_items;
 }
 
+/* tags the blocks starting within count samples from first in a slot */
+void hackrf_source_c::tag_sweep( unsigned int slot, unsigned int first, int count,
+                                 uint64_t offset )
+{
+#ifdef HACKRF_SWEEP_SUPPORT
+  const unsigned int block_len = BYTES_PER_BLOCK / BYTES_PER_SAMPLE;
+
+  for ( unsigned int s = (first + block_len - 1) / block_len * block_len;
+        s < first + count; s += block_len ) {
+    double freq = _block_freq[slot][s / block_len];
+
+    if ( freq > 0 ) {
+      _tagger.set_freq( freq );
+      _tagger.tag( offset + (s - first) );
+    }
+  }
+#endif
+}
+
+char *hackrf_source_c::convert( const int8_t *in, char *out, int nitems )
+{
+  switch ( _cpu_format ) {
+  case CPU_FORMAT_SC8:
+    memcpy( out, in, nitems * BYTES_PER_SAMPLE );
+    break;
+  case CPU_FORMAT_SC16:
+    convert_s8_sc16( in, (int16_t *)out, nitems );
+    break;
+  default:
+    convert_s8_fc32( in, (gr_complex *)out, nitems );
+  }
+
+  return out + nitems * cpu_format_item_size( _cpu_format );
+}
+
 std::vector<std::string> hackrf_source_c::get_devices()
 {
   return hackrf_common::get_devices();
@@ -269,7 +443,11 @@ osmosdr::meta_range_t hackrf_source_c::get_sample_rates()
 
 double hackrf_source_c::set_sample_rate( double rate )
 {
-  return hackrf_common::set_sample_rate(rate);
+  double actual = hackrf_common::set_sample_rate(rate);
+
+  _tagger.set_rate( actual );
+
+  return actual;
 }
 
 double hackrf_source_c::get_sample_rate()
@@ -284,7 +462,19 @@ osmosdr::freq_range_t hackrf_source_c::get_freq_range( size_t chan )
 
 double hackrf_source_c::set_center_freq( double freq, size_t chan )
 {
-  return hackrf_common::set_center_freq(freq, chan);
+  /* the firmware steps through the sweep range on its own, a retune would
+   * only disturb it */
+  if ( _sweep ) {
+    std::cerr << "Ignoring center frequency " << freq / 1e6 << " MHz "
+              << "while sweeping." << std::endl;
+    return get_center_freq( chan );
+  }
+
+  double actual = hackrf_common::set_center_freq(freq, chan);
+
+  _tagger.set_freq( actual, chan );
+
+  return actual;
 }
 
 double hackrf_source_c::get_center_freq( size_t chan )
@@ -450,3 +640,8 @@ osmosdr::freq_range_t hackrf_source_c::get_bandwidth_range( size_t chan )
 {
   return hackrf_common::get_bandwidth_range(chan);
 }
+
+osmosdr::stream_stats_t hackrf_source_c::get_stream_stats( size_t chan )
+{
+  return _stats.get( chan );
+}
@@ -25,11 +25,15 @@
 
 #include <condition_variable>
 #include <mutex>
+#include <vector>
 
 #include <libhackrf/hackrf.h>
 
 #include "source_iface.h"
 #include "hackrf_common.h"
+#include "arg_helpers.h"
+#include "stream_counters.h"
+#include "rx_tagger.h"
 
 class hackrf_source_c;
 
@@ -119,11 +123,14 @@ public:
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
 private:
   static int _hackrf_rx_callback(hackrf_transfer* transfer);
   int hackrf_rx_callback(unsigned char *buf, uint32_t len);
-
-  std::vector<float> _lut;
+  char *convert(const int8_t *in, char *out, int nitems);
+  void parse_sweep_headers(unsigned int slot, uint32_t len);
+  void tag_sweep(unsigned int slot, unsigned int first, int count, uint64_t offset);
 
   unsigned char **_buf;
   unsigned int _buf_num;
@@ -135,9 +142,25 @@ private:
 
   unsigned int _buf_offset;
   int _samp_avail;
+  stream_counters _stats;
 
   double _lna_gain;
   double _vga_gain;
+
+  cpu_format_t _cpu_format;
+
+  rx_tagger _tagger;
+
+  /* sweep=start:stop:step */
+  bool _sweep;
+  double _sweep_start;
+  double _sweep_stop;
+  double _sweep_step;
+  unsigned int _sweep_blocks;
+  std::vector< std::vector<double> > _block_freq; /* center frequency of each
+                                                     block in _buf, 0 if unknown */
+
+  unsigned int _latency_ms; /* latency_ms=N, 0 collects 3 buffers */
 };
 
 #endif /* INCLUDED_HACKRF_SOURCE_C_H */
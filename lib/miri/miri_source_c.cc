@@ -41,6 +41,7 @@
 #include <mirisdr.h>
 
 #include "arg_helpers.h"
+#include "convert_kernels.h"
 
 using namespace boost::assign;
 
@@ -81,16 +82,21 @@ static const int MAX_OUT = 1;	// maximum number of output streams
 miri_source_c::miri_source_c (const std::string &args)
   : gr::sync_block ("miri_source_c",
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
-        gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+        gr::io_signature::make(MIN_OUT, MAX_OUT,
+          cpu_format_item_size(args_to_cpu_format(args)))),
     _running(true),
     _auto_gain(false),
-    _skipped(0)
+    _skipped(0),
+    _tagger([this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+            gr::sync_block::name())
 {
   int ret;
   unsigned int dev_index = 0;
 
   dict_t dict = params_to_dict(args);
 
+  _cpu_format = args_to_cpu_format(args);
+
   if (dict.count("miri"))
     dev_index = boost::lexical_cast< unsigned int >( dict["miri"] );
 
@@ -140,6 +146,11 @@ miri_source_c::miri_source_c (const std::string &args)
       _buf[i] = (unsigned short *) malloc(BUF_SIZE);
   }
 
+  /* streaming starts right away, the first sample gets tagged */
+  _tagger.set_rate( get_sample_rate() );
+  _tagger.set_freq( get_center_freq() );
+  _tagger.start();
+
   _thread = gr::thread::thread(_mirisdr_wait, this);
 }
 
@@ -192,7 +203,9 @@ void miri_source_c::mirisdr_callback(unsigned char *buf, uint32_t len)
     _buf_lens[buf_tail] = len;
 
     if (_buf_used == _buf_num) {
-      std::cerr << "O" << std::flush;
+      /* the oldest buffer got overwritten */
+      _stats.overflow(len / BYTES_PER_SAMPLE);
+      _tagger.discontinuity();
       _buf_head = (_buf_head + 1) % _buf_num;
     } else {
       _buf_used++;
@@ -223,7 +236,7 @@ int miri_source_c::work( int noutput_items,
                         gr_vector_const_void_star &input_items,
                         gr_vector_void_star &output_items )
 {
-  gr_complex *out = (gr_complex *)output_items[0];
+  char *out = (char *)output_items[0];
 
   {
     std::unique_lock<std::mutex> lock( _buf_mutex );
@@ -235,19 +248,17 @@ int miri_source_c::work( int noutput_items,
   if (!_running)
     return WORK_DONE;
 
+  _tagger.tag( nitems_written(0) );
+
   short *buf = (short *)_buf[_buf_head] + _buf_offset;
 
   if (noutput_items <= _samp_avail) {
-    for (int i = 0; i < noutput_items; i++)
-      *out++ = gr_complex( float(*(buf + i * 2 + 0)) * (1.0f/4096.0f),
-                           float(*(buf + i * 2 + 1)) * (1.0f/4096.0f) );
+    convert( buf, out, noutput_items );
 
     _buf_offset += noutput_items * 2;
     _samp_avail -= noutput_items;
   } else {
-    for (int i = 0; i < _samp_avail; i++)
-      *out++ = gr_complex( float(*(buf + i * 2 + 0)) * (1.0f/4096.0f),
-                           float(*(buf + i * 2 + 1)) * (1.0f/4096.0f) );
+    out = convert( buf, out, _samp_avail );
 
     {
       std::lock_guard<std::mutex> lock( _buf_mutex );
@@ -260,9 +271,7 @@ int miri_source_c::work( int noutput_items,
 
     int remaining = noutput_items - _samp_avail;
 
-    for (int i = 0; i < remaining; i++)
-      *out++ = gr_complex( float(*(buf + i * 2 + 0)) * (1.0f/4096.0f),
-                           float(*(buf + i * 2 + 1)) * (1.0f/4096.0f) );
+    convert( buf, out, remaining );
 
     _buf_offset = remaining * 2;
     _samp_avail = (_buf_lens[_buf_head] / BYTES_PER_SAMPLE) - remaining;
@@ -271,6 +280,23 @@ int miri_source_c::work( int noutput_items,
   return noutput_items;
 }
 
+/* samples are scaled to +/-4096 by libmirisdr */
+char *miri_source_c::convert( const short *in, char *out, int nitems )
+{
+  switch ( _cpu_format ) {
+  case CPU_FORMAT_SC8:
+    convert_s16_sc8( in, (int8_t *)out, nitems, 5 );
+    break;
+  case CPU_FORMAT_SC16:
+    convert_s16_sc16( in, (int16_t *)out, nitems, 3 );
+    break;
+  default:
+    convert_s16_fc32( in, (gr_complex *)out, nitems, 1.0f/4096.0f );
+  }
+
+  return out + nitems * cpu_format_item_size( _cpu_format );
+}
+
 std::vector<std::string> miri_source_c::get_devices()
 {
   std::vector<std::string> devices;
@@ -304,6 +330,8 @@ double miri_source_c::set_sample_rate(double rate)
     mirisdr_set_sample_rate( _dev, (uint32_t)rate );
   }
 
+  _tagger.set_rate( get_sample_rate() );
+
   return get_sample_rate();
 }
 
@@ -333,6 +361,8 @@ double miri_source_c::set_center_freq( double freq, size_t chan )
   if (_dev)
     mirisdr_set_center_freq( _dev, (uint32_t)freq );
 
+  _tagger.set_freq( get_center_freq( chan ), chan );
+
   return get_center_freq( chan );
 }
 
@@ -449,3 +479,8 @@ std::string miri_source_c::get_antenna( size_t chan )
 {
   return "RX";
 }
+
+osmosdr::stream_stats_t miri_source_c::get_stream_stats( size_t chan )
+{
+  return _stats.get( chan );
+}
@@ -28,6 +28,9 @@
 #include <condition_variable>
 
 #include "source_iface.h"
+#include "arg_helpers.h"
+#include "stream_counters.h"
+#include "rx_tagger.h"
 
 class miri_source_c;
 typedef struct mirisdr_dev mirisdr_dev_t;
@@ -97,11 +100,14 @@ private:
   std::string set_antenna( const std::string & antenna, size_t chan = 0 );
   std::string get_antenna( size_t chan = 0 );
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
 private:
   static void _mirisdr_callback(unsigned char *buf, uint32_t len, void *ctx);
   void mirisdr_callback(unsigned char *buf, uint32_t len);
   static void _mirisdr_wait(miri_source_c *obj);
   void mirisdr_wait();
+  char *convert(const short *in, char *out, int nitems);
 
   mirisdr_dev_t *_dev;
   gr::thread::thread _thread;
@@ -116,9 +122,14 @@ private:
 
   unsigned int _buf_offset;
   int _samp_avail;
+  stream_counters _stats;
 
   bool _auto_gain;
   unsigned int _skipped;
+
+  cpu_format_t _cpu_format;
+
+  rx_tagger _tagger;
 };
 
 #endif /* INCLUDED_MIRI_SOURCE_C_H */
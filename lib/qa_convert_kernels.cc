@@ -0,0 +1,361 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Checks every kernel variant the host CPU supports against the generic
+ * one, on full scale values, odd lengths and tails shorter than a vector.
+ * The kernels are static, so they are built into the test directly.
+ */
+#include "convert_kernels.cc"
+
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+static int failures = 0;
+
+#define CHECK( cond, what, arch, n ) \
+  do { \
+    if ( ! (cond) ) { \
+      fprintf( stderr, "FAIL %s %s nitems=%zu: %s\n", what, arch, n, #cond ); \
+      failures++; \
+    } \
+  } while ( 0 )
+
+/* lengths in IQ pairs: empty, shorter than, around and past every vector */
+static std::vector< size_t > lengths()
+{
+  std::vector< size_t > n;
+
+  for (size_t i = 0; i <= 70; i++)
+    n.push_back( i );
+
+  n.push_back( 127 );
+  n.push_back( 128 );
+  n.push_back( 129 );
+  n.push_back( 1021 );
+
+  return n;
+}
+
+/* full scale values first, then a pseudo random pattern */
+template < typename T >
+static std::vector< T > edge_values( size_t n )
+{
+  const T edges[] = { std::numeric_limits< T >::min(),
+                      std::numeric_limits< T >::max(),
+                      T(0), T(1), T(-1),
+                      T(std::numeric_limits< T >::min() + 1),
+                      T(std::numeric_limits< T >::max() - 1) };
+  std::vector< T > v( n );
+  uint32_t x = 12345;
+
+  for (size_t i = 0; i < n; i++) {
+    x = x * 1103515245 + 12345;
+    v[i] = i < sizeof(edges) / sizeof(edges[0]) ? edges[i] : T(x >> 16);
+  }
+
+  return v;
+}
+
+/* the same as bytes, so that packed words take all edge bit patterns */
+static std::vector< uint8_t > edge_bytes( size_t n )
+{
+  const uint8_t edges[] = { 0x00, 0x00, 0x80,  0xff, 0xff, 0x7f,
+                            0x00, 0x08, 0x80,  0xff, 0xf7, 0x7f,
+                            0x01, 0x00, 0x00,  0xff, 0xff, 0xff };
+  std::vector< uint8_t > v( n );
+  uint32_t x = 54321;
+
+  for (size_t i = 0; i < n; i++) {
+    x = x * 1103515245 + 12345;
+    v[i] = i < sizeof(edges) ? edges[i] : uint8_t(x >> 16);
+  }
+
+  return v;
+}
+
+/* at and beyond full scale, halfway cases and a pseudo random pattern */
+static std::vector< float > edge_floats( size_t n )
+{
+  const float edges[] = { 1.0f, -1.0f, 1.5f, -1.5f, 0.0f, -0.0f,
+                          1e9f, -1e9f, 0.99999f, -0.99999f,
+                          0.5f / 32767.0f, 1.5f / 32767.0f,
+                          -2.5f / 127.0f, 2.5f / 127.0f };
+  std::vector< float > v( n );
+  uint32_t x = 999;
+
+  for (size_t i = 0; i < n; i++) {
+    x = x * 1103515245 + 12345;
+    v[i] = i < sizeof(edges) / sizeof(edges[0]) ? edges[i] :
+           (float(x >> 8) / float(1 << 23) - 1.0f) * 1.2f;
+  }
+
+  return v;
+}
+
+/* a scaled integer converts exactly, but allow for a different rounding */
+static bool same( const std::vector< float > &a, const std::vector< float > &b )
+{
+  if ( a.size() != b.size() )
+    return false;
+
+  for (size_t i = 0; i < a.size(); i++)
+    if ( std::fabs( a[i] - b[i] ) > 1e-6f * std::max( 1.0f, std::fabs( b[i] ) ) )
+      return false;
+
+  return true;
+}
+
+/*
+ * The outputs are one element larger than needed and must keep their last
+ * element, the inputs are exactly as large as the kernels may read. The
+ * input is offset by one element, so vector loads are unaligned.
+ */
+static void check_variant( const convert_kernels_t &k, const convert_kernels_t &ref )
+{
+  const float canary = 12345.0f;
+
+  for (size_t n : lengths()) {
+    /* (u8|s8|s16) -> fc32 work on 2 * n values */
+    {
+      std::vector< uint8_t > in = edge_bytes( n * 2 + 1 );
+      std::vector< float > out( n * 2 + 1, canary ), exp( n * 2 + 1, canary );
+
+      k.u8( in.data() + 1, out.data(), n * 2, 127.4f, 1.0f/128.0f );
+      ref.u8( in.data() + 1, exp.data(), n * 2, 127.4f, 1.0f/128.0f );
+      CHECK( same( out, exp ), "u8_fc32", k.arch, n );
+    }
+    {
+      std::vector< int8_t > in = edge_values< int8_t >( n * 2 + 1 );
+      std::vector< float > out( n * 2 + 1, canary ), exp( n * 2 + 1, canary );
+
+      k.s8( in.data() + 1, out.data(), n * 2, 1.0f/128.0f );
+      ref.s8( in.data() + 1, exp.data(), n * 2, 1.0f/128.0f );
+      CHECK( same( out, exp ), "s8_fc32", k.arch, n );
+    }
+    {
+      std::vector< int16_t > in = edge_values< int16_t >( n * 2 + 1 );
+      std::vector< float > out( n * 2 + 1, canary ), exp( n * 2 + 1, canary );
+
+      k.s16( in.data() + 1, out.data(), n * 2, 1.0f/32768.0f );
+      ref.s16( in.data() + 1, exp.data(), n * 2, 1.0f/32768.0f );
+      CHECK( same( out, exp ), "s16_fc32", k.arch, n );
+    }
+    {
+      std::vector< uint8_t > in = edge_bytes( n * 3 + 1 );
+      std::vector< float > out( n * 2 + 1, canary ), exp( n * 2 + 1, canary );
+
+      k.s12p( in.data() + 1, out.data(), n, 1.0f/2048.0f );
+      ref.s12p( in.data() + 1, exp.data(), n, 1.0f/2048.0f );
+      CHECK( same( out, exp ), "s12p_fc32", k.arch, n );
+    }
+    {
+      std::vector< uint8_t > in = edge_bytes( n * 6 + 1 );
+      std::vector< float > out( n * 2 + 1, canary ), exp( n * 2 + 1, canary );
+
+      k.s24( in.data() + 1, out.data(), n, 1.0f/8388608.0f );
+      ref.s24( in.data() + 1, exp.data(), n, 1.0f/8388608.0f );
+      CHECK( same( out, exp ), "s24_fc32", k.arch, n );
+    }
+
+    /* two channel inputs, n pairs per channel */
+    {
+      std::vector< int16_t > in = edge_values< int16_t >( n * 4 + 1 );
+      std::vector< float > out0( n * 2 + 1, canary ), out1( n * 2 + 1, canary );
+      std::vector< float > exp0( n * 2 + 1, canary ), exp1( n * 2 + 1, canary );
+
+      k.s16x2( in.data() + 1, out0.data(), out1.data(), n, 1.0f/32768.0f );
+      ref.s16x2( in.data() + 1, exp0.data(), exp1.data(), n, 1.0f/32768.0f );
+      CHECK( same( out0, exp0 ) && same( out1, exp1 ), "s16_fc32_x2", k.arch, n );
+    }
+    {
+      std::vector< int8_t > in = edge_values< int8_t >( n * 4 + 1 );
+      std::vector< float > out0( n * 2 + 1, canary ), out1( n * 2 + 1, canary );
+      std::vector< float > exp0( n * 2 + 1, canary ), exp1( n * 2 + 1, canary );
+
+      k.s8x2( in.data() + 1, out0.data(), out1.data(), n, 1.0f/128.0f );
+      ref.s8x2( in.data() + 1, exp0.data(), exp1.data(), n, 1.0f/128.0f );
+      CHECK( same( out0, exp0 ) && same( out1, exp1 ), "s8_fc32_x2", k.arch, n );
+    }
+    {
+      std::vector< uint8_t > in = edge_bytes( n * 12 + 1 );
+      std::vector< float > out0( n * 2 + 1, canary ), out1( n * 2 + 1, canary );
+      std::vector< float > exp0( n * 2 + 1, canary ), exp1( n * 2 + 1, canary );
+
+      k.s24x2( in.data() + 1, out0.data(), out1.data(), n, 1.0f/8388608.0f );
+      ref.s24x2( in.data() + 1, exp0.data(), exp1.data(), n, 1.0f/8388608.0f );
+      CHECK( same( out0, exp0 ) && same( out1, exp1 ), "s24_fc32_x2", k.arch, n );
+    }
+
+    /* transmit side, the results are rounded and saturated integers */
+    {
+      std::vector< float > in = edge_floats( n * 2 + 1 );
+      std::vector< int16_t > out( n * 2 + 1, 0x5a5a ), exp( n * 2 + 1, 0x5a5a );
+
+      k.to_s16( in.data() + 1, out.data(), n * 2, 32767.0f );
+      ref.to_s16( in.data() + 1, exp.data(), n * 2, 32767.0f );
+      CHECK( out == exp, "fc32_s16", k.arch, n );
+    }
+    {
+      std::vector< float > in = edge_floats( n * 2 + 1 );
+      std::vector< int8_t > out( n * 2 + 1, 0x5a ), exp( n * 2 + 1, 0x5a );
+
+      k.to_s8( in.data() + 1, out.data(), n * 2, 127.0f );
+      ref.to_s8( in.data() + 1, exp.data(), n * 2, 127.0f );
+      CHECK( out == exp, "fc32_s8", k.arch, n );
+    }
+    {
+      std::vector< float > in0 = edge_floats( n * 2 + 1 );
+      std::vector< float > in1( in0.rbegin(), in0.rend() );
+      std::vector< int16_t > out( n * 4 + 1, 0x5a5a ), exp( n * 4 + 1, 0x5a5a );
+
+      k.to_s16x2( in0.data() + 1, in1.data() + 1, out.data(), n, 32767.0f );
+      ref.to_s16x2( in0.data() + 1, in1.data() + 1, exp.data(), n, 32767.0f );
+      CHECK( out == exp, "fc32_s16_x2", k.arch, n );
+    }
+    {
+      std::vector< float > in0 = edge_floats( n * 2 + 1 );
+      std::vector< float > in1( in0.rbegin(), in0.rend() );
+      std::vector< int8_t > out( n * 4 + 1, 0x5a ), exp( n * 4 + 1, 0x5a );
+
+      k.to_s8x2( in0.data() + 1, in1.data() + 1, out.data(), n, 127.0f );
+      ref.to_s8x2( in0.data() + 1, in1.data() + 1, exp.data(), n, 127.0f );
+      CHECK( out == exp, "fc32_s8_x2", k.arch, n );
+    }
+  }
+}
+
+/* saturating arithmetic shift, the reference for the rescaling kernels */
+static int16_t ref_sc16( int v, int shift )
+{
+  return int16_t( std::min( std::max( v * (1 << shift), -32768 ), 32767 ) );
+}
+
+static int8_t ref_sc8( int v, int shift )
+{
+  return int8_t( std::min( std::max( int( std::floor( double(v) / (1 << shift) ) ),
+                                     -128 ), 127 ) );
+}
+
+/* the integer outputs are not dispatched, check them against their spec */
+static void check_integer()
+{
+  for (size_t n : lengths()) {
+    std::vector< uint8_t > u8 = edge_bytes( n * 4 );
+    std::vector< int8_t > s8 = edge_values< int8_t >( n * 4 );
+    std::vector< int16_t > s16 = edge_values< int16_t >( n * 4 );
+
+    {
+      std::vector< int8_t > out( n * 2 );
+      std::vector< int16_t > out16( n * 2 );
+      bool ok8 = true, ok16 = true;
+
+      convert_u8_sc8( u8.data(), out.data(), n );
+      convert_u8_sc16( u8.data(), out16.data(), n );
+
+      for (size_t i = 0; i < n * 2; i++) {
+        ok8 &= out[i] == int8_t( int(u8[i]) - 128 );
+        ok16 &= out16[i] == int16_t( (int(u8[i]) - 128) * 256 );
+      }
+
+      CHECK( ok8, "u8_sc8", "scalar", n );
+      CHECK( ok16, "u8_sc16", "scalar", n );
+    }
+    {
+      std::vector< int16_t > out( n * 2 );
+      std::vector< int16_t > out0( n * 2 ), out1( n * 2 );
+      std::vector< int8_t > x0( n * 2 ), x1( n * 2 );
+      bool ok = true, ok_x2 = true, ok_sc8_x2 = true;
+
+      convert_s8_sc16( s8.data(), out.data(), n );
+      convert_s8_sc16_x2( s8.data(), out0.data(), out1.data(), n );
+      convert_s8_sc8_x2( s8.data(), x0.data(), x1.data(), n );
+
+      for (size_t i = 0; i < n * 2; i++)
+        ok &= out[i] == int16_t( s8[i] * 256 );
+
+      for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < 2; j++) {
+          ok_x2 &= out0[i * 2 + j] == int16_t( s8[i * 4 + j] * 256 );
+          ok_x2 &= out1[i * 2 + j] == int16_t( s8[i * 4 + 2 + j] * 256 );
+          ok_sc8_x2 &= x0[i * 2 + j] == s8[i * 4 + j];
+          ok_sc8_x2 &= x1[i * 2 + j] == s8[i * 4 + 2 + j];
+        }
+      }
+
+      CHECK( ok, "s8_sc16", "scalar", n );
+      CHECK( ok_x2, "s8_sc16_x2", "scalar", n );
+      CHECK( ok_sc8_x2, "s8_sc8_x2", "scalar", n );
+    }
+
+    for (int shift : { 0, 4, 8 }) {
+      std::vector< int16_t > out16( n * 2 ), a16( n * 2 ), b16( n * 2 );
+      std::vector< int8_t > out8( n * 2 ), a8( n * 2 ), b8( n * 2 );
+      bool ok16 = true, ok8 = true, ok16_x2 = true, ok8_x2 = true;
+
+      convert_s16_sc16( s16.data(), out16.data(), n, shift );
+      convert_s16_sc8( s16.data(), out8.data(), n, shift );
+      convert_s16_sc16_x2( s16.data(), a16.data(), b16.data(), n, shift );
+      convert_s16_sc8_x2( s16.data(), a8.data(), b8.data(), n, shift );
+
+      for (size_t i = 0; i < n * 2; i++) {
+        ok16 &= out16[i] == ref_sc16( s16[i], shift );
+        ok8 &= out8[i] == ref_sc8( s16[i], shift );
+      }
+
+      for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < 2; j++) {
+          ok16_x2 &= a16[i * 2 + j] == ref_sc16( s16[i * 4 + j], shift );
+          ok16_x2 &= b16[i * 2 + j] == ref_sc16( s16[i * 4 + 2 + j], shift );
+          ok8_x2 &= a8[i * 2 + j] == ref_sc8( s16[i * 4 + j], shift );
+          ok8_x2 &= b8[i * 2 + j] == ref_sc8( s16[i * 4 + 2 + j], shift );
+        }
+      }
+
+      CHECK( ok16, "s16_sc16", "scalar", n );
+      CHECK( ok8, "s16_sc8", "scalar", n );
+      CHECK( ok16_x2, "s16_sc16_x2", "scalar", n );
+      CHECK( ok8_x2, "s16_sc8_x2", "scalar", n );
+    }
+  }
+}
+
+int main()
+{
+  std::vector< convert_kernels_t > variants = usable_kernels();
+  const convert_kernels_t &generic = variants.back();
+
+  for (const convert_kernels_t &k : variants) {
+    printf( "checking %s kernels\n", k.arch );
+    check_variant( k, generic );
+  }
+
+  check_integer();
+
+  if ( failures ) {
+    fprintf( stderr, "%d checks failed\n", failures );
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
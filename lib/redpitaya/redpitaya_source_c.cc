@@ -44,7 +44,9 @@ redpitaya_source_c_sptr make_redpitaya_source_c(const std::string &args)
 redpitaya_source_c::redpitaya_source_c(const std::string &args) :
   gr::sync_block("redpitaya_source_c",
                  gr::io_signature::make(0, 0, 0),
-                 gr::io_signature::make(1, 1, sizeof(gr_complex)))
+                 gr::io_signature::make(1, 1, sizeof(gr_complex))),
+  _tagger([this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+          gr::sync_block::name())
 {
   std::string host = "192.168.1.100";
   std::stringstream message;
@@ -100,6 +102,11 @@ redpitaya_source_c::redpitaya_source_c(const std::string &args) :
     command = i;
     redpitaya_send_command( _sockets[i], command );
   }
+
+  /* samples are flowing as soon as the data socket is connected */
+  _tagger.set_rate( _rate );
+  _tagger.set_freq( _freq );
+  _tagger.start();
 }
 
 redpitaya_source_c::~redpitaya_source_c()
@@ -120,6 +127,8 @@ int redpitaya_source_c::work( int noutput_items,
 {
   gr_complex *out = (gr_complex *)output_items[0];
 
+  _tagger.tag( nitems_written(0) );
+
 #if defined(_WIN32)
   int size;
   int total = sizeof(gr_complex) * noutput_items;
@@ -190,6 +199,7 @@ double redpitaya_source_c::set_sample_rate( double rate )
   redpitaya_send_command( _sockets[0], command );
 
   _rate = rate;
+  _tagger.set_rate( _rate );
 
   return get_sample_rate();
 }
@@ -215,6 +225,7 @@ double redpitaya_source_c::set_center_freq( double freq, size_t chan )
   redpitaya_send_command( _sockets[0], command );
 
   _freq = freq;
+  _tagger.set_freq( _freq, chan );
 
   return get_center_freq( chan );
 }
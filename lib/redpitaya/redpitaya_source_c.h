@@ -24,6 +24,7 @@
 #include <gnuradio/sync_block.h>
 
 #include "source_iface.h"
+#include "rx_tagger.h"
 
 #include "redpitaya_common.h"
 
@@ -80,6 +81,8 @@ public:
 private:
   double _freq, _rate, _corr;
   SOCKET _sockets[2];
+
+  rx_tagger _tagger;
 };
 
 #endif // REDPITAYA_SOURCE_C_H
@@ -56,6 +56,7 @@
 #include <gnuradio/io_signature.h>
 
 #include "arg_helpers.h"
+#include "convert_kernels.h"
 #include "rfspace_source_c.h"
 
 using namespace boost::assign;
@@ -63,6 +64,35 @@ using namespace boost::assign;
 #define DEFAULT_HOST  "127.0.0.1" /* We assume a running "siqs" from CuteSDR project */
 #define DEFAULT_PORT  50000
 
+/* largest data packet is 1444 bytes (NETSDR 24 bit, 240 IQ pairs) */
+#define RX_PACKET_SIZE  2048
+
+/* maximum number of UDP datagrams drained per receive call */
+#define RX_BATCH        64
+
+#ifdef HAVE_RECVMMSG
+#define RX_CALL         "recvmmsg"
+#else
+#define RX_CALL         "recvfrom"
+#endif
+
+/* after this many packets in a row that seem to be from the past, the
+ * radio's sequence counter is taken as it is, e.g. after a long outage */
+#define RX_RESYNC_REJECTS 8
+
+/* let the kernel queue a few hundred ms worth of datagrams at 2 MS/s */
+#define RX_SOCKBUF_SIZE (4 * 1024 * 1024)
+
+#define HEADER_SIZE 2
+#define SEQNUM_SIZE 2
+
+#define SCALE_16  (1.0f/32768.0f)
+#define SCALE_24  (1.0f/8388608.0f)
+
+/* marks the first sample after a gap, the value is the number of samples
+ * inserted in place of lost packets */
+static const pmt::pmt_t LOST_KEY = pmt::string_to_symbol("rx_lost");
+
 /*
  * Create a new instance of rfspace_source_c and return
  * a boost shared_ptr.  This is effectively the public constructor.
@@ -79,12 +109,10 @@ rfspace_source_c_sptr make_rfspace_source_c (const std::string &args)
  * output signatures are used by the runtime system to
  * check that a valid number and type of inputs and outputs
  * are connected to this block.  In this case, we accept
- * only 0 input and 1 output.
+ * only 0 input and one output per channel.
  */
 static const int MIN_IN = 0;	// mininum number of input streams
 static const int MAX_IN = 0;	// maximum number of input streams
-static const int MIN_OUT = 1;	// minimum number of output streams
-static const int MAX_OUT = 1;	// maximum number of output streams
 
 /*
  * The private constructor
@@ -92,7 +120,7 @@ static const int MAX_OUT = 1;	// maximum number of output streams
 rfspace_source_c::rfspace_source_c (const std::string &args)
   : gr::sync_block ("rfspace_source_c",
                     gr::io_signature::make (MIN_IN, MAX_IN, sizeof (gr_complex)),
-                    gr::io_signature::make (MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+                    args_to_io_signature(args)),
     _radio(RADIO_UNKNOWN),
     _tcp(-1),
     _udp(-1),
@@ -100,10 +128,20 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
     _running(false),
     _keep_running(false),
     _sequence(0),
+    _have_sequence(false),
+    _rejected(0),
+    _24_bit_mode(false),
+    _gap_hold(false),
+    _stats(2), /* nchan is at most 2 */
+    _tagger([this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+            gr::sync_block::name(), args_to_io_signature(args)->max_streams()),
     _nchan(1),
     _sample_rate(NAN),
     _bandwidth(0.0f),
-    _fifo(NULL)
+    _fifo(NULL),
+    _pkt_count(0),
+    _pkt_next(0),
+    _pkt_offset(0)
 {
   std::string host = "";
   unsigned short port = 0;
@@ -173,6 +211,26 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
   if ( _nchan < 1 || _nchan > 2 )
     throw std::runtime_error("Number of channels (nchan) must be 1 or 2");
 
+  if ( dict.count("bits") )
+  {
+    int bits = boost::lexical_cast< int >( dict["bits"] );
+
+    if ( bits != 16 && bits != 24 )
+      throw std::runtime_error("Sample resolution (bits) must be 16 or 24");
+
+    _24_bit_mode = (24 == bits);
+  }
+
+  if ( dict.count("gap_fill") )
+  {
+    std::string fill = dict["gap_fill"];
+
+    if ( "zero" != fill && "hold" != fill )
+      throw std::runtime_error("Gap fill mode (gap_fill) must be zero or hold");
+
+    _gap_hold = ("hold" == fill);
+  }
+
   if ( ! host.length() )
     host = DEFAULT_HOST;
 
@@ -216,6 +274,9 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
 
     _radio = RFSPACE_SDR_IQ; /* legitimate assumption */
 
+    if ( _24_bit_mode )
+      throw std::runtime_error("SDR-IQ does not support 24 bit samples");
+
     _fifo = new boost::circular_buffer<gr_complex>( 200000 );
     if ( ! _fifo )
       throw std::runtime_error( "Failed to allocate sample FIFO" );
@@ -306,6 +367,32 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
       throw std::runtime_error("Bind of UDP socket failed: " + std::string(strerror(errno)));
     }
 
+    /* datagrams arriving while work() is busy are lost otherwise */
+    sockoptval = RX_SOCKBUF_SIZE;
+    setsockopt(_udp, SOL_SOCKET, SO_RCVBUF, &sockoptval, sizeof(int));
+
+    /* preallocate the packet arena for batched receives */
+    _arena.resize( RX_BATCH * RX_PACKET_SIZE );
+    _pkt_bytes.resize( RX_BATCH );
+    _pkt_addr.resize( RX_BATCH );
+    _pkts.resize( RX_BATCH );
+#ifdef HAVE_RECVMMSG
+    _msgs.resize( RX_BATCH );
+    _iovs.resize( RX_BATCH );
+
+    for ( size_t i = 0; i < RX_BATCH; i++ )
+    {
+      _iovs[i].iov_base = &_arena[i * RX_PACKET_SIZE];
+      _iovs[i].iov_len = RX_PACKET_SIZE;
+
+      memset( &_msgs[i], 0, sizeof(_msgs[i]) );
+      _msgs[i].msg_hdr.msg_iov = &_iovs[i];
+      _msgs[i].msg_hdr.msg_iovlen = 1;
+      _msgs[i].msg_hdr.msg_name = &_pkt_addr[i];
+      _msgs[i].msg_hdr.msg_namelen = sizeof(_pkt_addr[i]);
+    }
+#endif
+
   }
 
   /* Wait 10 ms before sending queries to device (required for networked radios). */
@@ -668,8 +755,6 @@ void rfspace_source_c::usb_read_task()
       n_avail = _fifo->capacity() - _fifo->size();
       to_copy = (n_avail < num_samples ? n_avail : num_samples);
 
-      #define SCALE_16  (1.0f/32768.0f)
-
       int16_t *sample = (int16_t *)(data + 2);
 
       for ( size_t i = 0; i < to_copy; i++ )
@@ -682,8 +767,6 @@ void rfspace_source_c::usb_read_task()
         sample += 2;
       }
 
-      #undef SCALE_16
-
       _fifo_lock.unlock();
 
       /* We have made some new samples available to the consumer in work() */
@@ -692,9 +775,10 @@ void rfspace_source_c::usb_read_task()
         _samp_avail.notify_one();
       }
 
-      /* Indicate overrun, if neccesary */
-      if (to_copy < num_samples)
-        std::cerr << "O" << std::flush;
+      if (to_copy < num_samples) {
+        _stats.overflow( num_samples - to_copy );
+        _tagger.discontinuity();
+      }
     }
     else
     {
@@ -732,6 +816,18 @@ void rfspace_source_c::tcp_keepalive_task()
 bool rfspace_source_c::start()
 {
   _sequence = 0;
+  _have_sequence = false;
+  _rejected = 0;
+
+  /* forget about packets left over from the previous run */
+  _pkt_count = _pkt_next = _pkt_offset = 0;
+  _last[0] = _last[1] = gr_complex(0, 0);
+
+  _tagger.set_rate( get_sample_rate() );
+  for ( size_t chan = 0; chan < _nchan; chan++ )
+    _tagger.set_freq( get_center_freq( chan ), chan );
+  _tagger.start();
+
   _running = true;
   _keep_running = false;
 
@@ -745,7 +841,7 @@ bool rfspace_source_c::start()
 
   unsigned char mode = 0; /* 0 = 16 bit Contiguous Mode */
 
-  if ( 0 ) /* TODO: 24 bit Contiguous mode */
+  if ( _24_bit_mode ) /* 24 bit Contiguous mode */
     mode |= 0x80;
 
   if ( 0 ) /* TODO: Hardware Triggered Pulse mode */
@@ -781,8 +877,6 @@ int rfspace_source_c::work( int noutput_items,
                            gr_vector_const_void_star &input_items,
                            gr_vector_void_star &output_items )
 {
-  unsigned char data[1024*2];
-
   if ( ! _running )
     return WORK_DONE;
 
@@ -792,6 +886,8 @@ int rfspace_source_c::work( int noutput_items,
     {
       gr_complex *out = (gr_complex *)output_items[0];
 
+      _tagger.tag( nitems_written(0) );
+
       std::unique_lock<std::mutex> lock(_fifo_lock);
 
       /* Wait until we have the requested number of samples */
@@ -815,88 +911,240 @@ int rfspace_source_c::work( int noutput_items,
     return noutput_items;
   }
 
-  struct sockaddr_in sa_in;           /* remote address */
-  socklen_t addrlen = sizeof(sa_in);  /* length of addresses */
-  ssize_t rx_bytes = recvfrom(_udp, data, sizeof(data), 0, (struct sockaddr *)&sa_in, &addrlen);
-  if ( rx_bytes <= 0 )
+  /* all packets of the previous batch delivered, fetch the next one */
+  if ( _pkt_next == _pkt_count )
   {
-    std::cerr << "recvfrom returned " << rx_bytes << std::endl;
-    return WORK_DONE;
+    int count = receive_packets();
+    if ( count <= 0 )
+    {
+      std::cerr << RX_CALL " failed: "
+                << ( count < 0 ? strerror(errno) : "empty datagram" ) << std::endl;
+      return WORK_DONE;
+    }
+
+    parse_packets( count );
   }
 
-  #define HEADER_SIZE 2
-  #define SEQNUM_SIZE 2
+  gr_complex *out0 = (gr_complex *)output_items[0];
+  gr_complex *out1 = _nchan > 1 ? (gr_complex *)output_items[1] : NULL;
+  int produced = 0;
 
-//  bool is_24_bit = false;   // TODO: implement 24 bit sample format
+  /* lost packets are filled in, so time only jumps on start, retune and
+   * after a resync */
+  _tagger.tag( nitems_written(0) );
 
-  /* check header */
-  if ( (0x04 == data[0] && (0x84 == data[1] || 0x82 == data[1])) )
+  while ( produced < noutput_items && _pkt_next < _pkt_count )
   {
-//    is_24_bit = false;
-  }
-  else if ( (0xA4 == data[0] && 0x85 == data[1]) ||
-            (0x84 == data[0] && 0x81 == data[1]) )
-  {
-//    is_24_bit = true;
-    return 0;
-  }
-  else
-    return 0;
+    const packet_t &pkt = _pkts[_pkt_next];
+
+    /* the timeline breaks, time is taken anew from here */
+    if ( pkt.resync && 0 == _pkt_offset )
+    {
+      _tagger.discontinuity();
+      _tagger.tag( nitems_written(0) + produced );
+    }
 
-  uint16_t sequence = *((uint16_t *)(data + HEADER_SIZE));
+    if ( _pkt_offset < pkt.gap )
+    {
+      /* stand in for the samples of lost packets to keep the timeline */
+      size_t nitems = std::min( pkt.gap - _pkt_offset,
+                                size_t(noutput_items - produced) );
 
-  uint16_t diff = sequence - _sequence;
+      for ( size_t chan = 0; chan < _nchan; chan++ )
+      {
+        gr_complex *out = (gr_complex *)output_items[chan] + produced;
 
-  if ( diff > 1 )
-  {
-    std::cerr << "Lost " << diff << " packets from "
-              << inet_ntoa(sa_in.sin_addr) << ":" << ntohs(sa_in.sin_port)
-              << std::endl;
-  }
+        if ( 0 == _pkt_offset )
+          add_item_tag( chan, nitems_written(0) + produced, LOST_KEY,
+                        pmt::from_uint64( pkt.gap ), alias_pmt() );
 
-  _sequence = (0xffff == sequence) ? 0 : sequence;
+        std::fill( out, out + nitems, _last[chan] );
+      }
 
-  /* get pointer to samples */
-  int16_t *sample = (int16_t *)(data + HEADER_SIZE + SEQNUM_SIZE);
+      produced += nitems;
+      _pkt_offset += nitems;
 
-  size_t rx_samples = (rx_bytes - HEADER_SIZE - SEQNUM_SIZE) / (sizeof(int16_t) * 2);
+      continue;
+    }
 
-  #define SCALE_16  (1.0f/32768.0f)
+    size_t offset = _pkt_offset - pkt.gap;
+    size_t nitems = std::min( pkt.nitems - offset,
+                              size_t(noutput_items - produced) );
 
-  if ( 1 == _nchan )
-  {
-    gr_complex *out = (gr_complex *)output_items[0];
-    for ( size_t i = 0; i < rx_samples; i++ )
+    if ( pkt.is_24_bit )
     {
-      out[i] = gr_complex( *(sample+0) * SCALE_16,
-                           *(sample+1) * SCALE_16 );
+      const unsigned char *in = pkt.payload + offset * 2 * _nchan * 3;
 
-      sample += 2;
+      if ( 1 == _nchan )
+        convert_s24_fc32( in, out0 + produced, nitems, SCALE_24 );
+      else
+        convert_s24_fc32_x2( in, out0 + produced, out1 + produced,
+                             nitems, SCALE_24 );
+    }
+    else
+    {
+      const int16_t *in = (const int16_t *)pkt.payload + offset * 2 * _nchan;
+
+      if ( 1 == _nchan )
+        convert_s16_fc32( in, out0 + produced, nitems, SCALE_16 );
+      else
+        convert_s16_fc32_x2( in, out0 + produced, out1 + produced,
+                             nitems, SCALE_16 );
     }
+
+    produced += nitems;
+    _pkt_offset += nitems;
+
+    if ( _gap_hold && nitems )
+    {
+      _last[0] = out0[produced - 1];
+      if ( out1 )
+        _last[1] = out1[produced - 1];
+    }
+
+    if ( _pkt_offset == pkt.gap + pkt.nitems )
+    {
+      _pkt_next++;
+      _pkt_offset = 0;
+    }
+  }
+
+  return produced;
+}
+
+/*
+ * Drains up to RX_BATCH datagrams from the UDP socket into the packet
+ * arena, blocking until at least one is available.
+ */
+int rfspace_source_c::receive_packets()
+{
+#ifdef HAVE_RECVMMSG
+  for ( size_t i = 0; i < RX_BATCH; i++ )
+    _msgs[i].msg_hdr.msg_namelen = sizeof(_pkt_addr[i]);
+
+  int count;
+
+  do {
+    count = recvmmsg( _udp, _msgs.data(), RX_BATCH, MSG_WAITFORONE, NULL );
+  } while ( count < 0 && EINTR == errno );
+
+  for ( int i = 0; i < count; i++ )
+    _pkt_bytes[i] = _msgs[i].msg_len;
+
+  return count;
+#else
+  int count = 0;
+
+  for ( ; count < RX_BATCH; count++ )
+  {
+    socklen_t addrlen = sizeof(_pkt_addr[count]);
+
+    ssize_t rx_bytes;
+
+    do {
+      rx_bytes = recvfrom( _udp, &_arena[count * RX_PACKET_SIZE],
+                           RX_PACKET_SIZE, count ? MSG_DONTWAIT : 0,
+                           (struct sockaddr *)&_pkt_addr[count], &addrlen );
+    } while ( rx_bytes < 0 && EINTR == errno );
+
+    /* only the blocking first call reports an error */
+    if ( rx_bytes < 0 && 0 == count )
+      return -1;
+
+    if ( rx_bytes <= 0 )
+      break;
+
+    _pkt_bytes[count] = rx_bytes;
   }
-  else if ( 2 == _nchan )
+
+  return count;
+#endif
+}
+
+/* validates headers and sequence numbers of a freshly received batch */
+void rfspace_source_c::parse_packets( int count )
+{
+  for ( int i = 0; i < count; i++ )
   {
-    rx_samples /= 2;
+    const unsigned char *data = &_arena[i * RX_PACKET_SIZE];
+    size_t rx_bytes = _pkt_bytes[i];
+    packet_t &pkt = _pkts[i];
+
+    pkt.payload = data + HEADER_SIZE + SEQNUM_SIZE;
+    pkt.nitems = 0;
+    pkt.gap = 0;
+    pkt.resync = false;
+    pkt.is_24_bit = false;
+
+    if ( rx_bytes < HEADER_SIZE + SEQNUM_SIZE )
+      continue;
+
+    /* check header */
+    if ( (0x04 == data[0] && (0x84 == data[1] || 0x82 == data[1])) )
+    {
+      pkt.is_24_bit = false;
+    }
+    else if ( (0xA4 == data[0] && 0x85 == data[1]) ||
+              (0x84 == data[0] && 0x81 == data[1]) )
+    {
+      pkt.is_24_bit = true;
+    }
+    else
+      continue;
+
+    /* the length field has to match what we actually received */
+    size_t length = data[0] | ((data[1] & 0x1f) << 8);
+    if ( length != rx_bytes )
+      continue;
+
+    uint16_t sequence = *((uint16_t *)(data + HEADER_SIZE));
+
+    uint16_t diff = _have_sequence ? uint16_t(sequence - _sequence) : 1;
 
-    gr_complex *out1 = (gr_complex *)output_items[0];
-    gr_complex *out2 = (gr_complex *)output_items[1];
-    for ( size_t i = 0; i < rx_samples; i++ )
+    /* duplicated or reordered packets can't be put back into place */
+    if ( 0 == diff || diff >= 0x8000 )
     {
-      out1[i] = gr_complex( *(sample+0) * SCALE_16,
-                            *(sample+1) * SCALE_16 );
+      if ( ++_rejected < RX_RESYNC_REJECTS )
+        continue;
 
-      out2[i] = gr_complex( *(sample+2) * SCALE_16,
-                            *(sample+3) * SCALE_16 );
+      /* more than half the counter was lost, there's no telling how much */
+      std::cerr << "Lost sequence from "
+                << inet_ntoa(_pkt_addr[i].sin_addr) << ":"
+                << ntohs(_pkt_addr[i].sin_port)
+                << ", resynchronizing" << std::endl;
 
-      sample += 4;
+      pkt.resync = true;
+      diff = 1;
     }
-  }
 
-  #undef SCALE_16
+    _sequence = (0xffff == sequence) ? 0 : sequence;
+    _have_sequence = true;
+    _rejected = 0;
+
+    size_t sample_size = pkt.is_24_bit ? 3 : sizeof(int16_t);
+
+    pkt.nitems = (rx_bytes - HEADER_SIZE - SEQNUM_SIZE) /
+                 (sample_size * 2 * _nchan);
 
-  noutput_items = rx_samples;
+    if ( diff > 1 )
+    {
+      /* assume the lost packets were the same size as this one */
+      pkt.gap = (diff - 1) * pkt.nitems;
+
+      /* reported as dropped samples through get_stream_stats() */
+      for ( size_t chan = 0; chan < _nchan; chan++ )
+        _stats.overflow( pkt.gap, chan );
 
-  return noutput_items;
+      std::cerr << "Lost " << diff - 1 << " packets from "
+                << inet_ntoa(_pkt_addr[i].sin_addr) << ":"
+                << ntohs(_pkt_addr[i].sin_port)
+                << std::endl;
+    }
+  }
+
+  _pkt_count = count;
+  _pkt_next = 0;
+  _pkt_offset = 0;
 }
 
 /* discovery protocol internals taken from CuteSDR project */
@@ -1346,6 +1594,7 @@ double rfspace_source_c::set_sample_rate( double rate )
   u32_rate |= response[sizeof(samprate)-1] << 24;
 
   _sample_rate = u32_rate;
+  _tagger.set_rate( _sample_rate );
 
   if ( rate != _sample_rate )
     std::cerr << "Radio reported a sample rate of " << (uint32_t)_sample_rate << " Hz"
@@ -1422,7 +1671,11 @@ double rfspace_source_c::set_center_freq( double freq, size_t chan )
 
   transaction( tune, sizeof(tune) );
 
-  return get_center_freq( chan );
+  double actual = get_center_freq( chan );
+
+  _tagger.set_freq( actual, chan );
+
+  return actual;
 }
 
 double rfspace_source_c::get_center_freq( size_t chan )
@@ -1620,6 +1873,11 @@ double rfspace_source_c::get_bandwidth( size_t chan )
   return _bandwidth;
 }
 
+osmosdr::stream_stats_t rfspace_source_c::get_stream_stats( size_t chan )
+{
+  return _stats.get( chan );
+}
+
 osmosdr::freq_range_t rfspace_source_c::get_bandwidth_range( size_t chan )
 {
   osmosdr::freq_range_t bandwidths;
@@ -28,9 +28,18 @@
 
 #include <mutex>
 #include <condition_variable>
+#include <vector>
+
+#include <netinet/in.h>
+
+#ifdef HAVE_RECVMMSG /* detected by lib/rfspace/CMakeLists.txt */
+#include <sys/socket.h>
+#endif
 
 #include "osmosdr/ranges.h"
 #include "source_iface.h"
+#include "stream_counters.h"
+#include "rx_tagger.h"
 class rfspace_source_c;
 
 #ifndef SOCKET
@@ -112,6 +121,8 @@ public:
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
 private: /* functions */
   void apply_channel( unsigned char *cmd, size_t chan = 0 );
 
@@ -123,6 +134,9 @@ private: /* functions */
   void usb_read_task();
   void tcp_keepalive_task();
 
+  int receive_packets();
+  void parse_packets( int count );
+
 private: /* members */
   enum radio_type
   {
@@ -142,6 +156,13 @@ private: /* members */
   bool _running;
   bool _keep_running;
   uint16_t _sequence;
+  bool _have_sequence;
+  unsigned int _rejected; /* packets rejected in a row */
+  bool _24_bit_mode;
+  bool _gap_hold;
+  gr_complex _last[2];
+  stream_counters _stats;
+  rx_tagger _tagger;
 
   size_t _nchan;
   double _sample_rate;
@@ -159,6 +180,29 @@ private: /* members */
   std::vector< unsigned char > _resp;
   std::mutex _resp_lock;
   std::condition_variable _resp_avail;
+
+  /* UDP datagrams received in one batch, consumed across work() calls */
+  struct packet_t
+  {
+    const unsigned char *payload;
+    size_t nitems; /* IQ pairs per channel, 0 for rejected packets */
+    size_t gap;    /* IQ pairs per channel lost right before this packet */
+    bool resync;   /* follows a jump of the sequence, not filled in */
+    bool is_24_bit;
+  };
+
+  std::vector< unsigned char > _arena;
+  std::vector< size_t > _pkt_bytes;
+  std::vector< struct sockaddr_in > _pkt_addr;
+#ifdef HAVE_RECVMMSG
+  std::vector< struct mmsghdr > _msgs;
+  std::vector< struct iovec > _iovs;
+#endif
+  std::vector< packet_t > _pkts;
+  size_t _pkt_count;
+  size_t _pkt_next;
+  size_t _pkt_offset; /* IQ pairs of _pkts[_pkt_next] already delivered,
+                        including the gap */
 };
 
 #endif /* INCLUDED_RFSPACE_SOURCE_C_H */
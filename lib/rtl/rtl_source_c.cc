@@ -34,6 +34,8 @@
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include <iostream>
 #include <stdio.h>
@@ -41,15 +43,20 @@
 #include <rtl-sdr.h>
 
 #include "arg_helpers.h"
+#include "convert_kernels.h"
 
 using namespace boost::assign;
 
 #define BUF_LEN  (16 * 32 * 512) /* must be multiple of 512 */
 #define BUF_NUM   15
 #define BUF_SKIP  1 // buffers to skip due to initial garbage
+#define BUF_WAIT  3 // buffers to collect before work() hands out samples
 
 #define BYTES_PER_SAMPLE  2 // rtl device delivers 8 bit unsigned IQ data
 
+#define MAX_TRANSFERS  128
+#define MAX_TRANSFER_BYTES  (16 * 1024 * 1024) // default Linux usbfs memory limit
+
 /*
  * Create a new instance of rtl_source_c and return
  * a boost shared_ptr.  This is effectively the public constructor.
@@ -80,14 +87,17 @@ static const int MAX_OUT = 1;	// maximum number of output streams
 rtl_source_c::rtl_source_c (const std::string &args)
   : gr::sync_block ("rtl_source_c",
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
-        gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+        gr::io_signature::make(MIN_OUT, MAX_OUT,
+          cpu_format_item_size(args_to_cpu_format(args)))),
     _dev(NULL),
-    _buf(NULL),
     _running(false),
     _no_tuner(false),
     _auto_gain(false),
     _if_gain(0),
-    _skipped(0)
+    _skipped(0),
+    _latency_ms(0),
+    _tagger([this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+            gr::sync_block::name())
 {
   int ret;
   int index;
@@ -100,6 +110,8 @@ rtl_source_c::rtl_source_c (const std::string &args)
 
   dict_t dict = params_to_dict(args);
 
+  _cpu_format = args_to_cpu_format(args);
+
   if (dict.count("rtl")) {
     std::string value = dict["rtl"];
 
@@ -153,7 +165,7 @@ rtl_source_c::rtl_source_c (const std::string &args)
   if (dict.count("bias"))
     bias_tee = boost::lexical_cast<bool>( dict["bias"] );
 
-  _buf_num = _buf_len = _buf_head = _buf_used = _buf_offset = 0;
+  _buf_num = _buf_len = _buf_offset = 0;
 
   if (dict.count("buffers"))
     _buf_num = boost::lexical_cast< unsigned int >( dict["buffers"] );
@@ -167,17 +179,15 @@ rtl_source_c::rtl_source_c (const std::string &args)
   if (0 == _buf_len || _buf_len % 512 != 0) /* len must be multiple of 512 */
     _buf_len = BUF_LEN;
 
-  if ( BUF_NUM != _buf_num || BUF_LEN != _buf_len ) {
+  /* sizes the transfers from the sample rate in start() instead */
+  if (dict.count("latency_ms"))
+    _latency_ms = boost::lexical_cast< unsigned int >( dict["latency_ms"] );
+
+  if ( _latency_ms == 0 && (BUF_NUM != _buf_num || BUF_LEN != _buf_len) ) {
     std::cerr << "Using " << _buf_num << " buffers of size " << _buf_len << "."
               << std::endl;
   }
 
-  _samp_avail = _buf_len / BYTES_PER_SAMPLE;
-
-  // create a lookup table for gr_complex values
-  for (unsigned int i = 0; i < 0x100; i++)
-    _lut.push_back((i - 127.4f) / 128.0f);
-
   _dev = NULL;
   ret = rtlsdr_open( &_dev, dev_index );
   if (ret < 0)
@@ -230,12 +240,7 @@ rtl_source_c::rtl_source_c (const std::string &args)
 
   set_if_gain( 24 ); /* preset to a reasonable default (non-GRC use case) */
 
-  _buf = (unsigned char **)malloc(_buf_num * sizeof(unsigned char *));
-
-  if (_buf) {
-    for(unsigned int i = 0; i < _buf_num; ++i)
-      _buf[i] = (unsigned char *)malloc(_buf_len);
-  }
+  _ring.reset( new buffer_ring( _buf_num, _buf_len ) );
 }
 
 /*
@@ -254,19 +259,20 @@ rtl_source_c::~rtl_source_c ()
     rtlsdr_close( _dev );
     _dev = NULL;
   }
-
-  if (_buf) {
-    for(unsigned int i = 0; i < _buf_num; ++i) {
-      free(_buf[i]);
-    }
-
-    free(_buf);
-    _buf = NULL;
-  }
 }
 
 bool rtl_source_c::start()
 {
+  if ( _latency_ms )
+    size_buffers();
+
+  _ring->reset();
+  _buf_offset = 0;
+
+  _tagger.set_rate( get_sample_rate() );
+  _tagger.set_freq( get_center_freq() );
+  _tagger.start();
+
   _running = true;
   _thread = gr::thread::thread(_rtlsdr_wait, this);
 
@@ -283,6 +289,37 @@ bool rtl_source_c::stop()
   return true;
 }
 
+/*
+ * latency_ms=N: every transfer holds N ms of samples, so work() gets data
+ * as soon as the first one completes. The ring keeps about half a second
+ * of headroom like the default geometry does at 2.4 MS/s. Only the number
+ * of transfers in flight is bounded by libusb, the ring is plain memory.
+ */
+void rtl_source_c::size_buffers()
+{
+  const double bytes_per_ms = get_sample_rate() * BYTES_PER_SAMPLE / 1000.0;
+
+  unsigned int len = (unsigned int)(bytes_per_ms * _latency_ms) / 512 * 512;
+  len = std::max( len, 512u ); /* len must be multiple of 512 */
+
+  unsigned int slots = (unsigned int)std::ceil( bytes_per_ms * 500 / len );
+  slots = std::max( slots, 4u );
+
+  unsigned int num = std::min( (unsigned int)MAX_TRANSFERS,
+                               std::max( MAX_TRANSFER_BYTES / len, 2u ) );
+  num = std::min( num, slots );
+
+  if ( len != _buf_len || num != _buf_num || slots != _ring->capacity() ) {
+    _buf_len = len;
+    _buf_num = num;
+    _ring.reset( new buffer_ring( slots, _buf_len ) );
+
+    std::cerr << "Using " << _buf_num << " transfers and " << slots
+              << " buffers of size " << _buf_len << " for " << _latency_ms
+              << " ms latency." << std::endl;
+  }
+}
+
 void rtl_source_c::_rtlsdr_callback(unsigned char *buf, uint32_t len, void *ctx)
 {
   rtl_source_c *obj = (rtl_source_c *)ctx;
@@ -296,21 +333,14 @@ void rtl_source_c::rtlsdr_callback(unsigned char *buf, uint32_t len)
     return;
   }
 
-  {
-    std::lock_guard<std::mutex> lock( _buf_mutex );
-
-    int buf_tail = (_buf_head + _buf_used) % _buf_num;
-    memcpy(_buf[buf_tail], buf, len);
-
-    if (_buf_used == _buf_num) {
-      std::cerr << "O" << std::flush;
-      _buf_head = (_buf_head + 1) % _buf_num;
-    } else {
-      _buf_used++;
-    }
+  /* librtlsdr resubmits the transfer as soon as we return, so the data
+   * has to land in a ring slot; a full ring drops it and counts an overrun */
+  if ( _ring->push( buf, len ) ) {
+    _tagger.produced( len / BYTES_PER_SAMPLE );
+  } else {
+    _stats.overflow( len / BYTES_PER_SAMPLE );
+    _tagger.gap();
   }
-
-  _buf_cond.notify_one();
 }
 
 void rtl_source_c::_rtlsdr_wait(rtl_source_c *obj)
@@ -327,50 +357,58 @@ void rtl_source_c::rtlsdr_wait()
   if ( ret != 0 )
     std::cerr << "rtlsdr_read_async returned with " << ret << std::endl;
 
-  _buf_cond.notify_one();
+  _ring->interrupt();
 }
 
 int rtl_source_c::work( int noutput_items,
                         gr_vector_const_void_star &input_items,
                         gr_vector_void_star &output_items )
 {
-  gr_complex *out = (gr_complex *)output_items[0];
+  char *out = (char *)output_items[0];
+  const size_t item_size = cpu_format_item_size( _cpu_format );
+  int produced = 0;
 
-  {
-    std::unique_lock<std::mutex> lock( _buf_mutex );
-
-    while (_buf_used < 3 && _running) // collect at least 3 buffers
-      _buf_cond.wait( lock );
-  }
+  // collect a few buffers, or hand out the first one in low latency mode
+  _ring->wait( _latency_ms ? 1 : BUF_WAIT );
 
   if (!_running)
     return WORK_DONE;
 
-  while (noutput_items && _buf_used) {
-    const int nout = std::min(noutput_items, _samp_avail);
-    const unsigned char *buf = _buf[_buf_head] + _buf_offset * 2;
+  size_t len;
+  const unsigned char *buf;
 
-    for (int i = 0; i < nout; ++i)
-      *out++ = gr_complex(_lut[buf[i * 2]], _lut[buf[i * 2 + 1]]);
+  while (noutput_items && (buf = _ring->read_slot( &len ))) {
+    const int samp_avail = len / BYTES_PER_SAMPLE - _buf_offset;
+    const int nout = std::min(noutput_items, samp_avail);
 
-    noutput_items -= nout;
-    _samp_avail -= nout;
+    buf += _buf_offset * BYTES_PER_SAMPLE;
 
-    if (!_samp_avail) {
-      {
-        std::lock_guard<std::mutex> lock( _buf_mutex );
+    switch ( _cpu_format ) {
+    case CPU_FORMAT_SC8:
+      convert_u8_sc8( buf, (int8_t *)out, nout );
+      break;
+    case CPU_FORMAT_SC16:
+      convert_u8_sc16( buf, (int16_t *)out, nout );
+      break;
+    default:
+      convert_u8_fc32( buf, (gr_complex *)out, nout );
+    }
 
-        _buf_head = (_buf_head + 1) % _buf_num;
-        _buf_used--;
-      }
-      _samp_avail = _buf_len / BYTES_PER_SAMPLE;
+    out += nout * item_size;
+    produced += nout;
+    noutput_items -= nout;
+
+    if (nout == samp_avail) {
+      _ring->release();
       _buf_offset = 0;
     } else {
       _buf_offset += nout;
     }
   }
 
-  return (out - ((gr_complex *)output_items[0]));
+  _tagger.tag_range( nitems_written(0), produced );
+
+  return produced;
 }
 
 std::vector<std::string> rtl_source_c::get_devices()
@@ -441,6 +479,8 @@ double rtl_source_c::set_sample_rate(double rate)
     rtlsdr_set_sample_rate( _dev, (uint32_t)rate );
   }
 
+  _tagger.set_rate( get_sample_rate() );
+
   return get_sample_rate();
 }
 
@@ -497,6 +537,8 @@ double rtl_source_c::set_center_freq( double freq, size_t chan )
   if (_dev)
     rtlsdr_set_center_freq( _dev, (uint32_t)freq );
 
+  _tagger.set_freq( get_center_freq( chan ), chan );
+
   return get_center_freq( chan );
 }
 
@@ -710,3 +752,8 @@ std::string rtl_source_c::get_antenna( size_t chan )
 {
   return "RX";
 }
+
+osmosdr::stream_stats_t rtl_source_c::get_stream_stats( size_t chan )
+{
+  return _stats.get( chan );
+}
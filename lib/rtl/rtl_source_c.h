@@ -26,10 +26,13 @@
 
 #include <gnuradio/thread/thread.h>
 
-#include <mutex>
-#include <condition_variable>
+#include <memory>
 
 #include "source_iface.h"
+#include "arg_helpers.h"
+#include "buffer_ring.h"
+#include "stream_counters.h"
+#include "rx_tagger.h"
 
 class rtl_source_c;
 typedef struct rtlsdr_dev rtlsdr_dev_t;
@@ -113,6 +116,8 @@ public:
   std::string set_antenna( const std::string & antenna, size_t chan = 0 );
   std::string get_antenna( size_t chan = 0 );
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
 protected:
   bool start();
   bool stop();
@@ -122,27 +127,26 @@ private:
   void rtlsdr_callback(unsigned char *buf, uint32_t len);
   static void _rtlsdr_wait(rtl_source_c *obj);
   void rtlsdr_wait();
-
-  std::vector<float> _lut;
+  void size_buffers();
 
   rtlsdr_dev_t *_dev;
   gr::thread::thread _thread;
-  unsigned char **_buf;
+  std::unique_ptr<buffer_ring> _ring;
+  cpu_format_t _cpu_format;
   unsigned int _buf_num;
   unsigned int _buf_len;
-  unsigned int _buf_head;
-  unsigned int _buf_used;
-  std::mutex _buf_mutex;
-  std::condition_variable _buf_cond;
   bool _running;
 
   unsigned int _buf_offset;
-  int _samp_avail;
+  stream_counters _stats;
 
   bool _no_tuner;
   bool _auto_gain;
   double _if_gain;
   unsigned int _skipped;
+  unsigned int _latency_ms;
+
+  rx_tagger _tagger;
 };
 
 #endif /* INCLUDED_RTLSDR_SOURCE_C_H */
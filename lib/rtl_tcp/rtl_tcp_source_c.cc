@@ -18,7 +18,9 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
 #include <fstream>
+#include <iostream>
 #include <string>
 #include <sstream>
 
@@ -29,6 +31,7 @@
 
 #include "rtl_tcp_source_c.h"
 #include "arg_helpers.h"
+#include "convert_kernels.h"
 
 #if defined(_WIN32)
 // if not posix, assume winsock
@@ -40,6 +43,7 @@ typedef char* optval_t;
 #else
 #include <netdb.h>
 #include <sys/types.h>
+#include <sys/select.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -60,6 +64,19 @@ typedef ptrdiff_t ssize_t;
 
 #define BYTES_PER_SAMPLE  2 // rtl_tcp device delivers 8 bit unsigned IQ data
 
+/* default sample FIFO depth in milliseconds at the current sample rate */
+#define DEFAULT_FIFO_MS 500
+
+/* lower bound for the sample FIFO, in IQ pairs */
+#define MIN_FIFO_SAMPLES (512 * 1024)
+
+/* kernel receive buffer, large enough to ride out short scheduling gaps */
+#define RCVBUF_SIZE (4 * 1024 * 1024)
+
+/* how long the reader thread and work() block before rechecking state */
+#define READ_TIMEOUT_MS 100
+#define WORK_TIMEOUT_MS 100
+
 /* copied from rtl sdr code */
 typedef struct { /* structure size must be multiple of 2 bytes */
   char magic[4];
@@ -145,11 +162,17 @@ rtl_tcp_source_c_sptr make_rtl_tcp_source_c(const std::string &args)
 rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
   gr::sync_block("rtl_tcp_source_c",
                  gr::io_signature::make(0, 0, 0),
-                 gr::io_signature::make(1, 1, sizeof (gr_complex))),
+                 gr::io_signature::make(1, 1,
+                   cpu_format_item_size(args_to_cpu_format(args)))),
   d_socket(-1),
   _no_tuner(false),
   _auto_gain(false),
-  _if_gain(0)
+  _if_gain(0),
+  _skip(0),
+  _stalls(0),
+  _running(false),
+  _tagger([this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+          gr::sync_block::name())
 {
   std::string host = "127.0.0.1";
   unsigned short port = 1234;
@@ -164,6 +187,8 @@ rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
 
   dict_t dict = params_to_dict(args);
 
+  _cpu_format = args_to_cpu_format(args);
+
   if (dict.count("rtl_tcp")) {
     std::vector< std::string > tokens;
     boost::algorithm::split( tokens, dict["rtl_tcp"], boost::is_any_of(":") );
@@ -187,15 +212,21 @@ rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
   if (dict.count("bias"))
     bias_tee = boost::lexical_cast<bool>( dict["bias"] );
 
+  _fifo_ms = DEFAULT_FIFO_MS;
+  if (dict.count("fifo_ms"))
+    _fifo_ms = boost::lexical_cast< unsigned int >( dict["fifo_ms"] );
+
   if (!host.length())
     host = "127.0.0.1";
 
   if (0 == port)
     port = 1234;
 
-  if (payload_size <= 0)
+  if (payload_size < BYTES_PER_SAMPLE)
     payload_size = 16384;
 
+  _payload_size = payload_size;
+
 #if defined(USING_WINSOCK) // for Windows (with MinGW)
   // initialize winsock DLL
   WSADATA wsaData;
@@ -223,11 +254,6 @@ rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
     report_error("rtl_tcp_source_c/getaddrinfo",
                  "can't initialize source socket" );
 
-  d_temp_buff = new unsigned char[payload_size];   // allow it to hold up to payload_size bytes
-  d_LUT = new float[0x100];
-  for (int i = 0; i < 0x100; ++i)
-    d_LUT[i] = (((float)(i & 0xff)) - 127.4f) * (1.0f / 128.0f);
-
   // create socket
   d_socket = socket(ip_src->ai_family, ip_src->ai_socktype,
                     ip_src->ai_protocol);
@@ -247,6 +273,12 @@ rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
     if (!is_error(ENOPROTOOPT)) // no SO_LINGER for SOCK_DGRAM on Windows
       report_error("SO_LINGER","can't set socket option SO_LINGER");
 
+  // Let the kernel buffer a good amount of data while we are busy
+  // elsewhere, the server drops samples once its own queue fills up
+  int rcvbuf = RCVBUF_SIZE;
+  if (setsockopt(d_socket, SOL_SOCKET, SO_RCVBUF, (optval_t)&rcvbuf, sizeof(int)) == -1)
+    report_error("SO_RCVBUF", NULL);
+
 #if USE_RCV_TIMEO
   // Set a timeout on the receive function to not block indefinitely
   // This value can (and probably should) be changed
@@ -315,8 +347,10 @@ rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
 
 rtl_tcp_source_c::~rtl_tcp_source_c()
 {
-  delete [] d_LUT;
-  delete [] d_temp_buff;
+  if (_thread.joinable()) {
+    _running = false;
+    _thread.join();
+  }
 
   if (d_socket != -1) {
     shutdown(d_socket, SHUT_RDWR);
@@ -335,29 +369,202 @@ rtl_tcp_source_c::~rtl_tcp_source_c()
 }
 
 
+void rtl_tcp_source_c::_socket_reader(rtl_tcp_source_c *obj)
+{
+  obj->socket_reader();
+}
+
+/*
+ * Waits up to READ_TIMEOUT_MS for data and receives at most len bytes.
+ * Returns the number of bytes received, 0 on timeout and -1 once the
+ * connection is gone.
+ */
+int rtl_tcp_source_c::receive(unsigned char *buf, size_t len)
+{
+  fd_set readfds;
+  FD_ZERO(&readfds);
+  FD_SET(d_socket, &readfds);
+
+  timeval timeout;
+  timeout.tv_sec = 0;
+  timeout.tv_usec = READ_TIMEOUT_MS * 1000;
+
+  int ret = select(d_socket + 1, &readfds, NULL, NULL, &timeout);
+  if (ret == 0)
+    return 0;
+
+  if (ret < 0) {
+#if !defined(USING_WINSOCK)
+    if (errno == EINTR)
+      return 0;
+#endif
+    report_error("rtl_tcp_source_c/select", NULL);
+    return -1;
+  }
+
+  ssize_t received = recv(d_socket, (char*)buf, len, 0);
+  if (received == 0) {
+    fprintf(stderr, "rtl_tcp_source_c: server closed the connection\n");
+    return -1;
+  }
+
+  if (received < 0) {
+#if !defined(USING_WINSOCK)
+    if (errno == EINTR || errno == EAGAIN)
+      return 0;
+#endif
+    report_error("rtl_tcp_source_c/recv", NULL);
+    return -1;
+  }
+
+  return int(received);
+}
+
+void rtl_tcp_source_c::socket_reader()
+{
+  std::vector<unsigned char> scratch(_payload_size);
+  size_t partial = 0; // bytes of an incomplete IQ pair at the FIFO tail
+  unsigned int skip = _skip;
+
+  while (_running) {
+    size_t len;
+    unsigned char *ptr = (unsigned char *)_fifo->write_ptr(&len);
+
+    if (0 == len) {
+      /* work() fell behind, keep draining the socket so the server does not
+       * stall and account for what we throw away */
+      int received = receive(&scratch[0], scratch.size());
+      if (received < 0)
+        break;
+
+      if (received > 0) {
+        _stats.overflow(received / BYTES_PER_SAMPLE);
+        _tagger.gap();
+        skip = (skip + received) % BYTES_PER_SAMPLE;
+      }
+      continue;
+    }
+
+    if (skip) {
+      int received = receive(&scratch[0], skip);
+      if (received < 0)
+        break;
+
+      skip -= received;
+      continue;
+    }
+
+    size_t bytes = std::min(len * BYTES_PER_SAMPLE, _payload_size) - partial;
+
+    int received = receive(ptr + partial, bytes);
+    if (received < 0)
+      break;
+
+    if (received > 0) {
+      partial += received;
+      _fifo->commit(partial / BYTES_PER_SAMPLE);
+      _tagger.produced(partial / BYTES_PER_SAMPLE);
+      partial %= BYTES_PER_SAMPLE;
+    }
+  }
+
+  /* a half received IQ pair is lost, skip its other half on restart */
+  _skip = (skip + partial) % BYTES_PER_SAMPLE;
+
+  _running = false;
+  _fifo->interrupt();
+}
+
+void rtl_tcp_source_c::alloc_fifo()
+{
+  size_t len = size_t(_rate * _fifo_ms / 1000.0);
+
+  if (len < MIN_FIFO_SAMPLES)
+    len = MIN_FIFO_SAMPLES;
+
+  if (!_fifo || _fifo->capacity() != len)
+    _fifo.reset(new sample_fifo<uint16_t>(len));
+}
+
+bool rtl_tcp_source_c::start()
+{
+  /* the sample rate may have changed since the FIFO was sized */
+  alloc_fifo();
+  _fifo->reset();
+
+  _tagger.set_rate(_rate);
+  _tagger.set_freq(_freq);
+  _tagger.start();
+
+  _running = true;
+  _thread = gr::thread::thread(_socket_reader, this);
+
+  return true;
+}
+
+bool rtl_tcp_source_c::stop()
+{
+  _running = false;
+
+  if (_thread.joinable())
+    _thread.join();
+
+  osmosdr::stream_stats_t stats = _stats.get();
+  if (stats.overflows || _stalls)
+    std::cerr << "rtl_tcp_source_c: dropped " << stats.dropped
+              << " samples in " << stats.overflows << " overruns, "
+              << _stalls << " stalls waiting for the server" << std::endl;
+
+  return true;
+}
+
 int rtl_tcp_source_c::work(int noutput_items,
 			   gr_vector_const_void_star &input_items,
 			   gr_vector_void_star &output_items)
 {
-  gr_complex *out = (gr_complex *)output_items[0];
-  int bytesleft = noutput_items * BYTES_PER_SAMPLE;
-  int index = 0;
-  int receivedbytes = 0;
-  while (bytesleft > 0) {
-    receivedbytes = recv(d_socket, (char*)&d_temp_buff[index], bytesleft, 0);
+  char *out = (char *)output_items[0];
+  size_t item_size = cpu_format_item_size(_cpu_format);
+  int produced = 0;
+
+  /* only hand out what the reader has already received, a network hiccup
+   * must not hold up the scheduler indefinitely */
+  if (!_fifo->wait_for(1, std::chrono::milliseconds(WORK_TIMEOUT_MS))) {
+    if (!_running)
+      return WORK_DONE;
+
+    _stalls++;
+    return 0;
+  }
 
-    if (receivedbytes == -1 && !is_error(EAGAIN)) {
-      fprintf(stderr, "socket error\n");
-      return -1;
+  while (produced < noutput_items) {
+    size_t len;
+    const unsigned char *in = (const unsigned char *)_fifo->read_ptr(&len);
+
+    if (0 == len)
+      break;
+
+    len = std::min(len, size_t(noutput_items - produced));
+
+    switch ( _cpu_format ) {
+    case CPU_FORMAT_SC8:
+      convert_u8_sc8( in, (int8_t *)out, len );
+      break;
+    case CPU_FORMAT_SC16:
+      convert_u8_sc16( in, (int16_t *)out, len );
+      break;
+    default:
+      convert_u8_fc32( in, (gr_complex *)out, len );
     }
-    bytesleft -= receivedbytes;
-    index += receivedbytes;
+
+    _fifo->consume(len);
+
+    out += len * item_size;
+    produced += len;
   }
 
-  for (int i = 0; i < noutput_items; i++)
-    out[i] = gr_complex(d_LUT[d_temp_buff[i * 2]], d_LUT[d_temp_buff[i * 2 + 1]]);
+  _tagger.tag_range(nitems_written(0), produced);
 
-  return noutput_items;
+  return produced;
 }
 
 std::string rtl_tcp_source_c::name()
@@ -411,6 +618,7 @@ double rtl_tcp_source_c::set_sample_rate( double rate )
   send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
 
   _rate = rate;
+  _tagger.set_rate(_rate);
 
   return get_sample_rate();
 }
@@ -460,6 +668,7 @@ double rtl_tcp_source_c::set_center_freq( double freq, size_t chan )
   send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
 
   _freq = freq;
+  _tagger.set_freq(_freq, chan);
 
   return get_center_freq(chan);
 }
@@ -698,3 +907,8 @@ std::string rtl_tcp_source_c::get_antenna( size_t chan )
 {
   return "RX";
 }
+
+osmosdr::stream_stats_t rtl_tcp_source_c::get_stream_stats( size_t chan )
+{
+  return _stats.get( chan );
+}
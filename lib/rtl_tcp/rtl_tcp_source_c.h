@@ -22,7 +22,16 @@
 
 #include <gnuradio/sync_block.h>
 
+#include <gnuradio/thread/thread.h>
+
+#include <atomic>
+#include <memory>
+
 #include "source_iface.h"
+#include "arg_helpers.h"
+#include "sample_fifo.h"
+#include "stream_counters.h"
+#include "rx_tagger.h"
 
 class rtl_tcp_source_c;
 
@@ -51,9 +60,17 @@ private:
   rtl_tcp_source_c(const std::string &args);
   const char * get_tuner_name(void);
 
+  static void _socket_reader(rtl_tcp_source_c *obj);
+  void socket_reader();
+  int receive(unsigned char *buf, size_t len);
+  void alloc_fifo();
+
 public:
   ~rtl_tcp_source_c();
 
+  bool start();
+  bool stop();
+
   int work(int noutput_items,
 	   gr_vector_const_void_star &input_items,
 	   gr_vector_void_star &output_items);
@@ -90,6 +107,8 @@ public:
   std::string set_antenna( const std::string & antenna, size_t chan = 0 );
   std::string get_antenna( size_t chan = 0 );
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
 private:
   int d_socket;		  // handle to socket
   double _freq, _rate, _gain, _corr;
@@ -100,8 +119,20 @@ private:
   enum rtlsdr_tuner d_tuner_type;
   unsigned int d_tuner_gain_count;
   unsigned int d_tuner_if_gain_count;
-  unsigned char *d_temp_buff; // hold buffer between calls
-  float *d_LUT;
+  cpu_format_t _cpu_format;
+
+  /* each item is one IQ pair of unsigned 8 bit samples */
+  std::unique_ptr< sample_fifo<uint16_t> > _fifo;
+  unsigned int _fifo_ms;
+  size_t _payload_size;
+  unsigned int _skip; // bytes to discard to get back in step with IQ pairs
+  uint64_t _stalls;
+  stream_counters _stats;
+
+  gr::thread::thread _thread;
+  std::atomic<bool> _running;
+
+  rx_tagger _tagger;
 };
 
 #endif // RTL_TCP_SOURCE_C_H
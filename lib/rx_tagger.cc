@@ -0,0 +1,260 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+
+#include "rx_tagger.h"
+
+const pmt::pmt_t rx_tagger::TIME_KEY = pmt::string_to_symbol("rx_time");
+const pmt::pmt_t rx_tagger::RATE_KEY = pmt::string_to_symbol("rx_rate");
+const pmt::pmt_t rx_tagger::FREQ_KEY = pmt::string_to_symbol("rx_freq");
+
+rx_tagger::rx_tagger( const add_tag_t &add_tag, const std::string &srcid,
+                      size_t nchan )
+  : _add_tag( add_tag ),
+    _srcid( pmt::string_to_symbol( srcid ) ),
+    _pending( false ),
+    _rate( 0 ),
+    _freq( nchan ? nchan : 1, 0 ),
+    _have_base( false ),
+    _base_offset( 0 ),
+    _positioned( false ),
+    _produced( 0 ),
+    _consumed( 0 ),
+    _gaps( 64 ),
+    _gaps_lost( false ),
+    _queued( false )
+{
+}
+
+void rx_tagger::start()
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  /* the producer isn't running yet, retunes made while stopped apply to
+   * the first sample */
+  for ( const retune_t &r : _retunes )
+    _freq[ r.chan ] = r.freq;
+  _retunes.clear();
+  _queued.store( false );
+
+  _produced.store( 0 );
+  _consumed = 0;
+  _gaps.reset();
+  _gaps_lost.store( false );
+
+  _have_base = false;
+  _pending.store( true, std::memory_order_release );
+}
+
+void rx_tagger::discontinuity()
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  _have_base = false;
+  _pending.store( true, std::memory_order_release );
+}
+
+void rx_tagger::set_rate( double rate )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  if ( rate == _rate )
+    return;
+
+  /* we can't tell which sample was the first at the new rate, so the time
+   * base is rebuilt instead of extrapolated */
+  _rate = rate;
+  _have_base = false;
+  _pending.store( true, std::memory_order_release );
+}
+
+void rx_tagger::set_freq( double freq, size_t chan )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  if ( chan >= _freq.size() )
+    return;
+
+  /* queued samples were taken at the old frequency, the new one applies
+   * from the next sample produced */
+  if ( _positioned.load( std::memory_order_relaxed ) ) {
+    if ( _retunes.empty() && freq == _freq[chan] )
+      return;
+
+    retune_t r = { _produced.load( std::memory_order_acquire ), chan, freq };
+    _retunes.push_back( r );
+    _queued.store( true, std::memory_order_release );
+    return;
+  }
+
+  if ( freq == _freq[chan] )
+    return;
+
+  _freq[chan] = freq;
+  _pending.store( true, std::memory_order_release );
+}
+
+void rx_tagger::gap()
+{
+  using namespace std::chrono;
+
+  gap_t g;
+  g.pos = _produced.load( std::memory_order_relaxed );
+  g.ns = duration_cast<nanoseconds>(
+           system_clock::now().time_since_epoch() ).count();
+
+  if ( _gaps.write( &g, 1 ) != 1 )
+    _gaps_lost.store( true, std::memory_order_relaxed );
+}
+
+void rx_tagger::tag_range( uint64_t offset, size_t nitems )
+{
+  if ( ! _pending.load( std::memory_order_acquire ) &&
+       ! _queued.load( std::memory_order_acquire ) && ! _gaps.used() ) {
+    _consumed += nitems;
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  const uint64_t end = _consumed + nitems;
+
+  /* more gaps than we could keep track of, the next sample going out is
+   * tagged from the host clock like without position tracking */
+  if ( _gaps_lost.exchange( false, std::memory_order_relaxed ) ) {
+    _have_base = false;
+    _pending.store( true, std::memory_order_relaxed );
+  }
+
+  bool pending = _pending.exchange( false, std::memory_order_relaxed );
+
+  for (;;) {
+    size_t ngaps;
+    const gap_t *gap = _gaps.read_ptr( &ngaps );
+
+    /* events queued before the samples handed out apply to the first one */
+    uint64_t pos = ngaps ? gap->pos : end;
+    for ( const retune_t &r : _retunes )
+      pos = std::min( pos, r.pos );
+    pos = std::max( pos, _consumed );
+
+    /* start, rate changes and the like apply to the first sample */
+    if ( pending && pos > _consumed ) {
+      emit_locked( offset, NULL );
+      pending = false;
+    }
+
+    if ( pos >= end )
+      break;
+
+    for ( size_t i = 0; i < _retunes.size(); ) {
+      if ( _retunes[i].pos <= pos ) {
+        _freq[ _retunes[i].chan ] = _retunes[i].freq;
+        _retunes.erase( _retunes.begin() + i );
+      } else {
+        i++;
+      }
+    }
+
+    osmosdr::time_spec_t time;
+    bool have_time = false;
+
+    while ( ngaps && std::max( gap->pos, _consumed ) <= pos ) {
+      time = osmosdr::time_spec_t::from_ticks( gap->ns, 1e9 );
+      have_time = true;
+      _gaps.consume( 1 );
+      gap = _gaps.read_ptr( &ngaps );
+    }
+
+    emit_locked( offset + (pos - _consumed), have_time ? &time : NULL );
+    pending = false;
+  }
+
+  _queued.store( ! _retunes.empty(), std::memory_order_relaxed );
+  _consumed = end;
+}
+
+osmosdr::time_spec_t rx_tagger::host_time()
+{
+  using namespace std::chrono;
+
+  long long ns = duration_cast<nanoseconds>(
+                   system_clock::now().time_since_epoch() ).count();
+
+  return osmosdr::time_spec_t::from_ticks( ns, 1e9 );
+}
+
+void rx_tagger::emit( uint64_t offset, const osmosdr::time_spec_t *time )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  /* cleared under the lock, events arriving from now on get their own tag */
+  _pending.store( false, std::memory_order_relaxed );
+
+  emit_locked( offset, time );
+}
+
+void rx_tagger::emit_locked( uint64_t offset, const osmosdr::time_spec_t *time )
+{
+  osmosdr::time_spec_t when;
+
+  if ( time )
+    when = *time;
+  else if ( _have_base && _rate > 0 )
+    when = _base_time +
+           osmosdr::time_spec_t( double(offset - _base_offset) / _rate );
+  else
+    when = host_time();
+
+  _have_base = true;
+  _base_offset = offset;
+  _base_time = when;
+
+  gr::tag_t tag;
+  tag.offset = offset;
+  tag.srcid = _srcid;
+
+  const pmt::pmt_t time_val =
+      pmt::make_tuple( pmt::from_uint64( when.get_full_secs() ),
+                       pmt::from_double( when.get_frac_secs() ) );
+  const pmt::pmt_t rate_val = pmt::from_double( _rate );
+
+  for ( size_t chan = 0; chan < _freq.size(); chan++ ) {
+    tag.key = TIME_KEY;
+    tag.value = time_val;
+    _add_tag( chan, tag );
+
+    tag.key = RATE_KEY;
+    tag.value = rate_val;
+    _add_tag( chan, tag );
+
+    tag.key = FREQ_KEY;
+    tag.value = pmt::from_double( _freq[chan] );
+    _add_tag( chan, tag );
+  }
+}
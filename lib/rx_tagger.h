@@ -0,0 +1,164 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_RX_TAGGER_H
+#define OSMOSDR_RX_TAGGER_H
+
+#include <gnuradio/tags.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <osmosdr/time_spec.h>
+
+#include "sample_fifo.h"
+
+/*!
+ * \brief Emits rx_time, rx_rate and rx_freq stream tags for a source.
+ *
+ * The tags are the ones the UHD source uses, so downstream blocks can keep
+ * track of absolute time without counting samples:
+ *
+ *   rx_time  (uint64 full seconds . double fractional seconds)
+ *   rx_rate  double sample rate
+ *   rx_freq  double center frequency of the channel
+ *
+ * All three are attached to every channel on start(), after a
+ * discontinuity() and after set_rate() / set_freq(). Between those events
+ * time simply advances with the sample count.
+ *
+ * Backends that get a timestamp from the hardware pass it to tag(). Others
+ * let the tagger estimate it from the host clock, which is only as good as
+ * the latency of the driver buffers.
+ *
+ * Backends queueing samples from a driver callback report what went into
+ * their buffers with produced() and lost samples with gap(), and call
+ * tag_range() from work(). The tags then land on the sample after the gap
+ * rather than on the first one work() hands out, with the host time taken
+ * when the samples were lost, and rx_freq lands on the first sample queued
+ * after set_freq().
+ */
+class rx_tagger
+{
+public:
+  /* adds a tag to an output, usually a lambda calling gr::block::add_item_tag */
+  typedef std::function< void ( size_t chan, const gr::tag_t &tag ) > add_tag_t;
+
+  static const pmt::pmt_t TIME_KEY;
+  static const pmt::pmt_t RATE_KEY;
+  static const pmt::pmt_t FREQ_KEY;
+
+  rx_tagger( const add_tag_t &add_tag, const std::string &srcid,
+             size_t nchan = 1 );
+
+  /* streaming (re)started, tag the next sample and forget the time base */
+  void start();
+
+  /* samples were lost or the stream was interrupted */
+  void discontinuity();
+
+  void set_rate( double rate );
+  void set_freq( double freq, size_t chan = 0 );
+
+  /*
+   * To be called from work() with the absolute offset of the next sample
+   * going out, i.e. nitems_written(0) plus what has been produced so far.
+   * Does nothing unless one of the events above happened since the last
+   * call. time is the hardware timestamp of that sample, if known.
+   */
+  void tag( uint64_t offset, const osmosdr::time_spec_t *time = NULL )
+  {
+    if ( _pending.load( std::memory_order_acquire ) )
+      emit( offset, time );
+  }
+
+  /*
+   * Producer side, lock free for driver callbacks: n more samples went
+   * into the backend's buffers.
+   */
+  void produced( size_t n )
+  {
+    _positioned.store( true, std::memory_order_relaxed );
+    _produced.fetch_add( n, std::memory_order_release );
+  }
+
+  /* samples were lost, the ones produced next follow a gap */
+  void gap();
+
+  /*
+   * Consumer side, to be called from work() after nitems samples starting
+   * at the absolute offset were handed out. Tags the gaps and retunes which
+   * fall into that range at their own sample, plus what tag() would.
+   */
+  void tag_range( uint64_t offset, size_t nitems );
+
+  /* current time of day as a time_spec_t, for the host clock estimate */
+  static osmosdr::time_spec_t host_time();
+
+  rx_tagger( const rx_tagger & ) = delete;
+  rx_tagger &operator=( const rx_tagger & ) = delete;
+
+private:
+  void emit( uint64_t offset, const osmosdr::time_spec_t *time );
+  void emit_locked( uint64_t offset, const osmosdr::time_spec_t *time );
+
+  struct gap_t
+  {
+    uint64_t pos;     /* produced() count at the gap */
+    long long ns;     /* host time when the samples were lost */
+  };
+
+  struct retune_t
+  {
+    uint64_t pos;
+    size_t chan;
+    double freq;
+  };
+
+  add_tag_t _add_tag;
+  pmt::pmt_t _srcid;
+
+  std::mutex _mutex;
+  std::atomic<bool> _pending;
+
+  double _rate;
+  std::vector<double> _freq;
+
+  /* time base: the sample at _base_offset was taken at _base_time */
+  bool _have_base;
+  uint64_t _base_offset;
+  osmosdr::time_spec_t _base_time;
+
+  /* sample positions counted since start() by both sides */
+  std::atomic<bool> _positioned;      /* the backend calls produced() */
+  std::atomic<uint64_t> _produced;
+  uint64_t _consumed;
+  sample_fifo<gap_t> _gaps;
+  std::atomic<bool> _gaps_lost;       /* _gaps was full, fall back */
+  std::vector<retune_t> _retunes;
+  std::atomic<bool> _queued;          /* _retunes isn't empty */
+};
+
+#endif // OSMOSDR_RX_TAGGER_H
@@ -0,0 +1,153 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_SAMPLE_FIFO_H
+#define OSMOSDR_SAMPLE_FIFO_H
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "buffer_ring.h"
+
+/*!
+ * \brief Lock-free single-producer/single-consumer FIFO of plain items.
+ *
+ * Unlike buffer_ring, which hands around whole driver buffers, this is a
+ * contiguous ring of individual items (samples, bytes or pointers) built
+ * on the same spsc_ring indices. Both sides move data in bulk with at
+ * most two memcpy() calls per operation, splitting the copy where the
+ * ring wraps around.
+ *
+ * Producers that can fill the ring in place use write_ptr() and commit(),
+ * consumers that can convert straight out of it use read_ptr() and
+ * consume(). The overrun counters count failed writes and dropped items.
+ *
+ * T must be trivially copyable.
+ */
+template <typename T>
+class sample_fifo : public spsc_ring
+{
+public:
+  explicit sample_fifo( size_t capacity )
+    : spsc_ring(capacity), _buf(capacity)
+  {
+  }
+
+  /* number of items that can be written, safe to call from either side */
+  size_t space() const { return capacity() - used(); }
+
+  /*
+   * Producer side
+   */
+
+  /*
+   * Returns the next writable region and stores its length in *len. The
+   * region ends at the wrap-around point, so a second call after commit()
+   * may return more space.
+   */
+  T *write_ptr( size_t *len )
+  {
+    return &_buf[ write_pos( len ) ];
+  }
+
+  /* publishes n items previously written through write_ptr() */
+  void commit( size_t n )
+  {
+    produce( n );
+  }
+
+  /*
+   * Copies up to n items into the FIFO and returns how many were taken.
+   * Items that do not fit are dropped and accounted as an overrun.
+   */
+  size_t write( const T *in, size_t n )
+  {
+    size_t done = 0;
+
+    while ( done < n ) {
+      size_t len;
+      T *ptr = write_ptr( &len );
+
+      if ( 0 == len )
+        break;
+
+      len = std::min( len, n - done );
+      memcpy( ptr, in + done, len * sizeof(T) );
+      done += len;
+
+      /* publish the first part before wrapping around */
+      commit( len );
+    }
+
+    if ( done < n )
+      overrun( n - done );
+
+    return done;
+  }
+
+  /*
+   * Consumer side
+   */
+
+  /*
+   * Returns the oldest readable region and stores its length in *len. The
+   * region ends at the wrap-around point.
+   */
+  const T *read_ptr( size_t *len )
+  {
+    return &_buf[ read_pos( len ) ];
+  }
+
+  /* hands n items previously read through read_ptr() back to the producer */
+  void consume( size_t n )
+  {
+    consume_entries( n );
+  }
+
+  /* copies up to n items out of the FIFO and returns how many were read */
+  size_t read( T *out, size_t n )
+  {
+    size_t done = 0;
+
+    while ( done < n ) {
+      size_t len;
+      const T *ptr = read_ptr( &len );
+
+      if ( 0 == len )
+        break;
+
+      len = std::min( len, n - done );
+      memcpy( out + done, ptr, len * sizeof(T) );
+      done += len;
+
+      consume( len );
+    }
+
+    return done;
+  }
+
+private:
+  std::vector<T> _buf;
+};
+
+#endif // OSMOSDR_SAMPLE_FIFO_H
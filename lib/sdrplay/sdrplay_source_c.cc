@@ -112,7 +112,11 @@ sdrplay_source_c::sdrplay_source_c (const std::string &args)
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
     _running(false),
     _uninit(false),
-    _auto_gain(false)
+    _auto_gain(false),
+    _tagger([this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+            gr::sync_block::name()),
+    _have_samp_num(false),
+    _next_samp_num(0)
 {
    _dev = (sdrplay_dev_t *)malloc(sizeof(sdrplay_dev_t));
    if (_dev == NULL)
@@ -164,6 +168,11 @@ void sdrplay_source_c::reinit_device()
       mir_sdr_Uninit();
    }
 
+   /* the stream restarts from scratch */
+   _tagger.set_rate(_dev->fsHz);
+   _tagger.set_freq(_dev->rfHz);
+   _tagger.start();
+
    std::cerr << "mir_sdr_Init started" << std::endl;
    mir_sdr_Init(_dev->gRdB, _dev->fsHz / 1e6, _dev->rfHz / 1e6, _dev->bwType, _dev->ifType, &_dev->samplesPerPacket);
 
@@ -174,6 +183,7 @@ void sdrplay_source_c::reinit_device()
    }
 
    _buf_offset = 0;
+   _have_samp_num = false;
    _buf_mutex.unlock();
    std::cerr << "reinit_device end" << std::endl;
 }
@@ -213,10 +223,6 @@ int sdrplay_source_c::work( int noutput_items,
 {
    gr_complex *out = (gr_complex *)output_items[0];
    int cnt = noutput_items;
-   unsigned int sampNum;
-   int grChanged;
-   int rfChanged;
-   int fsChanged;
 
    if (_uninit)
    {
@@ -231,6 +237,8 @@ int sdrplay_source_c::work( int noutput_items,
 
    _buf_mutex.lock();
 
+   _tagger.tag(nitems_written(0));
+
    if (_buf_offset)
    {
       for (int i = _buf_offset; i < _dev->samplesPerPacket; i++)
@@ -242,7 +250,7 @@ int sdrplay_source_c::work( int noutput_items,
 
    while ((cnt - _dev->samplesPerPacket) >= 0)
    {
-      mir_sdr_ReadPacket(_bufi.data(), _bufq.data(), &sampNum, &grChanged, &rfChanged, &fsChanged);
+      read_packet(nitems_written(0) + noutput_items - cnt);
       for (int i = 0; i < _dev->samplesPerPacket; i++)
       {
          *out++ = gr_complex( float(_bufi[i]) * (1.0f/2048.0f), float(_bufq[i]) * (1.0f/2048.0f) );
@@ -253,7 +261,7 @@ int sdrplay_source_c::work( int noutput_items,
    _buf_offset = 0;
    if (cnt)
    {
-      mir_sdr_ReadPacket(_bufi.data(), _bufq.data(), &sampNum, &grChanged, &rfChanged, &fsChanged);
+      read_packet(nitems_written(0) + noutput_items - cnt);
       for (int i = 0; i < cnt; i++)
       {
          *out++ = gr_complex( float(_bufi[i]) * (1.0f/2048.0f), float(_bufq[i]) * (1.0f/2048.0f) );
@@ -265,6 +273,28 @@ int sdrplay_source_c::work( int noutput_items,
    return noutput_items;
 }
 
+void sdrplay_source_c::read_packet(uint64_t offset)
+{
+   unsigned int sampNum;
+   int grChanged;
+   int rfChanged;
+   int fsChanged;
+
+   mir_sdr_ReadPacket(_bufi.data(), _bufq.data(), &sampNum, &grChanged, &rfChanged, &fsChanged);
+
+   /* packets are numbered by their first sample, a jump means the API
+    * dropped some; offset is where the first sample of this one goes out */
+   if (_have_samp_num && sampNum != _next_samp_num)
+   {
+      _stats.overflow(sampNum - _next_samp_num);
+      _tagger.discontinuity();
+      _tagger.tag(offset);
+   }
+
+   _have_samp_num = true;
+   _next_samp_num = sampNum + _dev->samplesPerPacket;
+}
+
 std::vector<std::string> sdrplay_source_c::get_devices()
 {
    std::vector<std::string> devices;
@@ -321,6 +351,7 @@ double sdrplay_source_c::set_sample_rate(double rate)
       {
          std::cerr << "mir_sdr_SetFs started" << std::endl;
          mir_sdr_SetFs(diff, 0, 0, 0);
+         _tagger.set_rate(rate);
       }
       else
       {
@@ -371,6 +402,7 @@ double sdrplay_source_c::set_center_freq( double freq, size_t chan )
       {
          std::cerr << "mir_sdr_SetRf started" << std::endl;
          mir_sdr_SetRf(diff, 0, 0);
+         _tagger.set_freq(freq, chan);
       }
       else
       {
@@ -598,3 +630,8 @@ osmosdr::freq_range_t sdrplay_source_c::get_bandwidth_range( size_t chan )
 
    return range;
 }
+
+osmosdr::stream_stats_t sdrplay_source_c::get_stream_stats( size_t chan )
+{
+   return _stats.get( chan );
+}
@@ -31,6 +31,8 @@
 #include "osmosdr/ranges.h"
 
 #include "source_iface.h"
+#include "rx_tagger.h"
+#include "stream_counters.h"
 
 class sdrplay_source_c;
 typedef struct sdrplay_dev sdrplay_dev_t;
@@ -118,9 +120,12 @@ public:
    double get_bandwidth( size_t chan = 0 );
    osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+   osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
 private:
    void reinit_device(void);
    void set_gain_limits(double freq);
+   void read_packet(uint64_t offset);
 
    sdrplay_dev_t *_dev;
 
@@ -132,6 +137,11 @@ private:
    bool _running;
    bool _uninit;
    bool _auto_gain;
+
+   rx_tagger _tagger;
+   stream_counters _stats;
+   bool _have_samp_num;
+   unsigned int _next_samp_num;  /* expected first sample of the next packet */
 };
 
 #endif /* INCLUDED_SDRPLAY_SOURCE_C_H */
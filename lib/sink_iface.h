@@ -23,6 +23,7 @@
 
 #include <osmosdr/ranges.h>
 #include <osmosdr/time_spec.h>
+#include <osmosdr/stream_stats.h>
 #include <gnuradio/basic_block.h>
 
 /*!
@@ -258,6 +259,14 @@ public:
   virtual osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 )
     { return osmosdr::freq_range_t(); }
 
+  /*!
+   * Get the overflow/underflow counters of the device.
+   * \param chan the channel index 0 to N-1
+   * \return the counters accumulated since the device has been opened
+   */
+  virtual osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 )
+    { return osmosdr::stream_stats_t(); }
+
   /*!
    * Set the time source for the device.
    * This sets the method of time synchronization,
@@ -30,32 +30,10 @@
 #include <gnuradio/io_signature.h>
 #include <gnuradio/constants.h>
 
-#ifdef ENABLE_UHD
-#include "uhd_sink_c.h"
-#endif
-#ifdef ENABLE_HACKRF
-#include "hackrf_sink_c.h"
-#endif
-#ifdef ENABLE_BLADERF
-#include "bladerf_sink_c.h"
-#endif
-#ifdef ENABLE_SOAPY
-#include "soapy_sink_c.h"
-#endif
-#ifdef ENABLE_REDPITAYA
-#include "redpitaya_sink_c.h"
-#endif
-#ifdef ENABLE_FREESRP
-#include <freesrp_sink_c.h>
-#endif
-#ifdef ENABLE_XTRX
-#include "xtrx_sink_c.h"
-#endif
-#ifdef ENABLE_FILE
-#include "file_sink_c.h"
-#endif
-
 #include "arg_helpers.h"
+#include "device_enum.h"
+#include "backend_loader.h"
+#include "stats_publisher.h"
 #include "sink_impl.h"
 
 /*
@@ -82,85 +60,26 @@ sink_impl::sink_impl( const std::string &args )
 
   std::vector< std::string > arg_list = args_to_vector(args);
 
-  std::vector< std::string > dev_types;
-
-#ifdef ENABLE_UHD
-  dev_types.push_back("uhd");
-#endif
-#ifdef ENABLE_HACKRF
-  dev_types.push_back("hackrf");
-#endif
-#ifdef ENABLE_BLADERF
-  dev_types.push_back("bladerf");
-#endif
-#ifdef ENABLE_SOAPY
-  dev_types.push_back("soapy");
-#endif
-#ifdef ENABLE_REDPITAYA
-  dev_types.push_back("redpitaya");
-#endif
-#ifdef ENABLE_FREESRP
-  dev_types.push_back("freesrp");
-#endif
-#ifdef ENABLE_XTRX
-  dev_types.push_back("xtrx");
-#endif
-#ifdef ENABLE_FILE
-  dev_types.push_back("file");
-#endif
-
   std::cerr << "gr-osmosdr "
             << GR_OSMOSDR_VERSION << " (" << GR_OSMOSDR_LIBVER << ") "
             << "gnuradio " << gr::version() << std::endl;
   std::cerr << "built-in sink types: ";
-  for (std::string dev_type : dev_types)
+  for (std::string dev_type : backend_device_types( BACKEND_SINK ))
     std::cerr << dev_type << " ";
   std::cerr << std::endl;
 
   for (std::string arg : arg_list) {
-    dict_t dict = params_to_dict(arg);
-    for (std::string dev_type : dev_types) {
-      if ( dict.count( dev_type ) ) {
-        device_specified = true;
-        break;
-      }
+    if ( backend_for_args( params_to_dict(arg), BACKEND_SINK ).size() ) {
+      device_specified = true;
+      break;
     }
   }
 
   if ( ! device_specified ) {
-    std::vector< std::string > dev_list;
-#ifdef ENABLE_UHD
-    for (std::string dev : uhd_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_BLADERF
-    for (std::string dev : bladerf_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_HACKRF
-    for (std::string dev : hackrf_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_SOAPY
-    for (std::string dev : soapy_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_REDPITAYA
-    for (std::string dev : redpitaya_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_FREESRP
-    for (std::string dev : freesrp_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_XTRX
-    for (std::string dev : xtrx_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_FILE
-    for (std::string dev : file_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
+    /* the first backend reporting a device wins, don't wait for the rest */
+    std::vector< std::string > dev_list =
+        registry_enumerate( backend_enumerators( BACKEND_SINK ),
+                            args_to_enum_timeout_ms(args), true );
 
 //    std::cerr << std::endl;
 //    for (std::string dev : dev_list)
@@ -176,6 +95,10 @@ sink_impl::sink_impl( const std::string &args )
 
     dict_t dict = params_to_dict(arg);
 
+    /* pass a globally given caps_cache=0 on to every device */
+    if ( ! args_to_caps_cache(args) && ! dict.count("caps_cache") )
+      arg += ",caps_cache=0";
+
 //    std::cerr << std::endl;
 //    for (dict_t::value_type &entry : dict)
 //      std::cerr << "'" << entry.first << "' = '" << entry.second << "'" << std::endl;
@@ -183,60 +106,23 @@ sink_impl::sink_impl( const std::string &args )
     sink_iface *iface = NULL;
     gr::basic_block_sptr block;
 
-#ifdef ENABLE_UHD
-    if ( dict.count("uhd") ) {
-      uhd_sink_c_sptr sink = make_uhd_sink_c( arg );
-      block = sink; iface = sink.get();
+    std::string backend = backend_for_args( dict, BACKEND_SINK );
+    if ( backend.size() ) {
+      const osmosdr_backend_t *b = backend_load( backend );
+      if ( b->make_sink )
+        iface = b->make_sink( arg, block );
     }
-#endif
-#ifdef ENABLE_HACKRF
-    if ( dict.count("hackrf") ) {
-      hackrf_sink_c_sptr sink = make_hackrf_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_BLADERF
-    if ( dict.count("bladerf") ) {
-      bladerf_sink_c_sptr sink = make_bladerf_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_SOAPY
-    if ( dict.count("soapy") ) {
-      soapy_sink_c_sptr sink = make_soapy_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_REDPITAYA
-    if ( dict.count("redpitaya") ) {
-      redpitaya_sink_c_sptr sink = make_redpitaya_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_FREESRP
-    if ( dict.count("freesrp") ) {
-      freesrp_sink_c_sptr sink = make_freesrp_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_XTRX
-    if ( dict.count("xtrx") ) {
-      xtrx_sink_c_sptr sink = make_xtrx_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_FILE
-    if ( dict.count("file") ) {
-      file_sink_c_sptr sink = make_file_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
 
     if (iface != NULL && reinterpret_cast<std::intptr_t>(block.get()) != 0) {
       _devs.push_back( iface );
 
       for (size_t i = 0; i < iface->get_num_channels(); i++) {
+        channel_route_t route = channel_route_t();
+        route.dev = iface;
+        route.dev_chan = i;
+
         connect(self(), channel++, block, i);
+        _routes.push_back( route );
       }
     } else if ((iface != NULL) || (reinterpret_cast<std::intptr_t>(block.get()) != 0))
       throw std::runtime_error("Either iface or block are NULL.");
@@ -247,21 +133,31 @@ sink_impl::sink_impl( const std::string &args )
     throw std::runtime_error("No devices specified via device arguments.");
 
   /* Populate the _gain and _gain_mode arrays with the hardware state */
-  for ( sink_iface *dev : _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++) {
-      _gain_mode[dev_chan] = dev->get_gain_mode(dev_chan);
-      _gain[dev_chan] = dev->get_gain(dev_chan);
-    }
+  for (size_t chan = 0; chan < _routes.size(); chan++) {
+    _gain_mode[chan] = _routes[chan].dev->get_gain_mode( _routes[chan].dev_chan );
+    _gain[chan] = _routes[chan].dev->get_gain( _routes[chan].dev_chan );
+  }
+
+  /* overflow/underflow counters, published every stats_ms if requested */
+  stats_publisher_sptr stats = make_stats_publisher( [this]() {
+      std::vector< osmosdr::stream_stats_t > all;
+      for (size_t chan = 0; chan < get_num_channels(); chan++)
+        all.push_back( get_stream_stats( chan ) );
+      return all;
+    }, args_to_stats_ms(args) );
+
+  message_port_register_hier_out( pmt::mp("stats") );
+  msg_connect( stats, pmt::mp("stats"), self(), pmt::mp("stats") );
 }
 
 size_t sink_impl::get_num_channels()
 {
-  size_t channels = 0;
-
-  for (sink_iface *dev : _devs)
-    channels += dev->get_num_channels();
+  return _routes.size();
+}
 
-  return channels;
+const sink_impl::channel_route_t *sink_impl::find_route( size_t chan ) const
+{
+  return chan < _routes.size() ? &_routes[chan] : NULL;
 }
 
 #define NO_DEVICES_MSG  "FATAL: No device(s) available to work with."
@@ -310,299 +206,235 @@ double sink_impl::get_sample_rate()
 
 osmosdr::freq_range_t sink_impl::get_freq_range( size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_freq_range( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_freq_range( route->dev_chan );
 
   return osmosdr::freq_range_t();
 }
 
 double sink_impl::set_center_freq( double freq, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _center_freq[ chan ] != freq ) {
-          _center_freq[ chan ] = freq;
-          return dev->set_center_freq( freq, dev_chan );
-        } else { return _center_freq[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _center_freq[ chan ] != freq ) {
+      _center_freq[ chan ] = freq;
+      return route->dev->set_center_freq( freq, route->dev_chan );
+    } else { return _center_freq[ chan ]; }
+  }
 
   return 0;
 }
 
 double sink_impl::get_center_freq( size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_center_freq( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_center_freq( route->dev_chan );
 
   return 0;
 }
 
 double sink_impl::set_freq_corr( double ppm, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _freq_corr[ chan ] != ppm ) {
-          _freq_corr[ chan ] = ppm;
-          return dev->set_freq_corr( ppm, dev_chan );
-        } else { return _freq_corr[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _freq_corr[ chan ] != ppm ) {
+      _freq_corr[ chan ] = ppm;
+      return route->dev->set_freq_corr( ppm, route->dev_chan );
+    } else { return _freq_corr[ chan ]; }
+  }
 
   return 0;
 }
 
 double sink_impl::get_freq_corr( size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_freq_corr( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_freq_corr( route->dev_chan );
 
   return 0;
 }
 
 std::vector<std::string> sink_impl::get_gain_names( size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_names( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain_names( route->dev_chan );
 
   return std::vector< std::string >();
 }
 
 osmosdr::gain_range_t sink_impl::get_gain_range( size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_range( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain_range( route->dev_chan );
 
   return osmosdr::gain_range_t();
 }
 
 osmosdr::gain_range_t sink_impl::get_gain_range( const std::string & name, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_range( name, dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain_range( name, route->dev_chan );
 
   return osmosdr::gain_range_t();
 }
 
 bool sink_impl::set_gain_mode( bool automatic, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( (_gain_mode.count(chan) == 0) || (_gain_mode[ chan ] != automatic) ) {
-          _gain_mode[ chan ] = automatic;
-          bool mode = dev->set_gain_mode( automatic, dev_chan );
-          if (!automatic) // reapply gain value when switched to manual mode
-            dev->set_gain( _gain[ chan ], dev_chan );
-          return mode;
-        } else { return _gain_mode[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( (_gain_mode.count(chan) == 0) || (_gain_mode[ chan ] != automatic) ) {
+      _gain_mode[ chan ] = automatic;
+      bool mode = route->dev->set_gain_mode( automatic, route->dev_chan );
+      if (!automatic) // reapply gain value when switched to manual mode
+        route->dev->set_gain( _gain[ chan ], route->dev_chan );
+      return mode;
+    } else { return _gain_mode[ chan ]; }
+  }
 
   return false;
 }
 
 bool sink_impl::get_gain_mode( size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_mode( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain_mode( route->dev_chan );
 
   return false;
 }
 
 double sink_impl::set_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _gain[ chan ] != gain ) {
-          _gain[ chan ] = gain;
-          return dev->set_gain( gain, dev_chan );
-        } else { return _gain[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _gain[ chan ] != gain ) {
+      _gain[ chan ] = gain;
+      return route->dev->set_gain( gain, route->dev_chan );
+    } else { return _gain[ chan ]; }
+  }
 
   return 0;
 }
 
 double sink_impl::set_gain( double gain, const std::string & name, size_t chan)
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->set_gain( gain, name, dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->set_gain( gain, name, route->dev_chan );
 
   return 0;
 }
 
 double sink_impl::get_gain( size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain( route->dev_chan );
 
   return 0;
 }
 
 double sink_impl::get_gain( const std::string & name, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain( name, dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain( name, route->dev_chan );
 
   return 0;
 }
 
 double sink_impl::set_if_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _if_gain[ chan ] != gain ) {
-          _if_gain[ chan ] = gain;
-          return dev->set_if_gain( gain, dev_chan );
-        } else { return _if_gain[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _if_gain[ chan ] != gain ) {
+      _if_gain[ chan ] = gain;
+      return route->dev->set_if_gain( gain, route->dev_chan );
+    } else { return _if_gain[ chan ]; }
+  }
 
   return 0;
 }
 
 double sink_impl::set_bb_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _bb_gain[ chan ] != gain ) {
-          _bb_gain[ chan ] = gain;
-          return dev->set_bb_gain( gain, dev_chan );
-        } else { return _bb_gain[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _bb_gain[ chan ] != gain ) {
+      _bb_gain[ chan ] = gain;
+      return route->dev->set_bb_gain( gain, route->dev_chan );
+    } else { return _bb_gain[ chan ]; }
+  }
 
   return 0;
 }
 
 std::vector< std::string > sink_impl::get_antennas( size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_antennas( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_antennas( route->dev_chan );
 
   return std::vector< std::string >();
 }
 
 std::string sink_impl::set_antenna( const std::string & antenna, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _antenna[ chan ] != antenna ) {
-          _antenna[ chan ] = antenna;
-          return dev->set_antenna( antenna, dev_chan );
-        } else { return _antenna[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _antenna[ chan ] != antenna ) {
+      _antenna[ chan ] = antenna;
+      return route->dev->set_antenna( antenna, route->dev_chan );
+    } else { return _antenna[ chan ]; }
+  }
 
   return "";
 }
 
 std::string sink_impl::get_antenna( size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_antenna( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_antenna( route->dev_chan );
 
   return "";
 }
 
 void sink_impl::set_dc_offset( const std::complex<double> &offset, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        dev->set_dc_offset( offset, dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    route->dev->set_dc_offset( offset, route->dev_chan );
 }
 
 void sink_impl::set_iq_balance( const std::complex<double> &balance, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        dev->set_iq_balance( balance, dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    route->dev->set_iq_balance( balance, route->dev_chan );
 }
 
 double sink_impl::set_bandwidth( double bandwidth, size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _bandwidth[ chan ] != bandwidth || 0.0f == bandwidth ) {
-          _bandwidth[ chan ] = bandwidth;
-          return dev->set_bandwidth( bandwidth, dev_chan );
-        } else { return _bandwidth[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _bandwidth[ chan ] != bandwidth || 0.0f == bandwidth ) {
+      _bandwidth[ chan ] = bandwidth;
+      return route->dev->set_bandwidth( bandwidth, route->dev_chan );
+    } else { return _bandwidth[ chan ]; }
+  }
 
   return 0;
 }
 
 double sink_impl::get_bandwidth( size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_bandwidth( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_bandwidth( route->dev_chan );
 
   return 0;
 }
 
 osmosdr::freq_range_t sink_impl::get_bandwidth_range( size_t chan )
 {
-  size_t channel = 0;
-  for (sink_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_bandwidth_range( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_bandwidth_range( route->dev_chan );
 
   return osmosdr::freq_range_t();
 }
 
+osmosdr::stream_stats_t sink_impl::get_stream_stats( size_t chan )
+{
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_stream_stats( route->dev_chan );
+
+  return osmosdr::stream_stats_t();
+}
+
 void sink_impl::set_time_source(const std::string &source, const size_t mboard)
 {
   if (mboard != osmosdr::ALL_MBOARDS){
@@ -68,6 +68,8 @@ public:
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
   void set_time_source(const std::string &source, const size_t mboard = 0);
   std::string get_time_source(const size_t mboard);
   std::vector<std::string> get_time_sources(const size_t mboard);
@@ -83,7 +85,17 @@ public:
   void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
 
 private:
+  /* global channel -> owning device, built once the devices are set up */
+  struct channel_route_t
+  {
+    sink_iface *dev;
+    size_t dev_chan;
+  };
+
+  const channel_route_t *find_route( size_t chan ) const;
+
   std::vector< sink_iface * > _devs;
+  std::vector< channel_route_t > _routes;
 
   /* cache to prevent multiple device calls with the same value coming from grc */
   double _sample_rate;
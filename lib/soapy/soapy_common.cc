@@ -18,8 +18,14 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include "arg_helpers.h"
 #include "soapy_common.h"
 #include <SoapySDR/Version.hpp>
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Modules.hpp>
+#include <SoapySDR/Constants.h>
+
+#include <algorithm>
 
 osmosdr::gain_range_t soapy_range_to_gain_range(const SoapySDR::Range &r)
 {
@@ -36,6 +42,42 @@ osmosdr::gain_range_t soapy_range_to_gain_range(const SoapySDR::Range &r)
     return osmosdr::gain_range_t(r.minimum(), r.maximum(), step);
 }
 
+std::string soapy_caps_key(SoapySDR::Device *device, const std::string &args,
+                           const int direction)
+{
+    const SoapySDR::Kwargs info = device->getHardwareInfo();
+    dict_t dict = params_to_dict(args);
+
+    /* without a serial, devices of the same kind would share their entries */
+    bool have_serial = false;
+    for (const auto &kv : info)
+        if (kv.first.find("serial") != std::string::npos) have_serial = true;
+    for (const auto &kv : dict)
+        if (kv.first.find("serial") != std::string::npos) have_serial = true;
+    if (!have_serial) return "";
+
+    std::string key = "soapy " + device->getDriverKey() + " " + device->getHardwareKey();
+
+    for (const auto &kv : info)
+    {
+        key += " " + kv.first + "=" + kv.second;
+    }
+
+    /* the enumeration index and our own options don't change the ranges */
+    dict.erase("soapy");
+    dict.erase("caps_cache");
+    key += " args=" + dict_to_args_string(dict);
+
+    for (const std::string &path : SoapySDR::listModules())
+    {
+        key += " " + path + "=" + SoapySDR::getModuleVersion(path);
+    }
+
+    std::replace(key.begin(), key.end(), '\n', ' ');
+
+    return key + (direction == SOAPY_SDR_RX ? " rx" : " tx");
+}
+
 std::mutex &get_soapy_maker_mutex(void)
 {
     static std::mutex m;
@@ -25,6 +25,12 @@
 #include <SoapySDR/Types.hpp>
 
 #include <mutex>
+#include <string>
+
+namespace SoapySDR
+{
+    class Device;
+}
 
 /*!
  * Convert a soapy range to a gain range.
@@ -32,6 +38,15 @@
  */
 osmosdr::gain_range_t soapy_range_to_gain_range(const SoapySDR::Range &r);
 
+/*!
+ * Identify the hardware behind a device for the capability cache.
+ * The hardware info usually carries the serial and firmware versions,
+ * the construction args and module versions change what the driver
+ * reports. Empty, i.e. no caching, if there is no serial to go by.
+ */
+std::string soapy_caps_key(SoapySDR::Device *device, const std::string &args,
+                           const int direction);
+
 /*!
  * Global mutex to protect factory routines.
  * (optional under 0.5 release above)
@@ -30,6 +30,7 @@
 
 #include <iostream>
 #include <algorithm> //find
+#include <cmath>
 
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
@@ -38,10 +39,13 @@
 #include <gnuradio/io_signature.h>
 
 #include "arg_helpers.h"
+#include "convert_kernels.h"
 #include "soapy_sink_c.h"
 #include "soapy_common.h"
 #include <SoapySDR/Device.hpp>
 #include <SoapySDR/Version.hpp>
+#include <SoapySDR/Formats.h>
+#include <SoapySDR/Errors.h>
 
 using namespace boost::assign;
 
@@ -60,15 +64,55 @@ soapy_sink_c_sptr make_soapy_sink_c (const std::string &args)
 soapy_sink_c::soapy_sink_c (const std::string &args)
   : gr::sync_block ("soapy_sink_c",
                     args_to_io_signature(args),
-                    gr::io_signature::make (0, 0, 0))
+                    gr::io_signature::make (0, 0, 0)),
+    _stats(std::max(1, args_to_io_signature(args)->max_streams())),
+    _dropping(false)
 {
     {
         std::lock_guard<std::mutex> l(get_soapy_maker_mutex());
         _device = SoapySDR::Device::make(params_to_dict(args));
     }
+    if (args_to_caps_cache(args))
+        _caps.load(soapy_caps_key(_device, args, SOAPY_SDR_TX));
     _nchan = std::max(1, args_to_io_signature(args)->max_streams());
     std::vector<size_t> channels;
     for (size_t i = 0; i < _nchan; i++) channels.push_back(i);
+
+    _direct = false;
+    _direct_s8 = false;
+    _scale = 1.0f;
+    _da_bufs.resize(_nchan);
+
+    /*
+     * The DMA buffers hold the stream format, so direct access streams the
+     * native format and we convert into it ourselves.
+     */
+    dict_t dict = params_to_dict(args);
+    if (dict.count("direct_access") && boost::lexical_cast<bool>(dict["direct_access"]))
+    {
+        double full_scale = 0;
+        std::string native = _device->getNativeStreamFormat(SOAPY_SDR_TX, 0, full_scale);
+
+        if ((native == SOAPY_SDR_CS16 || native == SOAPY_SDR_CS8) && full_scale > 0)
+        {
+            _stream = _device->setupStream(SOAPY_SDR_TX, native, channels);
+            if (_device->getNumDirectAccessBuffers(_stream) > 0)
+            {
+                _direct = true;
+                _direct_s8 = (native == SOAPY_SDR_CS8);
+                _scale = float(full_scale);
+                return;
+            }
+
+            _device->closeStream(_stream);
+            std::cerr << "SoapySDR: direct access not supported by the driver, "
+                      << "using writeStream" << std::endl;
+        }
+        else
+            std::cerr << "SoapySDR: direct access not supported for native format "
+                      << native << ", using writeStream" << std::endl;
+    }
+
     _stream = _device->setupStream(SOAPY_SDR_TX, "CF32", channels);
 }
 
@@ -81,28 +125,189 @@ soapy_sink_c::~soapy_sink_c(void)
 
 bool soapy_sink_c::start()
 {
+    _next_status = std::chrono::steady_clock::now();
+    _dropping = false;
     return _device->activateStream(_stream) == 0;
 }
 
 bool soapy_sink_c::stop()
 {
+    this->poll_status();
     return _device->deactivateStream(_stream) == 0;
 }
 
+void soapy_sink_c::poll_status(void)
+{
+    _next_status = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+
+    /* drain what queued up since the last poll without blocking, the
+     * driver doesn't say how many zeros it sent on an underflow */
+    for (int n = 0; n < 64; n++)
+    {
+        size_t chanMask = 0;
+        int statusFlags = 0;
+        long long statusTimeNs = 0;
+        int status = _device->readStreamStatus(_stream, chanMask, statusFlags, statusTimeNs, 0);
+
+        if (status == SOAPY_SDR_UNDERFLOW)
+            for (size_t i = 0; i < _nchan; i++) _stats.underflow(0, i);
+        else if (status == SOAPY_SDR_TIME_ERROR)
+            for (size_t i = 0; i < _nchan; i++) _stats.late(i);
+        else if (status != 0)
+            break;
+    }
+}
+
 int soapy_sink_c::work( int noutput_items,
                             gr_vector_const_void_star &input_items,
                             gr_vector_void_star &output_items )
 {
     int flags = 0;
     long long timeNs = 0;
-    int ret = _device->writeStream(
-        _stream, &input_items[0],
-        noutput_items, flags, timeNs);
+    bool sob = false;
+    noutput_items = this->handle_tags(noutput_items, flags, timeNs, sob);
+
+    /* the rest of a burst that was too late, up to its tx_eob or the
+     * next burst, or it would go out untimed */
+    if (_dropping && sob) _dropping = false;
+    if (_dropping)
+    {
+        if (flags & SOAPY_SDR_END_BURST) _dropping = false;
+        return noutput_items;
+    }
+
+    int ret;
+    if (_direct)
+        ret = this->work_direct(noutput_items, input_items, flags, timeNs);
+    else
+    {
+        /* the driver may take only part of a write, so the last sample of a
+         * burst goes out on its own and the burst only ends once all of it
+         * was written */
+        if ((flags & SOAPY_SDR_END_BURST) && noutput_items > 1)
+        {
+            noutput_items--;
+            flags &= ~SOAPY_SDR_END_BURST;
+        }
+
+        ret = _device->writeStream(
+            _stream, &input_items[0],
+            noutput_items, flags, timeNs);
+    }
+
+    /* underflows and late bursts are reported asynchronously, look for
+     * them a few times a second rather than on every call */
+    if (std::chrono::steady_clock::now() >= _next_status)
+        this->poll_status();
+
+    /* the device didn't take anything in time, or will report the
+     * underflow through the stream status */
+    if (ret == SOAPY_SDR_TIMEOUT || ret == SOAPY_SDR_UNDERFLOW)
+        return 0; //call again
+
+    /* the burst is too late to be sent, drop all of it like UHD does
+     * rather than retrying the same timestamp forever */
+    if (ret == SOAPY_SDR_TIME_ERROR)
+    {
+        for (size_t i = 0; i < _nchan; i++) _stats.late(i);
+        _dropping = !(flags & SOAPY_SDR_END_BURST);
+        return noutput_items;
+    }
+
+    if (ret < 0)
+    {
+        std::cerr << "SoapySDR: writing the stream failed: "
+                  << SoapySDR_errToStr(ret) << std::endl;
+        return WORK_DONE;
+    }
 
-    if (ret < 0) return 0; //call again
     return ret;
 }
 
+/*
+ * Bursts are marked like for the UHD and bladeRF sinks: tx_sob on the first
+ * sample, tx_eob on the last one and tx_time, a tuple of integer and
+ * fractional seconds, on the first sample of a timed burst. Tags that
+ * don't sit on the first sample end the call right before them, or right
+ * after them for tx_eob, so every writeStream covers at most one burst
+ * boundary. sob tells if the call starts a burst.
+ */
+int soapy_sink_c::handle_tags(int noutput_items, int &flags, long long &timeNs, bool &sob)
+{
+    std::vector<gr::tag_t> tags;
+    const uint64_t start = nitems_read(0);
+
+    get_tags_in_window(tags, 0, 0, noutput_items);
+
+    /* the loop below relies on meeting the burst boundaries in order */
+    std::stable_sort(tags.begin(), tags.end(),
+        [](const gr::tag_t &a, const gr::tag_t &b) { return a.offset < b.offset; });
+
+    for (const gr::tag_t &tag : tags)
+    {
+        const int offset = int(tag.offset - start);
+        if (offset >= noutput_items) break;
+
+        const std::string key = pmt::symbol_to_string(tag.key);
+
+        if (key == "tx_eob")
+        {
+            noutput_items = offset + 1;
+            flags |= SOAPY_SDR_END_BURST;
+        }
+        else if (key == "tx_sob" || key == "tx_time")
+        {
+            if (offset > 0)
+            {
+                noutput_items = offset;
+                continue;
+            }
+
+            sob = true;
+
+            if (key == "tx_time" && pmt::is_tuple(tag.value))
+            {
+                const uint64_t secs = pmt::to_uint64(pmt::tuple_ref(tag.value, 0));
+                const double frac = pmt::to_double(pmt::tuple_ref(tag.value, 1));
+
+                flags |= SOAPY_SDR_HAS_TIME;
+                timeNs = (long long)(secs) * 1000000000LL + std::llround(frac * 1e9);
+            }
+        }
+    }
+
+    return noutput_items;
+}
+
+int soapy_sink_c::work_direct( int noutput_items,
+                               gr_vector_const_void_star &input_items,
+                               int flags, long long timeNs )
+{
+    size_t handle = 0;
+    int ret = _device->acquireWriteBuffer(_stream, handle, _da_bufs.data());
+
+    /* no buffer free yet, not an error */
+    if (ret == 0 || ret == SOAPY_SDR_TIMEOUT) return 0;
+    if (ret < 0) return ret;
+
+    /* a partially filled buffer is sent as is */
+    const size_t n = std::min(size_t(noutput_items), size_t(ret));
+    for (size_t i = 0; i < _nchan; i++)
+    {
+        const gr_complex *in = (const gr_complex *)input_items[i];
+        if (_direct_s8)
+            convert_fc32_s8(in, (int8_t *)_da_bufs[i], n, _scale);
+        else
+            convert_fc32_s16(in, (int16_t *)_da_bufs[i], n, _scale);
+    }
+
+    /* the burst only ends if all of it fit */
+    if (n < size_t(noutput_items)) flags &= ~SOAPY_SDR_END_BURST;
+    _device->releaseWriteBuffer(_stream, handle, n, flags, timeNs);
+
+    return n;
+}
+
 std::vector<std::string> soapy_sink_c::get_devices()
 {
     std::vector<std::string> result;
@@ -122,19 +327,22 @@ size_t soapy_sink_c::get_num_channels( void )
 
 osmosdr::meta_range_t soapy_sink_c::get_sample_rates( void )
 {
-    osmosdr::meta_range_t result;
-    #ifdef SOAPY_SDR_API_HAS_GET_SAMPLE_RATE_RANGE
-    for (const SoapySDR::Range &r : _device->getSampleRateRange(SOAPY_SDR_TX, 0))
-    {
-        result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
-    }
-    #else
-    for (const double rate : _device->listSampleRates(SOAPY_SDR_TX, 0))
+    return _caps.get("sample_rates", [&]()
     {
-        result.push_back(osmosdr::range_t(rate));
-    }
-    #endif
-    return result;
+        osmosdr::meta_range_t result;
+        #ifdef SOAPY_SDR_API_HAS_GET_SAMPLE_RATE_RANGE
+        for (const SoapySDR::Range &r : _device->getSampleRateRange(SOAPY_SDR_TX, 0))
+        {
+            result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
+        }
+        #else
+        for (const double rate : _device->listSampleRates(SOAPY_SDR_TX, 0))
+        {
+            result.push_back(osmosdr::range_t(rate));
+        }
+        #endif
+        return result;
+    });
 }
 
 double soapy_sink_c::set_sample_rate( double rate )
@@ -150,12 +358,15 @@ double soapy_sink_c::get_sample_rate( void )
 
 osmosdr::freq_range_t soapy_sink_c::get_freq_range( size_t chan)
 {
-    osmosdr::meta_range_t result;
-    for (const SoapySDR::Range r : _device->getFrequencyRange(SOAPY_SDR_TX, 0))
+    return _caps.get("freq_range", [&]()
     {
-        result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
-    }
-    return result;
+        osmosdr::meta_range_t result;
+        for (const SoapySDR::Range r : _device->getFrequencyRange(SOAPY_SDR_TX, 0))
+        {
+            result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
+        }
+        return result;
+    });
 }
 
 double soapy_sink_c::set_center_freq( double freq, size_t chan)
@@ -204,15 +415,21 @@ std::vector<std::string> soapy_sink_c::get_gain_names( size_t chan)
 
 osmosdr::gain_range_t soapy_sink_c::get_gain_range( size_t chan)
 {
-    SoapySDR::Range r = _device->getGainRange(SOAPY_SDR_TX, chan);
-    return soapy_range_to_gain_range(r);
+    return _caps.get("gain_range:" + std::to_string(chan), [&]()
+    {
+        SoapySDR::Range r = _device->getGainRange(SOAPY_SDR_TX, chan);
+        return soapy_range_to_gain_range(r);
+    });
 }
 
 osmosdr::gain_range_t soapy_sink_c::get_gain_range( const std::string & name,
                                                 size_t chan)
 {
-    SoapySDR::Range r = _device->getGainRange(SOAPY_SDR_TX, chan, name);
-    return soapy_range_to_gain_range(r);
+    return _caps.get("gain_range:" + std::to_string(chan) + ":" + name, [&]()
+    {
+        SoapySDR::Range r = _device->getGainRange(SOAPY_SDR_TX, chan, name);
+        return soapy_range_to_gain_range(r);
+    });
 }
 
 bool soapy_sink_c::set_gain_mode( bool automatic, size_t chan)
@@ -307,19 +524,27 @@ double soapy_sink_c::get_bandwidth( size_t chan)
 
 osmosdr::freq_range_t soapy_sink_c::get_bandwidth_range( size_t chan)
 {
-    osmosdr::meta_range_t result;
-    #ifdef SOAPY_SDR_API_HAS_GET_BANDWIDTH_RANGE
-    for (const SoapySDR::Range &r : _device->getBandwidthRange(SOAPY_SDR_TX, 0))
-    {
-        result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
-    }
-    #else
-    for (const double bw : _device->listBandwidths(SOAPY_SDR_TX, 0))
+    return _caps.get("bandwidth_range", [&]()
     {
-        result.push_back(osmosdr::range_t(bw));
-    }
-    #endif
-    return result;
+        osmosdr::meta_range_t result;
+        #ifdef SOAPY_SDR_API_HAS_GET_BANDWIDTH_RANGE
+        for (const SoapySDR::Range &r : _device->getBandwidthRange(SOAPY_SDR_TX, 0))
+        {
+            result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
+        }
+        #else
+        for (const double bw : _device->listBandwidths(SOAPY_SDR_TX, 0))
+        {
+            result.push_back(osmosdr::range_t(bw));
+        }
+        #endif
+        return result;
+    });
+}
+
+osmosdr::stream_stats_t soapy_sink_c::get_stream_stats( size_t chan )
+{
+    return _stats.get(chan);
 }
 
 void soapy_sink_c::set_time_source(const std::string &source,
@@ -24,8 +24,13 @@
 #include <gnuradio/block.h>
 #include <gnuradio/sync_block.h>
 
+#include <chrono>
+#include <vector>
+
 #include "osmosdr/ranges.h"
 #include "sink_iface.h"
+#include "caps_cache.h"
+#include "stream_counters.h"
 
 class soapy_sink_c;
 
@@ -112,6 +117,7 @@ void set_iq_balance( const std::complex<double> &balance, size_t chan);
 double set_bandwidth( double bandwidth, size_t chan);
 double get_bandwidth( size_t chan);
 osmosdr::freq_range_t get_bandwidth_range( size_t chan);
+osmosdr::stream_stats_t get_stream_stats( size_t chan );
 void set_time_source(const std::string &source,
                                const size_t mboard);
 std::string get_time_source(const size_t mboard);
@@ -130,9 +136,24 @@ void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
 void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
 
 private:
+    int handle_tags(int noutput_items, int &flags, long long &timeNs, bool &sob);
+    void poll_status(void);
+    int work_direct(int noutput_items, gr_vector_const_void_star &input_items,
+                    int flags, long long timeNs);
+
     SoapySDR::Device *_device;
     SoapySDR::Stream *_stream;
     size_t _nchan;
+    stream_counters _stats;
+    std::chrono::steady_clock::time_point _next_status;
+    caps_cache _caps;
+    bool _dropping;     /* the rest of a late burst is discarded */
+
+    /* direct_access=1, convert straight into the driver's DMA buffers */
+    bool _direct;
+    bool _direct_s8;    /* CS8 rather than CS16 */
+    float _scale;       /* full scale of the native format */
+    std::vector< void * > _da_bufs;
 };
 
 #endif /* INCLUDED_SOAPY_SINK_C_H */
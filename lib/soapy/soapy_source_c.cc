@@ -30,6 +30,8 @@
 
 #include <iostream>
 #include <algorithm> //find
+#include <cmath>
+#include <cstring>
 
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
@@ -38,11 +40,13 @@
 #include <gnuradio/io_signature.h>
 
 #include "arg_helpers.h"
+#include "convert_kernels.h"
 #include "soapy_source_c.h"
 #include "soapy_common.h"
 #include "osmosdr/source.h"
 #include <SoapySDR/Device.hpp>
 #include <SoapySDR/Version.hpp>
+#include <SoapySDR/Formats.h>
 
 using namespace boost::assign;
 
@@ -61,16 +65,110 @@ soapy_source_c_sptr make_soapy_source_c (const std::string &args)
 soapy_source_c::soapy_source_c (const std::string &args)
   : gr::sync_block ("soapy_source_c",
                     gr::io_signature::make (0, 0, 0),
-                    args_to_io_signature(args))
+                    args_to_io_signature(args,
+                      cpu_format_item_size(args_to_cpu_format(args)))),
+    _stats(std::max(1, args_to_io_signature(args)->max_streams())),
+    _tagger([this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+            gr::sync_block::name(), std::max(1, args_to_io_signature(args)->max_streams()))
 {
     {
         std::lock_guard<std::mutex> l(get_soapy_maker_mutex());
         _device = SoapySDR::Device::make(params_to_dict(args));
     }
+    if (args_to_caps_cache(args))
+        _caps.load(soapy_caps_key(_device, args, SOAPY_SDR_RX));
     _nchan = std::max(1, args_to_io_signature(args)->max_streams());
+    _rate = 0;
+    _overflows = 0;
+    _next_time_ns = -1;
     std::vector<size_t> channels;
     for (size_t i = 0; i < _nchan; i++) channels.push_back(i);
-    _stream = _device->setupStream(SOAPY_SDR_RX, "CF32", channels);
+
+    /*
+     * Stream the native format of the device and convert it with our own
+     * kernels, drivers often do that in scalar code. Integer outputs that
+     * match the native format are passed through untouched, everything
+     * else is left to SoapySDR. native_format=0 always lets SoapySDR
+     * convert.
+     */
+    dict_t dict = params_to_dict(args);
+    double full_scale = 0;
+    std::string native = _device->getNativeStreamFormat(SOAPY_SDR_RX, 0, full_scale);
+
+    if (dict.count("native_format") && !boost::lexical_cast<bool>(dict["native_format"]))
+        native.clear();
+    if (full_scale <= 0)
+        native.clear();
+
+    /* the integer conversions shift, so only power of two scales will do */
+    int bits = full_scale > 0 ? int(std::lround(std::log2(full_scale))) : 0;
+    bool pow2 = bits > 0 && std::ldexp(1.0, bits) == full_scale;
+
+    _cpu_format = args_to_cpu_format(args);
+    _wire_format = WIRE_NONE;
+    _scale = 1.0f;
+    _shift = 0;
+
+    std::string format;
+    switch (_cpu_format)
+    {
+    case CPU_FORMAT_SC16:
+        format = SOAPY_SDR_CS16;
+        if (native == SOAPY_SDR_CS16 && pow2 && bits < 15)
+        {
+            _wire_format = WIRE_CS16;
+            _shift = 15 - bits;
+        }
+        break;
+    case CPU_FORMAT_SC8:
+        format = SOAPY_SDR_CS8;
+        if (native == SOAPY_SDR_CS16 && pow2 && bits > 7)
+        {
+            format = SOAPY_SDR_CS16;
+            _wire_format = WIRE_CS16;
+            _shift = bits - 7;
+        }
+        break;
+    default:
+        format = SOAPY_SDR_CF32;
+        if (native == SOAPY_SDR_CS16) _wire_format = WIRE_CS16;
+        else if (native == SOAPY_SDR_CS12) _wire_format = WIRE_CS12;
+        else if (native == SOAPY_SDR_CS8) _wire_format = WIRE_CS8;
+
+        if (_wire_format != WIRE_NONE)
+        {
+            format = native;
+            _scale = float(1.0 / full_scale);
+        }
+        break;
+    }
+
+    _wire_size = SoapySDR_formatToSize(format.c_str());
+    _wire_bufs.resize(_nchan);
+    _wire_ptrs.resize(_nchan);
+
+    _stream = _device->setupStream(SOAPY_SDR_RX, format, channels);
+
+    /* the DMA buffers hold the stream format, so only native streams qualify */
+    _direct = false;
+    _da_handle = 0;
+    _da_avail = 0;
+    _da_offset = 0;
+    _da_flags = 0;
+    _da_bufs.resize(_nchan);
+    _da_ptrs.resize(_nchan);
+
+    if (dict.count("direct_access") && boost::lexical_cast<bool>(dict["direct_access"]))
+    {
+        if (format != native)
+            std::cerr << "SoapySDR: direct access needs the native stream format "
+                      << native << ", using readStream" << std::endl;
+        else if (_device->getNumDirectAccessBuffers(_stream) == 0)
+            std::cerr << "SoapySDR: direct access not supported by the driver, "
+                      << "using readStream" << std::endl;
+        else
+            _direct = true;
+    }
 }
 
 soapy_source_c::~soapy_source_c(void)
@@ -82,11 +180,28 @@ soapy_source_c::~soapy_source_c(void)
 
 bool soapy_source_c::start()
 {
+    _rate = this->get_sample_rate();
+    _overflows = 0;
+    _next_time_ns = -1;
+
+    _tagger.set_rate(_rate);
+    for (size_t i = 0; i < _nchan; i++) _tagger.set_freq(this->get_center_freq(i), i);
+    _tagger.start();
+
     return _device->activateStream(_stream) == 0;
 }
 
 bool soapy_source_c::stop()
 {
+    if (_da_avail)
+    {
+        _device->releaseReadBuffer(_stream, _da_handle);
+        _da_avail = 0;
+    }
+
+    for (; _overflows > 0; _overflows--)
+        for (size_t i = 0; i < _nchan; i++) _stats.overflow(0, i);
+
     return _device->deactivateStream(_stream) == 0;
 }
 
@@ -94,21 +209,148 @@ int soapy_source_c::work( int noutput_items,
                             gr_vector_const_void_star &input_items,
                             gr_vector_void_star &output_items )
 {
+    if (_direct) return this->work_direct(noutput_items, output_items);
+
     int flags = 0;
     long long timeNs = 0;
     int ret;
     int retries = 1;
+    void * const *buffs = &output_items[0];
+
+    /* read the native format into our own buffers for conversion */
+    if (_wire_format != WIRE_NONE)
+    {
+        const size_t bytes = noutput_items * _wire_size;
+        for (size_t i = 0; i < _nchan; i++)
+        {
+            if (_wire_bufs[i].size() < bytes) _wire_bufs[i].resize(bytes);
+            _wire_ptrs[i] = _wire_bufs[i].data();
+        }
+        buffs = _wire_ptrs.data();
+    }
 
     do {
         ret = _device->readStream(
-            _stream, &output_items[0],
+            _stream, buffs,
             noutput_items, flags, timeNs);
+
+        if (ret == SOAPY_SDR_OVERFLOW)
+        {
+            _overflows++;
+            _tagger.discontinuity();
+        }
     } while (retries-- && (ret == SOAPY_SDR_OVERFLOW));
 
     if (ret < 0) return 0; //call again
+
+    this->tag_buffer(flags, timeNs, ret);
+
+    /* the driver lost samples after this buffer */
+    if (flags & SOAPY_SDR_END_ABRUPT) _tagger.discontinuity();
+
+    if (_wire_format != WIRE_NONE)
+        this->convert(buffs, &output_items[0], ret);
+
     return ret;
 }
 
+int soapy_source_c::work_direct( int noutput_items,
+                                 gr_vector_void_star &output_items )
+{
+    /* a DMA buffer is held across calls until all of it was handed out */
+    if (_da_avail == 0)
+    {
+        long long timeNs = 0;
+        int ret = _device->acquireReadBuffer(
+            _stream, _da_handle, _da_bufs.data(), _da_flags, timeNs);
+
+        if (ret == SOAPY_SDR_OVERFLOW)
+        {
+            _overflows++;
+            _tagger.discontinuity();
+        }
+
+        if (ret <= 0) return 0; //call again
+
+        _da_avail = ret;
+        _da_offset = 0;
+        this->tag_buffer(_da_flags, timeNs, ret);
+    }
+
+    const size_t n = std::min(size_t(noutput_items), _da_avail);
+    for (size_t i = 0; i < _nchan; i++)
+        _da_ptrs[i] = (const char *)_da_bufs[i] + _da_offset * _wire_size;
+
+    this->convert(_da_ptrs.data(), &output_items[0], n);
+
+    _da_offset += n;
+    _da_avail -= n;
+
+    if (_da_avail == 0)
+    {
+        _device->releaseReadBuffer(_stream, _da_handle);
+        if (_da_flags & SOAPY_SDR_END_ABRUPT) _tagger.discontinuity();
+    }
+
+    return n;
+}
+
+void soapy_source_c::tag_buffer(int flags, long long timeNs, size_t nitems)
+{
+    /* the driver doesn't say how much was lost, but the gap between the
+     * timestamps does if the stream has them */
+    if (_overflows > 0)
+    {
+        uint64_t dropped = 0;
+        if ((flags & SOAPY_SDR_HAS_TIME) && _next_time_ns >= 0 && timeNs > _next_time_ns)
+            dropped = std::llround((timeNs - _next_time_ns) * _rate / 1e9);
+
+        for (size_t i = 0; i < _nchan; i++) _stats.overflow(dropped, i);
+        for (_overflows--; _overflows > 0; _overflows--)
+            for (size_t i = 0; i < _nchan; i++) _stats.overflow(0, i);
+    }
+
+    if ((flags & SOAPY_SDR_HAS_TIME) && _rate > 0)
+        _next_time_ns = timeNs + std::llround(nitems * 1e9 / _rate);
+    else
+        _next_time_ns = -1;
+
+    if (flags & SOAPY_SDR_HAS_TIME)
+    {
+        const osmosdr::time_spec_t time = osmosdr::time_spec_t::from_ticks(timeNs, 1e9);
+        _tagger.tag(nitems_written(0), &time);
+    }
+    else _tagger.tag(nitems_written(0));
+}
+
+void soapy_source_c::convert(const void * const *in, void * const *out, size_t nitems)
+{
+    for (size_t i = 0; i < _nchan; i++)
+    {
+        switch (_wire_format)
+        {
+        case WIRE_CS16:
+            if (_cpu_format == CPU_FORMAT_SC16)
+                convert_s16_sc16((const int16_t *)in[i], (int16_t *)out[i], nitems, _shift);
+            else if (_cpu_format == CPU_FORMAT_SC8)
+                convert_s16_sc8((const int16_t *)in[i], (int8_t *)out[i], nitems, _shift);
+            else
+                convert_s16_fc32((const int16_t *)in[i], (gr_complex *)out[i], nitems, _scale);
+            break;
+        case WIRE_CS12:
+            convert_s12p_fc32((const uint8_t *)in[i], (gr_complex *)out[i], nitems, _scale);
+            break;
+        case WIRE_CS8:
+            convert_s8_fc32((const int8_t *)in[i], (gr_complex *)out[i], nitems, _scale);
+            break;
+        default:
+            /* native format passed through, only in direct mode */
+            memcpy(out[i], in[i], nitems * _wire_size);
+            break;
+        }
+    }
+}
+
 std::vector<std::string> soapy_source_c::get_devices()
 {
     std::vector<std::string> result;
@@ -128,25 +370,31 @@ size_t soapy_source_c::get_num_channels( void )
 
 osmosdr::meta_range_t soapy_source_c::get_sample_rates( void )
 {
-    osmosdr::meta_range_t result;
-    #ifdef SOAPY_SDR_API_HAS_GET_SAMPLE_RATE_RANGE
-    for (const SoapySDR::Range &r : _device->getSampleRateRange(SOAPY_SDR_RX, 0))
-    {
-        result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
-    }
-    #else
-    for (const double rate : _device->listSampleRates(SOAPY_SDR_RX, 0))
+    return _caps.get("sample_rates", [&]()
     {
-        result.push_back(osmosdr::range_t(rate));
-    }
-    #endif
-    return result;
+        osmosdr::meta_range_t result;
+        #ifdef SOAPY_SDR_API_HAS_GET_SAMPLE_RATE_RANGE
+        for (const SoapySDR::Range &r : _device->getSampleRateRange(SOAPY_SDR_RX, 0))
+        {
+            result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
+        }
+        #else
+        for (const double rate : _device->listSampleRates(SOAPY_SDR_RX, 0))
+        {
+            result.push_back(osmosdr::range_t(rate));
+        }
+        #endif
+        return result;
+    });
 }
 
 double soapy_source_c::set_sample_rate( double rate )
 {
     _device->setSampleRate(SOAPY_SDR_RX, 0, rate);
-    return this->get_sample_rate();
+    _rate = this->get_sample_rate();
+    _next_time_ns = -1;
+    _tagger.set_rate(_rate);
+    return _rate;
 }
 
 double soapy_source_c::get_sample_rate( void )
@@ -156,17 +404,21 @@ double soapy_source_c::get_sample_rate( void )
 
 osmosdr::freq_range_t soapy_source_c::get_freq_range( size_t chan )
 {
-    osmosdr::meta_range_t result;
-    for (const SoapySDR::Range r : _device->getFrequencyRange(SOAPY_SDR_RX, 0))
+    return _caps.get("freq_range", [&]()
     {
-        result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
-    }
-    return result;
+        osmosdr::meta_range_t result;
+        for (const SoapySDR::Range r : _device->getFrequencyRange(SOAPY_SDR_RX, 0))
+        {
+            result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
+        }
+        return result;
+    });
 }
 
 double soapy_source_c::set_center_freq( double freq, size_t chan )
 {
     _device->setFrequency(SOAPY_SDR_RX, chan, freq);
+    _tagger.set_freq(this->get_center_freq(chan), chan);
     return this->get_center_freq(chan);
 }
 
@@ -210,15 +462,21 @@ std::vector<std::string> soapy_source_c::get_gain_names( size_t chan )
 
 osmosdr::gain_range_t soapy_source_c::get_gain_range( size_t chan )
 {
-    SoapySDR::Range r = _device->getGainRange(SOAPY_SDR_RX, chan);
-    return soapy_range_to_gain_range(r);
+    return _caps.get("gain_range:" + std::to_string(chan), [&]()
+    {
+        SoapySDR::Range r = _device->getGainRange(SOAPY_SDR_RX, chan);
+        return soapy_range_to_gain_range(r);
+    });
 }
 
 osmosdr::gain_range_t soapy_source_c::get_gain_range( const std::string & name,
                                                 size_t chan )
 {
-    SoapySDR::Range r = _device->getGainRange(SOAPY_SDR_RX, chan, name);
-    return soapy_range_to_gain_range(r);
+    return _caps.get("gain_range:" + std::to_string(chan) + ":" + name, [&]()
+    {
+        SoapySDR::Range r = _device->getGainRange(SOAPY_SDR_RX, chan, name);
+        return soapy_range_to_gain_range(r);
+    });
 }
 
 bool soapy_source_c::set_gain_mode( bool automatic, size_t chan )
@@ -336,19 +594,27 @@ double soapy_source_c::get_bandwidth( size_t chan )
 
 osmosdr::freq_range_t soapy_source_c::get_bandwidth_range( size_t chan )
 {
-    osmosdr::meta_range_t result;
-    #ifdef SOAPY_SDR_API_HAS_GET_BANDWIDTH_RANGE
-    for (const SoapySDR::Range &r : _device->getBandwidthRange(SOAPY_SDR_RX, 0))
+    return _caps.get("bandwidth_range", [&]()
     {
-        result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
-    }
-    #else
-    for (const double bw : _device->listBandwidths(SOAPY_SDR_RX, 0))
-    {
-        result.push_back(osmosdr::range_t(bw));
-    }
-    #endif
-    return result;
+        osmosdr::meta_range_t result;
+        #ifdef SOAPY_SDR_API_HAS_GET_BANDWIDTH_RANGE
+        for (const SoapySDR::Range &r : _device->getBandwidthRange(SOAPY_SDR_RX, 0))
+        {
+            result.push_back(osmosdr::range_t(r.minimum(), r.maximum()));
+        }
+        #else
+        for (const double bw : _device->listBandwidths(SOAPY_SDR_RX, 0))
+        {
+            result.push_back(osmosdr::range_t(bw));
+        }
+        #endif
+        return result;
+    });
+}
+
+osmosdr::stream_stats_t soapy_source_c::get_stream_stats( size_t chan )
+{
+    return _stats.get(chan);
 }
 
 void soapy_source_c::set_time_source(const std::string &source,
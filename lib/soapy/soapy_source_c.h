@@ -24,8 +24,14 @@
 #include <gnuradio/block.h>
 #include <gnuradio/sync_block.h>
 
+#include <vector>
+
 #include "osmosdr/ranges.h"
 #include "source_iface.h"
+#include "arg_helpers.h"
+#include "caps_cache.h"
+#include "stream_counters.h"
+#include "rx_tagger.h"
 
 class soapy_source_c;
 
@@ -114,6 +120,7 @@ void set_iq_balance( const std::complex<double> &balance, size_t chan );
 double set_bandwidth( double bandwidth, size_t chan );
 double get_bandwidth( size_t chan ) ;
 osmosdr::freq_range_t get_bandwidth_range( size_t chan );
+osmosdr::stream_stats_t get_stream_stats( size_t chan );
 void set_time_source(const std::string &source,
                                const size_t mboard);
 std::string get_time_source(const size_t mboard);
@@ -132,9 +139,42 @@ void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
 void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
 
 private:
+    int work_direct(int noutput_items, gr_vector_void_star &output_items);
+    void tag_buffer(int flags, long long timeNs, size_t nitems);
+    void convert(const void * const *in, void * const *out, size_t nitems);
+
     SoapySDR::Device *_device;
     SoapySDR::Stream *_stream;
     size_t _nchan;
+    stream_counters _stats;
+    caps_cache _caps;
+    rx_tagger _tagger;
+
+    /* overflows since the last buffer, counted once the next timestamp
+     * tells how much was lost; _next_time_ns < 0 if there is none */
+    double _rate;
+    int _overflows;
+    long long _next_time_ns;
+
+    /* stream format read from the device when we convert ourselves */
+    enum wire_format_t { WIRE_NONE, WIRE_CS16, WIRE_CS12, WIRE_CS8 };
+
+    cpu_format_t _cpu_format;
+    wire_format_t _wire_format;
+    size_t _wire_size;  /* bytes per IQ pair */
+    float _scale;       /* 1 / full scale of the native format */
+    int _shift;         /* full scale to the range of the integer cpu format */
+    std::vector< std::vector<char> > _wire_bufs;
+    std::vector< void * > _wire_ptrs;
+
+    /* direct_access=1, convert straight out of the driver's DMA buffers */
+    bool _direct;
+    size_t _da_handle;
+    size_t _da_avail;   /* items left in the acquired buffer */
+    size_t _da_offset;  /* items already consumed from it */
+    int _da_flags;
+    std::vector< const void * > _da_bufs;
+    std::vector< const void * > _da_ptrs;
 };
 
 #endif /* INCLUDED_SOAPY_SOURCE_C_H */
@@ -23,6 +23,7 @@
 
 #include <osmosdr/ranges.h>
 #include <osmosdr/time_spec.h>
+#include <osmosdr/stream_stats.h>
 #include <gnuradio/basic_block.h>
 
 /*!
@@ -291,6 +292,34 @@ public:
   virtual osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 )
     { return osmosdr::freq_range_t(); }
 
+  /*!
+   * Get the overflow/underflow counters of the device.
+   * \param chan the channel index 0 to N-1
+   * \return the counters accumulated since the device has been opened
+   */
+  virtual osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 )
+    { return osmosdr::stream_stats_t(); }
+
+  /*!
+   * Prepare fast retuning to a list of frequencies.
+   * \param freqs the center frequencies in Hz
+   * \param chan the channel index 0 to N-1
+   * \return the number of frequencies prepared
+   */
+  virtual size_t set_retune_presets( const std::vector<double> &freqs,
+                                     size_t chan = 0 ) { return 0; }
+
+  /*!
+   * Retune a channel at the given device time.
+   * \param freq the new center frequency in Hz
+   * \param time the device time of the retune, zero retunes immediately
+   * \param chan the channel index 0 to N-1
+   * \return true if the retune has been scheduled
+   */
+  virtual bool schedule_retune( double freq,
+                                const ::osmosdr::time_spec_t &time,
+                                size_t chan = 0 ) { return false; }
+
   /*!
    * Set the time source for the device.
    * This sets the method of time synchronization,
@@ -30,73 +30,15 @@
 #include <gnuradio/io_signature.h>
 #include <gnuradio/blocks/null_source.h>
 #include <gnuradio/blocks/throttle.h>
+#include <gnuradio/blocks/complex_to_interleaved_short.h>
+#include <gnuradio/blocks/complex_to_interleaved_char.h>
 #include <gnuradio/constants.h>
 
-#ifdef ENABLE_FCD
-#include <fcd_source_c.h>
-#endif
-
-#ifdef ENABLE_FILE
-#include <file_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL
-#include <rtl_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL_TCP
-#include <rtl_tcp_source_c.h>
-#endif
-
-#ifdef ENABLE_UHD
-#include <uhd_source_c.h>
-#endif
-
-#ifdef ENABLE_MIRI
-#include <miri_source_c.h>
-#endif
-
-#ifdef ENABLE_SDRPLAY
-#include <sdrplay_source_c.h>
-#endif
-
-#ifdef ENABLE_HACKRF
-#include <hackrf_source_c.h>
-#endif
-
-#ifdef ENABLE_BLADERF
-#include <bladerf_source_c.h>
-#endif
-
-#ifdef ENABLE_RFSPACE
-#include <rfspace_source_c.h>
-#endif
-
-#ifdef ENABLE_AIRSPY
-#include <airspy_source_c.h>
-#endif
-
-#ifdef ENABLE_AIRSPYHF
-#include <airspyhf_source_c.h>
-#endif
-
-#ifdef ENABLE_SOAPY
-#include <soapy_source_c.h>
-#endif
-
-#ifdef ENABLE_REDPITAYA
-#include <redpitaya_source_c.h>
-#endif
-
-#ifdef ENABLE_FREESRP
-#include <freesrp_source_c.h>
-#endif
-
-#ifdef ENABLE_XTRX
-#include <xtrx_source_c.h>
-#endif
-
 #include "arg_helpers.h"
+#include "device_enum.h"
+#include "backend_loader.h"
+#include "stats_publisher.h"
+#include "command_handler.h"
 #include "source_impl.h"
 
 /*
@@ -109,154 +51,54 @@ osmosdr::source::make( const std::string &args )
   return gnuradio::get_initial_sptr( new source_impl(args) );
 }
 
+/*
+ * Used for devices that can only deliver complex float samples when an
+ * integer cpu_format has been requested.
+ */
+static gr::basic_block_sptr make_format_converter( cpu_format_t format )
+{
+  if ( CPU_FORMAT_SC8 == format )
+    return gr::blocks::complex_to_interleaved_char::make( true, 128.0f );
+
+  return gr::blocks::complex_to_interleaved_short::make( true, 32768.0f );
+}
+
 /*
  * The private constructor
  */
 source_impl::source_impl( const std::string &args )
   : gr::hier_block2 ("source_impl",
         gr::io_signature::make(0, 0, 0),
-        args_to_io_signature(args)),
+        args_to_io_signature(args,
+          cpu_format_item_size(args_to_cpu_format(args)))),
     _sample_rate(NAN)
 {
   size_t channel = 0;
   bool device_specified = false;
+  cpu_format_t cpu_format = args_to_cpu_format(args);
 
   std::vector< std::string > arg_list = args_to_vector(args);
 
-  std::vector< std::string > dev_types;
-
-#ifdef ENABLE_FILE
-  dev_types.push_back("file");
-#endif
-#ifdef ENABLE_FCD
-  dev_types.push_back("fcd");
-#endif
-#ifdef ENABLE_RTL
-  dev_types.push_back("rtl");
-#endif
-#ifdef ENABLE_RTL_TCP
-  dev_types.push_back("rtl_tcp");
-#endif
-#ifdef ENABLE_UHD
-  dev_types.push_back("uhd");
-#endif
-#ifdef ENABLE_MIRI
-  dev_types.push_back("miri");
-#endif
-#ifdef ENABLE_SDRPLAY
-  dev_types.push_back("sdrplay");
-#endif
-#ifdef ENABLE_HACKRF
-  dev_types.push_back("hackrf");
-#endif
-#ifdef ENABLE_BLADERF
-  dev_types.push_back("bladerf");
-#endif
-#ifdef ENABLE_RFSPACE
-  dev_types.push_back("rfspace");
-#endif
-#ifdef ENABLE_AIRSPY
-  dev_types.push_back("airspy");
-#endif
-#ifdef ENABLE_AIRSPYHF
-  dev_types.push_back("airspyhf");
-#endif
-#ifdef ENABLE_SOAPY
-  dev_types.push_back("soapy");
-#endif
-#ifdef ENABLE_REDPITAYA
-  dev_types.push_back("redpitaya");
-#endif
-#ifdef ENABLE_FREESRP
-  dev_types.push_back("freesrp");
-#endif
-#ifdef ENABLE_XTRX
-  dev_types.push_back("xtrx");
-#endif
   std::cerr << "gr-osmosdr "
             << GR_OSMOSDR_VERSION << " (" << GR_OSMOSDR_LIBVER << ") "
             << "gnuradio " << gr::version() << std::endl;
   std::cerr << "built-in source types: ";
-  for (std::string dev_type : dev_types)
+  for (std::string dev_type : backend_device_types( BACKEND_SOURCE ))
     std::cerr << dev_type << " ";
   std::cerr << std::endl;
 
-#ifdef ENABLE_RFSPACE
-  dev_types.push_back("sdr-iq"); /* additional aliases for rfspace backend */
-  dev_types.push_back("sdr-ip");
-  dev_types.push_back("netsdr");
-  dev_types.push_back("cloudiq");
-  dev_types.push_back("cloudsdr");
-#endif
-
   for (std::string arg : arg_list) {
-    dict_t dict = params_to_dict(arg);
-    for (std::string dev_type : dev_types) {
-      if ( dict.count( dev_type ) ) {
-        device_specified = true;
-        break;
-      }
+    if ( backend_for_args( params_to_dict(arg), BACKEND_SOURCE ).size() ) {
+      device_specified = true;
+      break;
     }
   }
 
   if ( ! device_specified ) {
-    std::vector< std::string > dev_list;
-#ifdef ENABLE_FCD
-    for (std::string dev : fcd_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_RTL
-    for (std::string dev : rtl_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_UHD
-    for (std::string dev : uhd_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_MIRI
-    for (std::string dev : miri_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_SDRPLAY
-    for (std::string dev : sdrplay_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_BLADERF
-    for (std::string dev : bladerf_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_RFSPACE
-    for (std::string dev : rfspace_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_HACKRF
-    for (std::string dev : hackrf_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_AIRSPY
-    for (std::string dev : airspy_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_AIRSPYHF
-    for (std::string dev : airspyhf_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_SOAPY
-    for (std::string dev : soapy_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_REDPITAYA
-    for (std::string dev : redpitaya_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_FREESRP
-    for (std::string dev : freesrp_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_XTRX
-    for (std::string dev : xtrx_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
+    /* the first backend reporting a device wins, don't wait for the rest */
+    std::vector< std::string > dev_list =
+        registry_enumerate( backend_enumerators( BACKEND_SOURCE ),
+                            args_to_enum_timeout_ms(args), true );
 
 //    std::cerr << std::endl;
 //    for (std::string dev : dev_list)
@@ -272,6 +114,14 @@ source_impl::source_impl( const std::string &args )
 
     dict_t dict = params_to_dict(arg);
 
+    /* pass a globally given cpu_format on to every device */
+    if ( CPU_FORMAT_FC32 != cpu_format && ! dict.count("cpu_format") )
+      arg += ",cpu_format=" + cpu_format_to_string(cpu_format);
+
+    /* same for disabling the capability cache */
+    if ( ! args_to_caps_cache(args) && ! dict.count("caps_cache") )
+      arg += ",caps_cache=0";
+
 //    std::cerr << std::endl;
 //    for (dict_t::value_type &entry : dict)
 //      std::cerr << "'" << entry.first << "' = '" << entry.second << "'" << std::endl;
@@ -279,142 +129,62 @@ source_impl::source_impl( const std::string &args )
     source_iface *iface = NULL;
     gr::basic_block_sptr block;
 
-#ifdef ENABLE_FCD
-    if ( dict.count("fcd") ) {
-      fcd_source_c_sptr src = make_fcd_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_FILE
-    if ( dict.count("file") ) {
-      file_source_c_sptr src = make_file_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_RTL
-    if ( dict.count("rtl") ) {
-      rtl_source_c_sptr src = make_rtl_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_RTL_TCP
-    if ( dict.count("rtl_tcp") ) {
-      rtl_tcp_source_c_sptr src = make_rtl_tcp_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_UHD
-    if ( dict.count("uhd") ) {
-      uhd_source_c_sptr src = make_uhd_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_MIRI
-    if ( dict.count("miri") ) {
-      miri_source_c_sptr src = make_miri_source_c( arg );
-      block = src; iface = src.get();
+    std::string backend = backend_for_args( dict, BACKEND_SOURCE );
+    if ( backend.size() ) {
+      const osmosdr_backend_t *b = backend_load( backend );
+      if ( b->make_source )
+        iface = b->make_source( arg, block );
     }
-#endif
 
-#ifdef ENABLE_SDRPLAY
-    if ( dict.count("sdrplay") ) {
-      sdrplay_source_c_sptr src = make_sdrplay_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+    if (iface != NULL && reinterpret_cast<std::intptr_t>(block.get()) != 0 ) {
+      _devs.push_back( iface );
 
-#ifdef ENABLE_HACKRF
-    if ( dict.count("hackrf") ) {
-      hackrf_source_c_sptr src = make_hackrf_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+      /* devices without native integer support get converted in software */
+      size_t item_size = block->output_signature()->sizeof_stream_item( 0 );
+      bool convert = item_size != cpu_format_item_size( cpu_format );
 
-#ifdef ENABLE_BLADERF
-    if ( dict.count("bladerf") ) {
-      bladerf_source_c_sptr src = make_bladerf_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+      if ( convert && item_size != sizeof(gr_complex) )
+        throw std::runtime_error("Device does not support cpu_format=" +
+                                 cpu_format_to_string(cpu_format) + ".");
 
-#ifdef ENABLE_RFSPACE
-    if ( dict.count("rfspace") ||
-         dict.count("sdr-iq") ||
-         dict.count("sdr-ip") ||
-         dict.count("netsdr") ||
-         dict.count("cloudiq") ||
-         dict.count("cloudsdr") ) {
-      rfspace_source_c_sptr src = make_rfspace_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+      for (size_t i = 0; i < iface->get_num_channels(); i++) {
+        gr::basic_block_sptr src = block;
+        int port = i;
 
-#ifdef ENABLE_AIRSPY
-    if ( dict.count("airspy") ) {
-      airspy_source_c_sptr src = make_airspy_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+        channel_route_t route = channel_route_t();
+        route.dev = iface;
+        route.dev_chan = i;
 
-#ifdef ENABLE_AIRSPYHF
-    if ( dict.count("airspyhf") ) {
-      airspyhf_source_c_sptr src = make_airspyhf_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+#ifdef HAVE_IQBALANCE
+        /* the correction only works on complex float streams */
+        if ( CPU_FORMAT_FC32 == cpu_format ) {
+          gr::iqbalance::optimize_c::sptr iq_opt = gr::iqbalance::optimize_c::make( 0 );
+          gr::iqbalance::fix_cc::sptr     iq_fix = gr::iqbalance::fix_cc::make();
 
-#ifdef ENABLE_SOAPY
-    if ( dict.count("soapy") ) {
-      soapy_source_c_sptr src = make_soapy_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+          connect(block, i, iq_fix, 0);
 
-#ifdef ENABLE_REDPITAYA
-    if ( dict.count("redpitaya") ) {
-      redpitaya_source_c_sptr src = make_redpitaya_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+          connect(block, i, iq_opt, 0);
+          msg_connect(iq_opt, "iqbal_corr", iq_fix, "iqbal_corr");
 
-#ifdef ENABLE_FREESRP
-    if ( dict.count("freesrp") ) {
-      freesrp_source_c_sptr src = make_freesrp_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+          route.iq_opt = iq_opt.get();
+          route.iq_fix = iq_fix.get();
 
-#ifdef ENABLE_XTRX
-    if ( dict.count("xtrx") ) {
-      xtrx_source_c_sptr src = make_xtrx_source_c( arg );
-      block = src; iface = src.get();
-    }
+          src = iq_fix;
+          port = 0;
+        }
 #endif
+        if ( convert ) {
+          gr::basic_block_sptr conv = make_format_converter( cpu_format );
 
-    if (iface != NULL && reinterpret_cast<std::intptr_t>(block.get()) != 0 ) {
-      _devs.push_back( iface );
-
-      for (size_t i = 0; i < iface->get_num_channels(); i++) {
-#ifdef HAVE_IQBALANCE
-        gr::iqbalance::optimize_c::sptr iq_opt = gr::iqbalance::optimize_c::make( 0 );
-        gr::iqbalance::fix_cc::sptr     iq_fix = gr::iqbalance::fix_cc::make();
+          connect(src, port, conv, 0);
 
-        connect(block, i, iq_fix, 0);
-        connect(iq_fix, 0, self(), channel++);
+          src = conv;
+          port = 0;
+        }
 
-        connect(block, i, iq_opt, 0);
-        msg_connect(iq_opt, "iqbal_corr", iq_fix, "iqbal_corr");
+        connect(src, port, self(), channel++);
 
-        _iq_opt.push_back( iq_opt.get() );
-        _iq_fix.push_back( iq_fix.get() );
-#else
-        connect(block, i, self(), channel++);
-#endif
+        _routes.push_back( route );
       }
     } else if ((iface != NULL) || (reinterpret_cast<std::intptr_t>(block.get()) != 0))
       throw std::runtime_error("Either iface or block are NULL.");
@@ -425,30 +195,44 @@ source_impl::source_impl( const std::string &args )
     throw std::runtime_error("No devices specified via device arguments.");
 
   /* Populate the _gain and _gain_mode arrays with the hardware state */
-  for ( source_iface *dev : _devs )
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++) {
-      _gain_mode[dev_chan] = dev->get_gain_mode(dev_chan);
-      _gain[dev_chan] = dev->get_gain(dev_chan);
-    }
+  for (size_t chan = 0; chan < _routes.size(); chan++) {
+    _gain_mode[chan] = _routes[chan].dev->get_gain_mode( _routes[chan].dev_chan );
+    _gain[chan] = _routes[chan].dev->get_gain( _routes[chan].dev_chan );
+  }
+
+  /* overflow/underflow counters, published every stats_ms if requested */
+  stats_publisher_sptr stats = make_stats_publisher( [this]() {
+      std::vector< osmosdr::stream_stats_t > all;
+      for (size_t chan = 0; chan < get_num_channels(); chan++)
+        all.push_back( get_stream_stats( chan ) );
+      return all;
+    }, args_to_stats_ms(args) );
+
+  message_port_register_hier_out( pmt::mp("stats") );
+  msg_connect( stats, pmt::mp("stats"), self(), pmt::mp("stats") );
+
+  /* retune requests, see handle_command() */
+  command_handler_sptr command = make_command_handler(
+      [this]( pmt::pmt_t msg ) { handle_command( msg ); } );
+
+  message_port_register_hier_in( pmt::mp("command") );
+  msg_connect( self(), pmt::mp("command"), command, pmt::mp("command") );
 }
 
 size_t source_impl::get_num_channels()
 {
-  size_t channels = 0;
-
-  for (source_iface *dev : _devs)
-    channels += dev->get_num_channels();
+  return _routes.size();
+}
 
-  return channels;
+const source_impl::channel_route_t *source_impl::find_route( size_t chan ) const
+{
+  return chan < _routes.size() ? &_routes[chan] : NULL;
 }
 
 bool source_impl::seek( long seek_point, int whence, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->seek( seek_point, whence, dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->seek( seek_point, whence, route->dev_chan );
 
   return false;
 }
@@ -479,19 +263,12 @@ double source_impl::set_sample_rate(double rate)
       sample_rate = dev->set_sample_rate(rate);
 
 #ifdef HAVE_IQBALANCE
-    size_t channel = 0;
-    for (source_iface *dev : _devs) {
-      for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++) {
-        if ( channel < _iq_opt.size() ) {
-          gr::iqbalance::optimize_c *opt = _iq_opt[channel];
-
-          if ( opt->period() > 0 ) { /* optimize is enabled */
-            opt->set_period( dev->get_sample_rate() / 5 );
-            opt->reset();
-          }
-        }
+    for (const channel_route_t &route : _routes) {
+      gr::iqbalance::optimize_c *opt = route.iq_opt;
 
-        channel++;
+      if ( opt && opt->period() > 0 ) { /* optimize is enabled */
+        opt->set_period( route.dev->get_sample_rate() / 5 );
+        opt->reset();
       }
     }
 #endif
@@ -517,367 +294,350 @@ double source_impl::get_sample_rate()
 
 osmosdr::freq_range_t source_impl::get_freq_range( size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_freq_range( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_freq_range( route->dev_chan );
 
   return osmosdr::freq_range_t();
 }
 
 double source_impl::set_center_freq( double freq, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _center_freq[ chan ] != freq ) {
-          _center_freq[ chan ] = freq;
-          return dev->set_center_freq( freq, dev_chan );
-        } else { return _center_freq[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _center_freq[ chan ] != freq ) {
+      _center_freq[ chan ] = freq;
+      return route->dev->set_center_freq( freq, route->dev_chan );
+    } else { return _center_freq[ chan ]; }
+  }
 
   return 0;
 }
 
 double source_impl::get_center_freq( size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_center_freq( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_center_freq( route->dev_chan );
 
   return 0;
 }
 
 double source_impl::set_freq_corr( double ppm, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _freq_corr[ chan ] != ppm ) {
-          _freq_corr[ chan ] = ppm;
-          return dev->set_freq_corr( ppm, dev_chan );
-        } else { return _freq_corr[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _freq_corr[ chan ] != ppm ) {
+      _freq_corr[ chan ] = ppm;
+      return route->dev->set_freq_corr( ppm, route->dev_chan );
+    } else { return _freq_corr[ chan ]; }
+  }
 
   return 0;
 }
 
 double source_impl::get_freq_corr( size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_freq_corr( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_freq_corr( route->dev_chan );
 
   return 0;
 }
 
 std::vector<std::string> source_impl::get_gain_names( size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_names( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain_names( route->dev_chan );
 
   return std::vector< std::string >();
 }
 
 osmosdr::gain_range_t source_impl::get_gain_range( size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_range( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain_range( route->dev_chan );
 
   return osmosdr::gain_range_t();
 }
 
 osmosdr::gain_range_t source_impl::get_gain_range( const std::string & name, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_range( name, dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain_range( name, route->dev_chan );
 
   return osmosdr::gain_range_t();
 }
 
 bool source_impl::set_gain_mode( bool automatic, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( (_gain_mode.count(chan) == 0) || (_gain_mode[ chan ] != automatic) ) {
-          _gain_mode[ chan ] = automatic;
-          bool mode = dev->set_gain_mode( automatic, dev_chan );
-          if (!automatic) // reapply gain value when switched to manual mode
-            dev->set_gain( _gain[ chan ], dev_chan );
-          return mode;
-        } else { return _gain_mode[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( (_gain_mode.count(chan) == 0) || (_gain_mode[ chan ] != automatic) ) {
+      _gain_mode[ chan ] = automatic;
+      bool mode = route->dev->set_gain_mode( automatic, route->dev_chan );
+      if (!automatic) // reapply gain value when switched to manual mode
+        route->dev->set_gain( _gain[ chan ], route->dev_chan );
+      return mode;
+    } else { return _gain_mode[ chan ]; }
+  }
 
   return false;
 }
 
 bool source_impl::get_gain_mode( size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain_mode( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain_mode( route->dev_chan );
 
   return false;
 }
 
 double source_impl::set_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _gain[ chan ] != gain ) {
-          _gain[ chan ] = gain;
-          return dev->set_gain( gain, dev_chan );
-        } else { return _gain[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _gain[ chan ] != gain ) {
+      _gain[ chan ] = gain;
+      return route->dev->set_gain( gain, route->dev_chan );
+    } else { return _gain[ chan ]; }
+  }
 
   return 0;
 }
 
 double source_impl::set_gain( double gain, const std::string & name, size_t chan)
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->set_gain( gain, name, dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->set_gain( gain, name, route->dev_chan );
 
   return 0;
 }
 
 double source_impl::get_gain( size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain( route->dev_chan );
 
   return 0;
 }
 
 double source_impl::get_gain( const std::string & name, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_gain( name, dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_gain( name, route->dev_chan );
 
   return 0;
 }
 
 double source_impl::set_if_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _if_gain[ chan ] != gain ) {
-          _if_gain[ chan ] = gain;
-          return dev->set_if_gain( gain, dev_chan );
-        } else { return _if_gain[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _if_gain[ chan ] != gain ) {
+      _if_gain[ chan ] = gain;
+      return route->dev->set_if_gain( gain, route->dev_chan );
+    } else { return _if_gain[ chan ]; }
+  }
 
   return 0;
 }
 
 double source_impl::set_bb_gain( double gain, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _bb_gain[ chan ] != gain ) {
-          _bb_gain[ chan ] = gain;
-          return dev->set_bb_gain( gain, dev_chan );
-        } else { return _bb_gain[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _bb_gain[ chan ] != gain ) {
+      _bb_gain[ chan ] = gain;
+      return route->dev->set_bb_gain( gain, route->dev_chan );
+    } else { return _bb_gain[ chan ]; }
+  }
 
   return 0;
 }
 
 std::vector< std::string > source_impl::get_antennas( size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_antennas( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_antennas( route->dev_chan );
 
   return std::vector< std::string >();
 }
 
 std::string source_impl::set_antenna( const std::string & antenna, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _antenna[ chan ] != antenna ) {
-          _antenna[ chan ] = antenna;
-          return dev->set_antenna( antenna, dev_chan );
-        } else { return _antenna[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _antenna[ chan ] != antenna ) {
+      _antenna[ chan ] = antenna;
+      return route->dev->set_antenna( antenna, route->dev_chan );
+    } else { return _antenna[ chan ]; }
+  }
 
   return "";
 }
 
 std::string source_impl::get_antenna( size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_antenna( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_antenna( route->dev_chan );
 
   return "";
 }
 
 void source_impl::set_dc_offset_mode( int mode, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        dev->set_dc_offset_mode( mode, dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    route->dev->set_dc_offset_mode( mode, route->dev_chan );
 }
 
 void source_impl::set_dc_offset( const std::complex<double> &offset, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        dev->set_dc_offset( offset, dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    route->dev->set_dc_offset( offset, route->dev_chan );
 }
 
 void source_impl::set_iq_balance_mode( int mode, size_t chan )
 {
-  size_t channel = 0;
+  const channel_route_t *route = find_route( chan );
+  if ( ! route )
+    return;
+
 #ifdef HAVE_IQBALANCE
-  for (source_iface *dev : _devs) {
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++) {
-      if ( chan == channel++ ) {
-        if ( chan < _iq_opt.size() && chan < _iq_fix.size() ) {
-          gr::iqbalance::optimize_c *opt = _iq_opt[chan];
-          gr::iqbalance::fix_cc *fix = _iq_fix[chan];
-
-          if ( IQBalanceOff == mode  ) {
-            opt->set_period( 0 );
-            /* store current values in order to be able to restore them later */
-            _vals[ chan ] = std::pair< float, float >( fix->mag(), fix->phase() );
-            fix->set_mag( 0.0f );
-            fix->set_phase( 0.0f );
-          } else if ( IQBalanceManual == mode ) {
-            if ( opt->period() == 0 ) { /* transition from Off to Manual */
-              /* restore previous values */
-              std::pair< float, float > val = _vals[ chan ];
-              fix->set_mag( val.first );
-              fix->set_phase( val.second );
-            }
-            opt->set_period( 0 );
-          } else if ( IQBalanceAutomatic == mode ) {
-            opt->set_period( dev->get_sample_rate() / 5 );
-            opt->reset();
-          }
-        }
+  if ( route->iq_opt && route->iq_fix ) {
+    gr::iqbalance::optimize_c *opt = route->iq_opt;
+    gr::iqbalance::fix_cc *fix = route->iq_fix;
+
+    if ( IQBalanceOff == mode  ) {
+      opt->set_period( 0 );
+      /* store current values in order to be able to restore them later */
+      _vals[ chan ] = std::pair< float, float >( fix->mag(), fix->phase() );
+      fix->set_mag( 0.0f );
+      fix->set_phase( 0.0f );
+    } else if ( IQBalanceManual == mode ) {
+      if ( opt->period() == 0 ) { /* transition from Off to Manual */
+        /* restore previous values */
+        std::pair< float, float > val = _vals[ chan ];
+        fix->set_mag( val.first );
+        fix->set_phase( val.second );
       }
+      opt->set_period( 0 );
+    } else if ( IQBalanceAutomatic == mode ) {
+      opt->set_period( route->dev->get_sample_rate() / 5 );
+      opt->reset();
     }
+
+    return;
   }
-#else
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->set_iq_balance_mode( mode, dev_chan );
 #endif
+
+  /* no correction blocks inserted, e.g. for cpu_format=sc16|sc8 */
+  route->dev->set_iq_balance_mode( mode, route->dev_chan );
 }
 
 void source_impl::set_iq_balance( const std::complex<double> &balance, size_t chan )
 {
-  size_t channel = 0;
+  const channel_route_t *route = find_route( chan );
+  if ( ! route )
+    return;
+
 #ifdef HAVE_IQBALANCE
-  for (source_iface *dev : _devs) {
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++) {
-      if ( chan == channel++ ) {
-        if ( chan < _iq_opt.size() && chan < _iq_fix.size() ) {
-          gr::iqbalance::optimize_c *opt = _iq_opt[chan];
-          gr::iqbalance::fix_cc *fix = _iq_fix[chan];
-
-          if ( opt->period() == 0 ) { /* automatic optimization desabled */
-            fix->set_mag( balance.real() );
-            fix->set_phase( balance.imag() );
-          }
-        }
-      }
+  if ( route->iq_opt && route->iq_fix ) {
+    if ( route->iq_opt->period() == 0 ) { /* automatic optimization desabled */
+      route->iq_fix->set_mag( balance.real() );
+      route->iq_fix->set_phase( balance.imag() );
     }
+
+    return;
   }
-#else
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->set_iq_balance( balance, dev_chan );
 #endif
+
+  /* no correction blocks inserted, e.g. for cpu_format=sc16|sc8 */
+  route->dev->set_iq_balance( balance, route->dev_chan );
 }
 
 double source_impl::set_bandwidth( double bandwidth, size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ ) {
-        if ( _bandwidth[ chan ] != bandwidth || 0.0f == bandwidth ) {
-          _bandwidth[ chan ] = bandwidth;
-          return dev->set_bandwidth( bandwidth, dev_chan );
-        } else { return _bandwidth[ chan ]; }
-      }
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( _bandwidth[ chan ] != bandwidth || 0.0f == bandwidth ) {
+      _bandwidth[ chan ] = bandwidth;
+      return route->dev->set_bandwidth( bandwidth, route->dev_chan );
+    } else { return _bandwidth[ chan ]; }
+  }
 
   return 0;
 }
 
 double source_impl::get_bandwidth( size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_bandwidth( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_bandwidth( route->dev_chan );
 
   return 0;
 }
 
 osmosdr::freq_range_t source_impl::get_bandwidth_range( size_t chan )
 {
-  size_t channel = 0;
-  for (source_iface *dev : _devs)
-    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->get_bandwidth_range( dev_chan );
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_bandwidth_range( route->dev_chan );
 
   return osmosdr::freq_range_t();
 }
 
+osmosdr::stream_stats_t source_impl::get_stream_stats( size_t chan )
+{
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->get_stream_stats( route->dev_chan );
+
+  return osmosdr::stream_stats_t();
+}
+
+size_t source_impl::set_retune_presets( const std::vector<double> &freqs, size_t chan )
+{
+  if ( const channel_route_t *route = find_route( chan ) )
+    return route->dev->set_retune_presets( freqs, route->dev_chan );
+
+  return 0;
+}
+
+bool source_impl::schedule_retune( double freq, const osmosdr::time_spec_t &time,
+                                   size_t chan )
+{
+  if ( const channel_route_t *route = find_route( chan ) ) {
+    if ( ! route->dev->schedule_retune( freq, time, route->dev_chan ) )
+      return false;
+
+    _center_freq[ chan ] = freq;
+    return true;
+  }
+
+  return false;
+}
+
+/*
+ * Handles dictionaries on the "command" port:
+ * ((freq . 433.92e6) (chan . 0) (time . (secs . frac)))
+ * Without a time the channel is retuned immediately.
+ */
+void source_impl::handle_command( pmt::pmt_t msg )
+{
+  if ( ! pmt::is_dict( msg ) ) {
+    std::cerr << "source: ignoring command that is not a dictionary" << std::endl;
+    return;
+  }
+
+  pmt::pmt_t freq = pmt::dict_ref( msg, pmt::mp("freq"), pmt::PMT_NIL );
+  pmt::pmt_t chan = pmt::dict_ref( msg, pmt::mp("chan"), pmt::from_long( 0 ) );
+  pmt::pmt_t time = pmt::dict_ref( msg, pmt::mp("time"), pmt::PMT_NIL );
+
+  if ( ! pmt::is_number( freq ) )
+    return;
+
+  try {
+    if ( pmt::is_tuple( time ) ) {
+      osmosdr::time_spec_t when( pmt::to_uint64( pmt::tuple_ref( time, 0 ) ),
+                                 pmt::to_double( pmt::tuple_ref( time, 1 ) ) );
+
+      if ( ! schedule_retune( pmt::to_double( freq ), when, pmt::to_long( chan ) ) )
+        std::cerr << "source: timed retune is not supported" << std::endl;
+    } else {
+      set_center_freq( pmt::to_double( freq ), pmt::to_long( chan ) );
+    }
+  } catch ( const std::exception &ex ) {
+    std::cerr << "source: command failed: " << ex.what() << std::endl;
+  }
+}
+
 void source_impl::set_time_source(const std::string &source, const size_t mboard)
 {
   if (mboard != osmosdr::ALL_MBOARDS){
@@ -77,6 +77,12 @@ public:
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
+  size_t set_retune_presets( const std::vector<double> &freqs, size_t chan = 0 );
+  bool schedule_retune( double freq, const ::osmosdr::time_spec_t &time,
+                        size_t chan = 0 );
+
   void set_time_source(const std::string &source, const size_t mboard = 0);
   std::string get_time_source(const size_t mboard);
   std::vector<std::string> get_time_sources(const size_t mboard);
@@ -92,7 +98,23 @@ public:
   void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
 
 private:
+  /* global channel -> owning device, built once the devices are set up */
+  struct channel_route_t
+  {
+    source_iface *dev;
+    size_t dev_chan;
+#ifdef HAVE_IQBALANCE
+    gr::iqbalance::optimize_c *iq_opt; /* NULL unless cpu_format=fc32 */
+    gr::iqbalance::fix_cc *iq_fix;
+#endif
+  };
+
+  const channel_route_t *find_route( size_t chan ) const;
+
+  void handle_command( pmt::pmt_t msg );
+
   std::vector< source_iface * > _devs;
+  std::vector< channel_route_t > _routes;
 
   /* cache to prevent multiple device calls with the same value coming from grc */
   double _sample_rate;
@@ -104,8 +126,6 @@ private:
   std::map< size_t, double > _bb_gain;
   std::map< size_t, std::string > _antenna;
 #ifdef HAVE_IQBALANCE
-  std::vector< gr::iqbalance::fix_cc * > _iq_fix;
-  std::vector< gr::iqbalance::optimize_c * > _iq_opt;
   std::map< size_t, std::pair<float, float> > _vals;
 #endif
   std::map< size_t, double > _bandwidth;
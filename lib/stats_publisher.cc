@@ -0,0 +1,113 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <chrono>
+
+#include <gnuradio/io_signature.h>
+
+#include "stats_publisher.h"
+
+static const pmt::pmt_t STATS_PORT = pmt::mp("stats");
+
+stats_publisher_sptr make_stats_publisher( const stats_poll_t &poll,
+                                           unsigned int interval_ms )
+{
+  return gnuradio::get_initial_sptr( new stats_publisher( poll, interval_ms ) );
+}
+
+stats_publisher::stats_publisher( const stats_poll_t &poll,
+                                  unsigned int interval_ms )
+  : gr::block( "stats_publisher",
+               gr::io_signature::make( 0, 0, 0 ),
+               gr::io_signature::make( 0, 0, 0 ) ),
+    _poll( poll ),
+    _interval_ms( interval_ms ),
+    _running( false )
+{
+  message_port_register_out( STATS_PORT );
+}
+
+stats_publisher::~stats_publisher()
+{
+  stop();
+}
+
+bool stats_publisher::start()
+{
+  if ( 0 == _interval_ms || _running )
+    return true;
+
+  _running = true;
+  _thread = gr::thread::thread( std::bind( &stats_publisher::run, this ) );
+
+  return true;
+}
+
+bool stats_publisher::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _running = false;
+  }
+  _cond.notify_all();
+
+  if ( _thread.joinable() )
+    _thread.join();
+
+  return true;
+}
+
+void stats_publisher::run()
+{
+  std::unique_lock<std::mutex> lock( _mutex );
+
+  while ( _running ) {
+    _cond.wait_for( lock, std::chrono::milliseconds( _interval_ms ) );
+
+    if ( ! _running )
+      break;
+
+    /* don't hold the lock while talking to the backends */
+    lock.unlock();
+
+    std::vector< osmosdr::stream_stats_t > stats = _poll();
+
+    for ( size_t chan = 0; chan < stats.size(); chan++ ) {
+      pmt::pmt_t msg = pmt::make_dict();
+
+      msg = pmt::dict_add( msg, pmt::mp("chan"), pmt::from_uint64( chan ) );
+      msg = pmt::dict_add( msg, pmt::mp("overflows"), pmt::from_uint64( stats[chan].overflows ) );
+      msg = pmt::dict_add( msg, pmt::mp("dropped"), pmt::from_uint64( stats[chan].dropped ) );
+      msg = pmt::dict_add( msg, pmt::mp("underflows"), pmt::from_uint64( stats[chan].underflows ) );
+      msg = pmt::dict_add( msg, pmt::mp("inserted"), pmt::from_uint64( stats[chan].inserted ) );
+      msg = pmt::dict_add( msg, pmt::mp("late"), pmt::from_uint64( stats[chan].late ) );
+
+      message_port_pub( STATS_PORT, msg );
+    }
+
+    lock.lock();
+  }
+}
@@ -0,0 +1,80 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_STATS_PUBLISHER_H
+#define OSMOSDR_STATS_PUBLISHER_H
+
+#include <gnuradio/block.h>
+#include <gnuradio/thread/thread.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <osmosdr/stream_stats.h>
+
+class stats_publisher;
+
+typedef std::shared_ptr< stats_publisher > stats_publisher_sptr;
+
+/* returns the current counters of every channel */
+typedef std::function< std::vector< osmosdr::stream_stats_t >() > stats_poll_t;
+
+stats_publisher_sptr make_stats_publisher( const stats_poll_t &poll,
+                                           unsigned int interval_ms );
+
+/*!
+ * \brief Message only block publishing stream counters periodically.
+ *
+ * Every interval_ms a dictionary per channel is sent to the "stats" port:
+ * ((chan . N) (overflows . N) (dropped . N) (underflows . N) (inserted . N)
+ *  (late . N))
+ * An interval of 0 disables publishing.
+ */
+class stats_publisher : public gr::block
+{
+private:
+  friend stats_publisher_sptr make_stats_publisher( const stats_poll_t &poll,
+                                                    unsigned int interval_ms );
+
+  stats_publisher( const stats_poll_t &poll, unsigned int interval_ms );
+
+public:
+  ~stats_publisher();
+
+  bool start();
+  bool stop();
+
+private:
+  void run();
+
+  stats_poll_t _poll;
+  unsigned int _interval_ms;
+
+  gr::thread::thread _thread;
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  bool _running;
+};
+
+#endif // OSMOSDR_STATS_PUBLISHER_H
@@ -0,0 +1,114 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OSMOSDR_STREAM_COUNTERS_H
+#define OSMOSDR_STREAM_COUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <osmosdr/stream_stats.h>
+
+/*!
+ * \brief Per channel overflow/underflow/late burst counters of a backend.
+ *
+ * Backends bump these from whatever context notices the condition (driver
+ * callbacks included) instead of writing "O" or "U" to stderr. Updates are
+ * relaxed atomic increments, so they are cheap enough for the data path and
+ * never block. get() may be called from any thread.
+ */
+class stream_counters
+{
+public:
+  explicit stream_counters( size_t nchan = 1 )
+    : _chans( nchan ? nchan : 1 )
+  {
+  }
+
+  size_t size() const { return _chans.size(); }
+
+  /* samples were lost because the host fell behind, dropped may be 0 if
+   * the device doesn't tell how many */
+  void overflow( uint64_t dropped, size_t chan = 0 )
+  {
+    if ( chan >= _chans.size() )
+      return;
+
+    _chans[chan].overflows.fetch_add( 1, std::memory_order_relaxed );
+    _chans[chan].dropped.fetch_add( dropped, std::memory_order_relaxed );
+  }
+
+  /* the device ran dry and sent inserted samples in place of ours */
+  void underflow( uint64_t inserted, size_t chan = 0 )
+  {
+    if ( chan >= _chans.size() )
+      return;
+
+    _chans[chan].underflows.fetch_add( 1, std::memory_order_relaxed );
+    _chans[chan].inserted.fetch_add( inserted, std::memory_order_relaxed );
+  }
+
+  /* a timed burst reached the device after its time had passed */
+  void late( size_t chan = 0 )
+  {
+    if ( chan >= _chans.size() )
+      return;
+
+    _chans[chan].late.fetch_add( 1, std::memory_order_relaxed );
+  }
+
+  osmosdr::stream_stats_t get( size_t chan = 0 ) const
+  {
+    osmosdr::stream_stats_t stats;
+
+    if ( chan >= _chans.size() )
+      return stats;
+
+    stats.overflows = _chans[chan].overflows.load( std::memory_order_relaxed );
+    stats.dropped = _chans[chan].dropped.load( std::memory_order_relaxed );
+    stats.underflows = _chans[chan].underflows.load( std::memory_order_relaxed );
+    stats.inserted = _chans[chan].inserted.load( std::memory_order_relaxed );
+    stats.late = _chans[chan].late.load( std::memory_order_relaxed );
+
+    return stats;
+  }
+
+  stream_counters( const stream_counters & ) = delete;
+  stream_counters &operator=( const stream_counters & ) = delete;
+
+private:
+  struct channel
+  {
+    channel() : overflows(0), dropped(0), underflows(0), inserted(0), late(0) {}
+
+    std::atomic<uint64_t> overflows;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> underflows;
+    std::atomic<uint64_t> inserted;
+    std::atomic<uint64_t> late;
+  };
+
+  std::vector<channel> _chans;
+};
+
+#endif // OSMOSDR_STREAM_COUNTERS_H
@@ -52,7 +52,8 @@ uhd_source_c::uhd_source_c(const std::string &args) :
                    gr::io_signature::make(0, 0, 0),
                    gr::io_signature::make(parse_nchan(args),
                                           parse_nchan(args),
-                                          sizeof(gr_complex))),
+                                          cpu_format_item_size(
+                                            args_to_cpu_format(args)))),
     _center_freq(0.0f),
     _freq_corr(0.0f),
     _lo_offset(0.0f)
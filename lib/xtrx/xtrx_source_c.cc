@@ -84,10 +84,12 @@ xtrx_source_c::xtrx_source_c(const std::string &args) :
   _tdd(false),
   _fbctrl(false),
   _timekey(false),
-  _dsp(0)
+  _dsp(0),
+  _tagger([this](size_t chan, const gr::tag_t &tag) { add_item_tag(chan, tag); },
+          gr::sync_block::name(), parse_nchan(args)),
+  _stats(parse_nchan(args)),
+  _next_sample(0)
 {
-  _id = pmt::string_to_symbol(args);
-
   dict_t dict = params_to_dict(args);
 
   if (dict.count("otw_format")) {
@@ -231,6 +233,7 @@ double xtrx_source_c::set_sample_rate( double rate )
 {
   std::cerr << "Set sample rate " << rate << std::endl;
   _rate = _xtrx->set_smaplerate(rate, _master, false, _sample_flags);
+  _tagger.set_rate(_rate);
   return get_sample_rate();
 }
 
@@ -267,6 +270,8 @@ double xtrx_source_c::set_center_freq( double freq, size_t chan )
 
   res = xtrx_tune_ex(_xtrx->dev(), XTRX_TUNE_BB_RX, xchan, _dsp, NULL);
 
+  _tagger.set_freq(_freq, chan);
+
   return get_center_freq(chan);
 }
 
@@ -514,23 +519,21 @@ int xtrx_source_c::work (int noutput_items,
     throw std::runtime_error( message.str() );
   }
 
-  if (_timekey) {
-    uint64_t seconds = (ri.out_first_sample / _rate);
-    double fractional = (ri.out_first_sample - (uint64_t)(_rate * seconds)) / _rate;
-
-    //std::cerr << "Time " << seconds << ":" << fractional << std::endl;
-    const pmt::pmt_t val = pmt::make_tuple
-        (pmt::from_uint64(seconds),
-         pmt::from_double(fractional));
-    for(size_t i = 0; i < output_items.size(); i++) {
-      this->add_item_tag(i, nitems_written(0), TIME_KEY,
-                         val, _id);
-      this->add_item_tag(i, nitems_written(0), RATE_KEY,
-                         pmt::from_double(_rate), _id);
-      this->add_item_tag(i, nitems_written(0), FREQ_KEY,
-                         pmt::from_double(this->get_center_freq(i)), _id);
-    }
-  }
+  /* old samples get dropped on overflow, which shows as a jump of the
+   * hardware sample counter; timekey=1 tags every buffer regardless */
+  if (ri.out_first_sample > _next_sample)
+    for (unsigned i = 0; i < _channels; i++)
+      _stats.overflow(ri.out_first_sample - _next_sample, i);
+
+  if (_timekey || ri.out_first_sample != _next_sample)
+    _tagger.discontinuity();
+
+  _next_sample = ri.out_first_sample + ri.out_samples;
+
+  const osmosdr::time_spec_t time =
+      osmosdr::time_spec_t::from_ticks(ri.out_first_sample, _rate);
+  _tagger.tag(nitems_written(0), &time);
+
   return ri.out_samples;
 }
 
@@ -538,6 +541,12 @@ bool xtrx_source_c::start()
 {
   boost::mutex::scoped_lock lock(_xtrx->mtx);
 
+  _tagger.set_rate(_rate);
+  for (unsigned i = 0; i < _channels; i++)
+    _tagger.set_freq(_freq, i);
+  _tagger.start();
+  _next_sample = 0;
+
   xtrx_run_params_t params;
   xtrx_run_params_init(&params);
 
@@ -581,3 +590,8 @@ bool xtrx_source_c::stop()
 
   return res == 0;
 }
+
+osmosdr::stream_stats_t xtrx_source_c::get_stream_stats( size_t chan )
+{
+  return _stats.get( chan );
+}
@@ -24,12 +24,10 @@
 #include <gnuradio/sync_block.h>
 
 #include "source_iface.h"
+#include "rx_tagger.h"
+#include "stream_counters.h"
 #include "xtrx_obj.h"
 
-static const pmt::pmt_t TIME_KEY = pmt::string_to_symbol("rx_time");
-static const pmt::pmt_t RATE_KEY = pmt::string_to_symbol("rx_rate");
-static const pmt::pmt_t FREQ_KEY = pmt::string_to_symbol("rx_freq");
-
 class xtrx_source_c;
 
 typedef std::shared_ptr< xtrx_source_c > xtrx_source_c_sptr;
@@ -91,9 +89,10 @@ public:
   bool start();
   bool stop();
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
 private:
   xtrx_obj_sptr _xtrx;
-  pmt::pmt_t _id;
 
   unsigned _sample_flags;
   double _rate;
@@ -122,6 +121,10 @@ private:
 
   double   _dsp;
   std::string _dev;
+
+  rx_tagger _tagger;
+  stream_counters _stats;
+  uint64_t _next_sample; /* expected out_first_sample of the next buffer */
 };
 
 #endif // XTRX_SOURCE_C_H
@@ -1,10 +1,154 @@
+#include <pybind11/functional.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+
 namespace py = pybind11;
 
 #include <osmosdr/device.h>
 
+namespace {
+
+/*
+ * Invalidate hooks added from Python. The udev monitor thread may call
+ * them at any time, so they are removed at interpreter exit and calls
+ * under way are waited for. Whatever comes later leaves Python alone.
+ * Never destroyed, the monitor thread outlives static destruction.
+ */
+struct python_hooks_t {
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::set<size_t> ids;
+    size_t busy = 0;
+    bool alive = true;
+
+    /* false once the interpreter is going away */
+    bool enter()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!alive)
+            return false;
+        busy++;
+        return true;
+    }
+
+    void leave()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0)
+            idle.notify_all();
+    }
+};
+
+python_hooks_t& python_hooks()
+{
+    static python_hooks_t* hooks = new python_hooks_t;
+    return *hooks;
+}
+
+/* owns the callable, which is only touched with the GIL held */
+struct python_hook_t {
+    explicit python_hook_t(const py::function& f) : fn(f) {}
+
+    ~python_hook_t()
+    {
+        python_hooks_t& hooks = python_hooks();
+
+        if (!hooks.enter()) {
+            fn.release(); /* the interpreter is gone, leak it */
+            return;
+        }
+
+        {
+            py::gil_scoped_acquire gil;
+            fn = py::function();
+        }
+
+        hooks.leave();
+    }
+
+    void operator()(const std::string& backend)
+    {
+        python_hooks_t& hooks = python_hooks();
+
+        if (!hooks.enter())
+            return;
+
+        {
+            py::gil_scoped_acquire gil;
+
+            try {
+                fn(backend);
+            } catch (py::error_already_set& e) {
+                /* there is no caller to raise it to on the monitor thread */
+                e.restore();
+                PyErr_WriteUnraisable(fn.ptr());
+            }
+        }
+
+        hooks.leave();
+    }
+
+    py::function fn;
+};
+
+size_t add_python_hook(const py::function& f)
+{
+    std::shared_ptr<python_hook_t> hook;
+
+    {
+        py::gil_scoped_acquire gil;
+        hook = std::make_shared<python_hook_t>(f);
+    }
+
+    /* copies of the std::function only copy the shared_ptr */
+    size_t id = ::osmosdr::device::add_invalidate_hook(
+        [hook](const std::string& backend) { (*hook)(backend); });
+
+    std::lock_guard<std::mutex> lock(python_hooks().mutex);
+    python_hooks().ids.insert(id);
+
+    return id;
+}
+
+void remove_python_hook(size_t id)
+{
+    {
+        std::lock_guard<std::mutex> lock(python_hooks().mutex);
+        python_hooks().ids.erase(id);
+    }
+
+    ::osmosdr::device::remove_invalidate_hook(id);
+}
+
+/* runs at interpreter exit, before Python is finalized */
+void drop_python_hooks()
+{
+    python_hooks_t& hooks = python_hooks();
+    std::set<size_t> ids;
+
+    /* the hooks under way need the GIL to finish */
+    py::gil_scoped_release release;
+
+    {
+        std::lock_guard<std::mutex> lock(hooks.mutex);
+        ids.swap(hooks.ids);
+    }
+
+    for (size_t id : ids)
+        ::osmosdr::device::remove_invalidate_hook(id);
+
+    std::unique_lock<std::mutex> lock(hooks.mutex);
+    hooks.alive = false;
+    hooks.idle.wait(lock, [&hooks] { return 0 == hooks.busy; });
+}
+
+} // namespace
+
 void bind_device(py::module& m)
 {
     using device_t = ::osmosdr::device_t;
@@ -23,5 +167,26 @@ void bind_device(py::module& m)
     using device = ::osmosdr::device;
 
     py::class_<device>(m, "device")
-        .def_static("find", &device::find, py::arg("hint") = device_t());
+        .def_static("find",
+                    &device::find,
+                    py::arg("hint") = device_t(),
+                    py::call_guard<py::gil_scoped_release>())
+        .def_static("refresh",
+                    &device::refresh,
+                    py::arg("hint") = device_t(),
+                    py::call_guard<py::gil_scoped_release>())
+        .def_static("invalidate",
+                    &device::invalidate,
+                    py::arg("backend") = "",
+                    py::call_guard<py::gil_scoped_release>())
+        .def_static("add_invalidate_hook",
+                    &add_python_hook,
+                    py::arg("hook"),
+                    py::call_guard<py::gil_scoped_release>())
+        .def_static("remove_invalidate_hook",
+                    &remove_python_hook,
+                    py::arg("id"),
+                    py::call_guard<py::gil_scoped_release>());
+
+    py::module::import("atexit").attr("register")(py::cpp_function(&drop_python_hooks));
 }
@@ -121,6 +121,15 @@
  static const char *__doc_osmosdr_source_get_bandwidth_range = R"doc()doc";
 
 
+ static const char *__doc_osmosdr_source_get_stream_stats = R"doc()doc";
+
+
+ static const char *__doc_osmosdr_source_set_retune_presets = R"doc()doc";
+
+
+ static const char *__doc_osmosdr_source_schedule_retune = R"doc()doc";
+
+
  static const char *__doc_osmosdr_source_set_time_source = R"doc()doc";
 
 
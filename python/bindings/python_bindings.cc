@@ -28,6 +28,7 @@ namespace py = pybind11;
 void bind_device(py::module& m);
 void bind_ranges(py::module& m);
 void bind_time_spec(py::module& m);
+void bind_stream_stats(py::module& m);
 
 
 // We need this hack because import_array() returns NULL
@@ -62,4 +63,5 @@ PYBIND11_MODULE(osmosdr_python, m)
     bind_device(m);
     bind_ranges(m);
     bind_time_spec(m);
+    bind_stream_stats(m);
 }
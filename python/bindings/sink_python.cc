@@ -14,7 +14,7 @@
 /* BINDTOOL_GEN_AUTOMATIC(1)                                                       */
 /* BINDTOOL_USE_PYGCCXML(0)                                                        */
 /* BINDTOOL_HEADER_FILE(sink.h)                                        */
-/* BINDTOOL_HEADER_FILE_HASH(d4331eb8a19b7a2aa4ed0100039f7a0e)                     */
+/* BINDTOOL_HEADER_FILE_HASH(df647bdd244ee2fb06d93a9982d342b4)                     */
 /***********************************************************************************/
 
 #include <pybind11/complex.h>
@@ -224,6 +224,12 @@ void bind_sink(py::module& m)
         )
 
 
+        .def("get_stream_stats",&sink::get_stream_stats,
+            py::arg("chan") = 0,
+            D(sink,get_stream_stats)
+        )
+
+
         .def("set_time_source",&sink::set_time_source,
             py::arg("source"),
             py::arg("mboard") = 0,
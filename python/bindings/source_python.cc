@@ -14,7 +14,7 @@
 /* BINDTOOL_GEN_AUTOMATIC(1)                                                       */
 /* BINDTOOL_USE_PYGCCXML(0)                                                        */
 /* BINDTOOL_HEADER_FILE(source.h)                                        */
-/* BINDTOOL_HEADER_FILE_HASH(d1a3d9ea3d815fe4f18acc3eef21f1b6)                     */
+/* BINDTOOL_HEADER_FILE_HASH(331a82c8604b4a9ff3d3cb53ac87998b)                     */
 /***********************************************************************************/
 
 #include <pybind11/complex.h>
@@ -246,6 +246,27 @@ void bind_source(py::module& m)
         )
 
 
+        .def("get_stream_stats",&source::get_stream_stats,
+            py::arg("chan") = 0,
+            D(source,get_stream_stats)
+        )
+
+
+        .def("set_retune_presets",&source::set_retune_presets,
+            py::arg("freqs"),
+            py::arg("chan") = 0,
+            D(source,set_retune_presets)
+        )
+
+
+        .def("schedule_retune",&source::schedule_retune,
+            py::arg("freq"),
+            py::arg("time"),
+            py::arg("chan") = 0,
+            D(source,schedule_retune)
+        )
+
+
         .def("set_time_source",&source::set_time_source,
             py::arg("source"),
             py::arg("mboard") = 0,
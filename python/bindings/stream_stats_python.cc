@@ -0,0 +1,36 @@
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+/***********************************************************************************/
+/* This file is maintained by hand, bindtool must not regenerate it.               */
+/* If the header changes, update the binding and the hash below accordingly.       */
+/* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
+/* BINDTOOL_USE_PYGCCXML(0)                                                        */
+/* BINDTOOL_HEADER_FILE(stream_stats.h)                                  */
+/* BINDTOOL_HEADER_FILE_HASH(978e9cfa0a933de7d199a7366c48f378)                     */
+/***********************************************************************************/
+
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+#include <osmosdr/stream_stats.h>
+
+void bind_stream_stats(py::module& m)
+{
+    using stream_stats_t = ::osmosdr::stream_stats_t;
+
+    py::class_<stream_stats_t>(m, "stream_stats_t")
+        .def(py::init<>())
+        .def_readonly("overflows", &stream_stats_t::overflows)
+        .def_readonly("dropped", &stream_stats_t::dropped)
+        .def_readonly("underflows", &stream_stats_t::underflows)
+        .def_readonly("inserted", &stream_stats_t::inserted)
+        .def_readonly("late", &stream_stats_t::late);
+}
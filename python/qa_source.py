@@ -0,0 +1,112 @@
+#!/usr/bin/env python
+#
+# Copyright 2026 Free Software Foundation, Inc.
+#
+# This file is part of gr-osmosdr
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+
+import os
+import tempfile
+import time
+
+from gnuradio import gr, gr_unittest
+
+try:
+    from osmosdr import device, source
+except ImportError:
+    import sys
+    dirname, filename = os.path.split(os.path.abspath(__file__))
+    sys.path.append(os.path.join(dirname, "bindings"))
+    from osmosdr import device, source
+
+DEVICE = "file=/dev/zero,rate=1e6,throttle=false"
+
+
+def grc_args(nchan, cpu_format, args):
+    # the make template of the GRC source block
+    return "numchan=" + str(nchan) + " cpu_format=" + cpu_format + " " + args
+
+
+class qa_source(gr_unittest.TestCase):
+
+    def test_001_grc_args(self):
+        for cpu_format, item_size in (("fc32", 8), ("sc16", 4), ("sc8", 2)):
+            src = source(args=grc_args(1, cpu_format, DEVICE))
+            self.assertEqual(src.output_signature().max_streams(), 1)
+
+            self.assertEqual(src.output_signature().sizeof_stream_item(0), item_size)
+
+    def test_002_grc_args_two_devices(self):
+        src = source(args=grc_args(2, "fc32", DEVICE + " " + DEVICE))
+        self.assertEqual(src.output_signature().max_streams(), 2)
+
+    def test_003_grc_args_no_device(self):
+        # the first device found is used, if there is any
+        try:
+            src = source(args=grc_args(1, "fc32", ""))
+        except RuntimeError as e:
+            self.assertIn("No supported devices found", str(e))
+        else:
+            self.assertEqual(src.output_signature().max_streams(), 1)
+
+    def test_004_global_args_without_numchan(self):
+        src = source(args="cpu_format=fc32 " + DEVICE)
+        self.assertEqual(src.output_signature().max_streams(), 1)
+
+    def test_005_stats_ms(self):
+        src = source(args=grc_args(1, "fc32", DEVICE + " stats_ms=100"))
+        self.assertEqual(src.output_signature().max_streams(), 1)
+        self.assertEqual(src.get_stream_stats(0).overflows, 0)
+
+    def test_006_enum_timeout_ms(self):
+        src = source(args="enum_timeout_ms=1000 " + DEVICE)
+        self.assertEqual(src.output_signature().max_streams(), 1)
+
+        # without a device the timeout bounds the search for one
+        start = time.monotonic()
+        try:
+            src = source(args=grc_args(1, "fc32", "enum_timeout_ms=1"))
+        except RuntimeError as e:
+            self.assertIn("No supported devices found", str(e))
+            self.assertLess(time.monotonic() - start, 5.0)
+        else:
+            self.assertEqual(src.output_signature().max_streams(), 1)
+
+    def test_007_caps_cache(self):
+        src = source(args="caps_cache=0 " + DEVICE)
+        self.assertEqual(src.output_signature().max_streams(), 1)
+
+        src = source(args=grc_args(2, "fc32", "caps_cache=0 " + DEVICE + " " + DEVICE))
+        self.assertEqual(src.output_signature().max_streams(), 2)
+
+        # the global value is parsed while setting up every device
+        with self.assertRaises(RuntimeError):
+            source(args=grc_args(1, "fc32", DEVICE + " caps_cache=off"))
+
+    def test_008_find_after_first_only(self):
+        # the auto-selection stops at the first device, leaving the slower
+        # backends to finish in the background
+        with tempfile.TemporaryFile() as log:
+            stderr = os.dup(2)
+            os.dup2(log.fileno(), 2)
+            try:
+                try:
+                    source(args=grc_args(1, "fc32", ""))
+                except RuntimeError:
+                    pass
+                device.find()
+            finally:
+                os.dup2(stderr, 2)
+                os.close(stderr)
+
+            log.seek(0)
+            output = log.read().decode(errors="replace")
+
+        # find() waits for them instead of leaving their devices out
+        self.assertNotIn("Skipping", output)
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_source)